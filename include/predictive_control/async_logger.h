@@ -0,0 +1,166 @@
+// This file containts asynchronous logger, hot path messages written into lock free ring buffer and printed by
+// background thread
+
+#ifndef PREDICTIVE_CONTROL_ASYNC_LOGGER_H
+#define PREDICTIVE_CONTROL_ASYNC_LOGGER_H
+
+// std includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// boost includes
+#include <boost/thread.hpp>
+
+// log levels, messages below PREDICTIVE_CONTROL_LOG_LEVEL are removed by compiler (arguments not evaluated)
+#define PD_LOG_LEVEL_DEBUG 0
+#define PD_LOG_LEVEL_INFO 1
+#define PD_LOG_LEVEL_WARN 2
+#define PD_LOG_LEVEL_ERROR 3
+#define PD_LOG_LEVEL_NONE 4
+
+#ifndef PREDICTIVE_CONTROL_LOG_LEVEL
+#define PREDICTIVE_CONTROL_LOG_LEVEL PD_LOG_LEVEL_INFO
+#endif
+
+// compile time constant, guard blocks which only prepare log messages
+#define PD_LOG_ENABLED(level) (PREDICTIVE_CONTROL_LOG_LEVEL <= (level))
+
+#if PD_LOG_ENABLED(PD_LOG_LEVEL_DEBUG)
+#define PD_LOG_DEBUG(...) AsyncLogger::instance().log(PD_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define PD_LOG_DEBUG_VALUES(label, values, size)                                                                      \
+  AsyncLogger::instance().logValues(PD_LOG_LEVEL_DEBUG, label, values, size)
+#else
+#define PD_LOG_DEBUG(...) ((void)0)
+#define PD_LOG_DEBUG_VALUES(label, values, size) ((void)0)
+#endif
+
+#if PD_LOG_ENABLED(PD_LOG_LEVEL_INFO)
+#define PD_LOG_INFO(...) AsyncLogger::instance().log(PD_LOG_LEVEL_INFO, __VA_ARGS__)
+#define PD_LOG_INFO_VALUES(label, values, size)                                                                       \
+  AsyncLogger::instance().logValues(PD_LOG_LEVEL_INFO, label, values, size)
+#else
+#define PD_LOG_INFO(...) ((void)0)
+#define PD_LOG_INFO_VALUES(label, values, size) ((void)0)
+#endif
+
+#if PD_LOG_ENABLED(PD_LOG_LEVEL_WARN)
+#define PD_LOG_WARN(...) AsyncLogger::instance().log(PD_LOG_LEVEL_WARN, __VA_ARGS__)
+#define PD_LOG_WARN_VALUES(label, values, size)                                                                       \
+  AsyncLogger::instance().logValues(PD_LOG_LEVEL_WARN, label, values, size)
+#else
+#define PD_LOG_WARN(...) ((void)0)
+#define PD_LOG_WARN_VALUES(label, values, size) ((void)0)
+#endif
+
+#if PD_LOG_ENABLED(PD_LOG_LEVEL_ERROR)
+#define PD_LOG_ERROR(...) AsyncLogger::instance().log(PD_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define PD_LOG_ERROR_VALUES(label, values, size)                                                                      \
+  AsyncLogger::instance().logValues(PD_LOG_LEVEL_ERROR, label, values, size)
+#else
+#define PD_LOG_ERROR(...) ((void)0)
+#define PD_LOG_ERROR_VALUES(label, values, size) ((void)0)
+#endif
+
+class AsyncLogger
+{
+  /** Process wide logger for control loop
+   * - Bounded multi producer ring buffer of fixed size slots, producers claim slot by compare and swap of write index
+   *   and publish it by sequence number of slot, no lock and no heap allocation on logging thread
+   * - Message formatted (printf style) directly into claimed slot, truncated to MESSAGE_SIZE
+   * - Message dropped and counted if ring buffer full, logging thread never waits for console
+   * - Background thread started with first message, prints messages in order by ROS console with their level
+   */
+
+public:
+  // maximum length of one message including terminating null
+  static const int MESSAGE_SIZE = 256;
+
+  // number of slots, power of two
+  static const int BUFFER_SIZE = 1024;
+
+  /**
+   * @brief instance: process wide logger, background thread started on first call
+   * @return logger
+   */
+  static AsyncLogger& instance();
+
+  /**
+   * @brief log: format message into ring buffer, dropped if ring buffer full
+   * @param level: PD_LOG_LEVEL_DEBUG, PD_LOG_LEVEL_INFO, PD_LOG_LEVEL_WARN or PD_LOG_LEVEL_ERROR
+   * @param format: printf style format string
+   * @return true if message queued else false
+   */
+  bool log(const int level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+  /**
+   * @brief logValues: format label followed by values into ring buffer, e.g. vector or matrix storage
+   * @param level: PD_LOG_LEVEL_DEBUG, PD_LOG_LEVEL_INFO, PD_LOG_LEVEL_WARN or PD_LOG_LEVEL_ERROR
+   * @param label: text in front of values
+   * @param values: pointer to first value
+   * @param size: number of values
+   * @return true if message queued else false
+   */
+  bool logValues(const int level, const char* label, const double* values, const int size);
+
+  /**
+   * @brief flush: wait until background thread printed all queued messages
+   */
+  void flush();
+
+  // messages dropped because ring buffer was full
+  uint64_t getDroppedCount() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+private:
+  /** one message, sequence number tells whether slot is free for producer or ready for consumer */
+  struct Slot
+  {
+    std::atomic<uint64_t> sequence;
+    int level;
+    char text[MESSAGE_SIZE];
+  };
+
+  Slot slots_[BUFFER_SIZE];
+
+  // producers claim write index, only background thread moves read index
+  std::atomic<uint64_t> write_index_;
+  std::atomic<uint64_t> read_index_;
+  std::atomic<uint64_t> dropped_;
+  std::atomic<bool> running_;
+
+  boost::thread drain_thread_;
+
+  AsyncLogger();
+  ~AsyncLogger();
+
+  AsyncLogger(const AsyncLogger&);
+  AsyncLogger& operator=(const AsyncLogger&);
+
+  /**
+   * @brief claim: reserve next free slot
+   * @return slot or null if ring buffer full
+   */
+  Slot* claim();
+
+  /**
+   * @brief publish: make filled slot visible to background thread
+   * @param slot: slot returned by claim, sequence still equal to its claimed position
+   */
+  void publish(Slot* slot);
+
+  /**
+   * @brief drain: print all published messages in order
+   * @return number of printed messages
+   */
+  int drain();
+
+  /**
+   * @brief run: background thread, drain ring buffer until logger destroyed
+   */
+  void run();
+};
+
+#endif
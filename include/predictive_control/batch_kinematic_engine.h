@@ -0,0 +1,149 @@
+// This file containts batched forward kinematic and Jacobian of many joint configurations in structure of arrays layout
+
+#ifndef PREDICTIVE_CONTROL_BATCH_KINEMATIC_ENGINE_H
+#define PREDICTIVE_CONTROL_BATCH_KINEMATIC_ENGINE_H
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// std includes
+#include <vector>
+
+#include <predictive_control/kinematic_engine.h>
+
+class BatchKinematicEngine
+{
+  /** Forward kinematic and Jacobian of same serial chain for many joint configurations at once
+   * - Structure of arrays: every matrix column holds one value for all configurations (row = configuration)
+   * - Segment pose i of configuration n: columns 12 * i + [R(0,0) R(1,0) R(2,0) R(0,1) ... R(2,2) p(0) p(1) p(2)]
+   * - Jacobian of configuration n: columns 6 * joint + [linear velocity, angular velocity]
+   * - Four configurations per AVX2 lane when built with USE_AVX2_KINEMATICS (sine and cosine vectorized too),
+   *   else scalar loop of same kernel
+   * - Storage allocated when batch size changes, no heap allocation for repeated batches of same size
+   */
+
+public:
+  /**
+   * @brief BatchKinematicEngine: Default constructor, empty chain
+   */
+  BatchKinematicEngine();
+
+  /**
+   * @brief initialize: copy segments of kinematic engine
+   * @param engine: kinematic engine of chain
+   * @return true with non empty chain else false
+   */
+  bool initialize(const KinematicEngine& engine);
+
+  /**
+   * @brief calculateForwardKinematics: pose of every segment tip relative to chain root for all configurations
+   * @param joints_angle: joint values, number of configurations x degree of freedom (one configuration per row)
+   */
+  void calculateForwardKinematics(const Eigen::MatrixXd& joints_angle);
+
+  /**
+   * @brief calculateJacobian: forward kinematics and geometric Jacobian of end effector for all configurations
+   * @param joints_angle: joint values, number of configurations x degree of freedom (one configuration per row)
+   */
+  void calculateJacobian(const Eigen::MatrixXd& joints_angle);
+
+  /**
+   * @brief getSegmentPose: pose of segment tip computed by last call
+   * @param configuration: index of configuration (row of joint values)
+   * @param segment: index of segment
+   * @return pose of segment tip relative to chain root
+   */
+  Eigen::Isometry3d getSegmentPose(const int& configuration, const int& segment) const;
+
+  /**
+   * @brief getEndEffectorPose: pose of last segment computed by last call
+   * @param configuration: index of configuration (row of joint values)
+   * @return pose of end effector relative to chain root
+   */
+  Eigen::Isometry3d getEndEffectorPose(const int& configuration) const;
+
+  /**
+   * @brief getJacobian: Jacobian of end effector computed by last calculateJacobian call
+   * @param configuration: index of configuration (row of joint values)
+   * @param jacobian: Resultant Jacobian matrix, 6 x degree of freedom
+   */
+  void getJacobian(const int& configuration, Eigen::MatrixXd& jacobian) const;
+
+  /**
+   * @brief getSegmentPoses: segment poses of all configurations, structure of arrays layout
+   * @return number of configurations x 12 * number of segments
+   */
+  const Eigen::MatrixXd& getSegmentPoses() const
+  {
+    return segment_poses_;
+  }
+
+  /**
+   * @brief getJacobians: Jacobian of all configurations, structure of arrays layout
+   * @return number of configurations x 6 * degree of freedom
+   */
+  const Eigen::MatrixXd& getJacobians() const
+  {
+    return jacobians_;
+  }
+
+  int getBatchSize() const
+  {
+    return segment_poses_.rows();
+  }
+
+  int getNumberOfSegments() const
+  {
+    return joint_types_.size();
+  }
+
+  int getDegreeOfFreedom() const
+  {
+    return degree_of_freedom_;
+  }
+
+  /**
+   * @brief isVectorized: true if built with AVX2 kernel, false with scalar fallback
+   */
+  static bool isVectorized();
+
+private:
+  int degree_of_freedom_;
+
+  // per segment fixed frame (column major rotation, translation), joint type, axis index, sign and unit axis
+  std::vector<double> frames_to_tip_;
+  std::vector<int> joint_types_;
+  std::vector<int> axis_index_;
+  std::vector<double> axis_sign_;
+  std::vector<double> axes_;
+  std::vector<int> joint_index_;
+
+  // computed segment poses and Jacobians, structure of arrays layout
+  Eigen::MatrixXd segment_poses_;
+  Eigen::MatrixXd jacobians_;
+
+  /**
+   * @brief resize: resize storage to batch size
+   * @param batch_size: number of configurations
+   */
+  void resize(const int& batch_size);
+
+  /**
+   * @brief calculateBlock: forward kinematics (and Jacobian) of Lane::WIDTH consecutive configurations
+   * @param joints_angle: joint values, number of configurations x degree of freedom
+   * @param configuration: index of first configuration of block
+   * @param jacobian: compute Jacobian too
+   */
+  template <typename Lane>
+  void calculateBlock(const Eigen::MatrixXd& joints_angle, const int& configuration, const bool& jacobian);
+
+  /**
+   * @brief calculate: run kernel over whole batch, vector lanes first and scalar lane for remaining configurations
+   * @param joints_angle: joint values, number of configurations x degree of freedom
+   * @param jacobian: compute Jacobian too
+   */
+  void calculate(const Eigen::MatrixXd& joints_angle, const bool& jacobian);
+};
+
+#endif
@@ -42,6 +42,7 @@
 
 // predictive includes
 #include <predictive_control/predictive_configuration.h>
+#include <predictive_control/async_logger.h>
 #include <predictive_control/StaticObstacle.h>
 
 class CollisionAvoidance
@@ -107,6 +108,9 @@ private:
 
   void visualizeObstacleDistance(const std::map<std::string, cob_control_msgs::ObstacleDistance>& distnace_matrix);
 
+  // debug output of one obstacle distance, compiled out below debug log level
+  void logObstacleDistance(const cob_control_msgs::ObstacleDistance& obstacle_distance);
+
   void configureInteractiveMarker();
 
   bool addStaticObstacleServiceCallBack(predictive_control::StaticObstacleRequest& request,
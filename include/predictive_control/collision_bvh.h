@@ -0,0 +1,104 @@
+// This file containts bounding volume hierarchy (axis aligned bounding box tree) over static obstacles
+
+#ifndef PREDICTIVE_CONTROL_COLLISION_BVH_H
+#define PREDICTIVE_CONTROL_COLLISION_BVH_H
+
+// Eigen includes
+#include <Eigen/Core>
+
+// std includes
+#include <vector>
+
+#include <predictive_control/collision_geometry.h>
+
+class CollisionBoundingVolumeHierarchy
+{
+  /** Binary tree of axis aligned bounding boxes, one leaf per static obstacle
+   * - Built top down, objects split at median of their box centers along longest axis, height log2 of objects
+   * - Removal incremental: leaf and its parent dropped, sibling takes place of parent, boxes of ancestors shrunk
+   * - Objects referred by index into array of owner, removal renumbers last object like swap with last in owner
+   * - Sphere query visits only subtrees whose box is within radius of center
+   */
+
+public:
+  /**
+   * @brief CollisionBoundingVolumeHierarchy: Default constructor, empty tree
+   */
+  CollisionBoundingVolumeHierarchy();
+
+  /**
+   * @brief clear: remove all objects
+   */
+  void clear();
+
+  /**
+   * @brief build: build tree over all objects, previous tree dropped
+   * @param objects: static obstacles relative to chain root, leaf of object i refers to index i
+   */
+  void build(const std::vector<CollisionPrimitive>& objects);
+
+  /**
+   * @brief removeObject: remove leaf of object, last object renumbered to removed index
+   * @param object: index of object, owner moves its last object to this index (swap with last and pop)
+   */
+  void removeObject(const int& object);
+
+  /**
+   * @brief querySphere: objects whose bounding box is within radius of center
+   * @param center: center of sphere relative to chain root
+   * @param radius: radius of sphere, e.g. robot ball radius plus influence distance of cost
+   * @param objects: resultant indices of objects, cleared first, capacity reused
+   */
+  void querySphere(const Eigen::Vector3d& center, const double& radius, std::vector<int>& objects) const;
+
+  int getNumberOfObjects() const
+  {
+    return object_leaf_.size();
+  }
+
+  /**
+   * @brief getHeight: number of nodes on longest path from root to leaf, 0 if empty
+   */
+  int getHeight() const;
+
+private:
+  struct Node
+  {
+    // bounding box of subtree
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+
+    int parent;
+    int left;
+    int right;
+
+    // index of object for leaf, -1 for inner node
+    int object;
+  };
+
+  std::vector<Node> nodes_;
+  int root_;
+
+  // leaf node of every object
+  std::vector<int> object_leaf_;
+
+  /**
+   * @brief buildNode: build subtree over objects [begin, end) of order
+   * @param order: object indices, reordered while splitting
+   * @param lower: lower corner of bounding box of every object
+   * @param upper: upper corner of bounding box of every object
+   * @param begin: first object of subtree
+   * @param end: one past last object of subtree
+   * @param parent: parent node, -1 for root
+   * @return index of subtree root
+   */
+  int buildNode(std::vector<int>& order, const std::vector<Eigen::Vector3d>& lower,
+                const std::vector<Eigen::Vector3d>& upper, const int& begin, const int& end, const int& parent);
+
+  /**
+   * @brief getSubtreeHeight: height of subtree, 0 for no node
+   */
+  int getSubtreeHeight(const int& node) const;
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include <map>
 #include <string>
 #include <fstream>
+#include <vector>
 
 // kdl,urdf includes
 #include <urdf/model.h>
@@ -34,6 +35,12 @@
 
 // predictive includes
 #include <predictive_control/predictive_configuration.h>
+#include <predictive_control/async_logger.h>
+#include <predictive_control/collision_model.h>
+#include <predictive_control/collision_geometry.h>
+#include <predictive_control/collision_bvh.h>
+#include <predictive_control/signed_distance_field.h>
+#include <predictive_control/self_collision_kernel.h>
 #include <predictive_control/CollisionObject.h>
 #include <predictive_control/StaticCollisionObject.h>
 #include <predictive_control/StaticCollisionObjectRequest.h>
@@ -70,12 +77,14 @@ public:
    * @brief updateCollisionVolume: Update collsion matrix using forward kinematic relative to root link
    * @param FK_Homogenous_Matrix: Forward kinematic replative to root link
    * @param Transformation_Matrix: Transformation matrix between two concecutive frame
+   * @param first_changed_segment: first segment changed since last update, balls in front of it are kept
    */
   void updateCollisionVolume(const std::vector<Eigen::MatrixXd>& FK_Homogenous_Matrix,
-                             const std::vector<Eigen::MatrixXd>& Transformation_Matrix);
+                             const std::vector<Eigen::MatrixXd>& Transformation_Matrix,
+                             const int& first_changed_segment = 0);
 
   /**
-   * @brief generateCollisionVolume: Create collsion matrix using forward kinematic relative to root link
+   * @brief generateCollisionVolume: Create layout of collision balls (collision model) and their markers, once
    * @param FK_Homogenous_Matrix: Forward kinematic replative to root link
    * @param Transformation_Matrix: Transformation matrix between two concecutive frame
    */
@@ -94,12 +103,12 @@ public:
   /**
    * @brief computeCollisionCost: Computation collision distance cost,
    *                              Store Distance vectors represent distance from center of frame to other frame
-   * @param collision_matrix: Collision matrix has information about distance between frames relative to root frame
+   * @param collision_model: Collision balls, centers relative to root frame
    * @param collision_min_distance: Minimum collision distance, below that should not go
    * @param weight_factor: convergence rate
    */
-  void computeCollisionCost(const std::map<std::string, geometry_msgs::PoseStamped> collision_matrix,
-                            const double& collision_min_distance, const double& weight_factor);
+  void computeCollisionCost(const CollisionModel& collision_model, const double& collision_min_distance,
+                            const double& weight_factor);
 
   /**
    * @brief createStaticFrame: visulize intermidiate added frame, relative to root frame
@@ -131,8 +140,11 @@ public:
   // visulaize all volumes
   visualization_msgs::MarkerArray marker_array_;
 
-  // collision matrix
-  std::map<std::string, geometry_msgs::PoseStamped> collision_matrix_;
+  // collision balls around robot body, layout created with first update
+  CollisionModel collision_model_;
+
+  // pairwise cost and gradient of collision balls, exclusion mask built with layout
+  SelfCollisionKernel self_collision_kernel_;
 
   // collision cost vector
   Eigen::VectorXd collision_cost_vector_;
@@ -144,6 +156,12 @@ private:
   // static frame broadcaster
   tf2_ros::StaticTransformBroadcaster static_broadcaster_;
 
+  /**
+   * @brief initializeSelfCollisionKernel: build exclusion mask of layout, adjacent links and configured ball pairs
+   * @param collision_model: collision model with final layout
+   */
+  void initializeSelfCollisionKernel(const CollisionModel& collision_model);
+
   /**
    * @brief transformKDLToEigenMatrix: transform KDL Frame to Eigen Matrix
    * @param frame KDL::Frame which containts Rotation Matrix and Traslation vector
@@ -172,7 +190,13 @@ class StaticCollision : public predictive_configuration
 {
   /**
     * Class used to generate bounding volume around static object,
-    * - Development of distance cost function (logistic function) use to keep distance from robot body
+    * - Static objects stored as primitives (box, cylinder, sphere) with own pose and dimensions
+    * - Bounding volume hierarchy over static objects, robot balls only tested against objects within influence
+    *   distance of cost
+    * - Optional signed distance grid of static objects, rebaked in background whenever objects change, distance of
+    *   ball with single object nearby interpolated from grid while grid matches current objects
+    * - Development of distance cost function (logistic function) of exact signed distance between robot balls and
+    *   static objects, use to keep distance from robot body
     * - Visualize collision bounding ball around StaticCollision
     * - Creat static frame for visulize center of intermidiate ball
     */
@@ -196,42 +220,54 @@ public:
 
   /**
    * @brief updateStaticCollisionVolume: update static collision volume function at every runtime
-   * @param robot_critical_points
+   * @param robot_model: collision balls of robot, e.g. collision model of CollisionRobot
    */
-  void updateStaticCollisionVolume(const std::map<std::string, geometry_msgs::PoseStamped>& robot_critical_points);
+  void updateStaticCollisionVolume(const CollisionModel& robot_model);
 
   /**
-   * @brief generateStaticCollisionVolume: generate static collision oject, fill collision_matrix
+   * @brief generateStaticCollisionVolume: generate static collision oject, fill static_objects
    */
   void generateStaticCollisionVolume();
 
   /**
    * @brief visualizeStaticCollisionVoulme: visulize static collision object
-   * @param stamped: collsion object represented by size, pose, primitive_type, operation
+   * @param primitive: collsion object represented by shape, pose relative to root frame and dimensions
    */
-  void visualizeStaticCollisionVoulme(const geometry_msgs::PoseStamped& stamped);
+  void visualizeStaticCollisionVoulme(const CollisionPrimitive& primitive);
 
   /**
-   * @brief computeStaticCollisionCost: Computation collision distance cost,
-   *                              Store Distance vectors represent distance from center of frame to other frame
-   * @param collision_matrix: Collision matrix has information about distance between frames relative to root frame
-   * @param collision_min_distance: Minimum collision distance, below that should not go
+   * @brief computeStaticCollisionCost: Computation collision distance cost of signed distance between surface of
+   *                                    robot balls and surface of static objects, c = exp((d_min^2 - d * |d|) / w)
+   * @param static_objects: Static objects relative to root frame
+   * @param static_object_tree: Bounding volume hierarchy built over static_objects
+   * @param distance_grid: Signed distance grid baked from static_objects, NULL to use exact distance only.
+   *                       Used only for ball inside grid with single object within influence distance, cost of
+   *                       several nearby objects always summed from exact distance
+   * @param robot_model: Collision balls of robot, one cost per ball
+   * @param collision_threshold_distance: Minimum collision distance, below that should not go
    * @param weight_factor: convergence rate
    */
-  void computeStaticCollisionCost(const std::map<std::string, geometry_msgs::PoseStamped> static_collision_matrix,
-                                  const std::map<std::string, geometry_msgs::PoseStamped> robot_collision_matrix,
+  void computeStaticCollisionCost(const std::vector<CollisionPrimitive>& static_objects,
+                                  const CollisionBoundingVolumeHierarchy& static_object_tree,
+                                  const SignedDistanceGrid* distance_grid, const CollisionModel& robot_model,
                                   const double& collision_threshold_distance, const double& weight_factor);
 
   /** public data member*/
   // visulaize all volumes
   visualization_msgs::MarkerArray marker_array_;
 
-  // collision matrix
-  std::map<std::string, geometry_msgs::PoseStamped> collision_matrix_;
+  // static objects with shape, pose and dimensions
+  std::vector<CollisionPrimitive> static_objects_;
+
+  // bounding volume hierarchy, leaf i refers to static_objects_[i]
+  CollisionBoundingVolumeHierarchy static_object_tree_;
 
   // collision cost vector
   Eigen::VectorXd collision_cost_vector_;
 
+  // gradient of collision cost of every ball with respect to its center, number of balls x 3
+  Eigen::MatrixX3d collision_gradient_;
+
 private:
   // marker publisher
   ros::Publisher marker_pub_;
@@ -241,6 +277,15 @@ private:
   ros::ServiceServer remove_static_object_;
   ros::ServiceServer remove_all_static_objects_;
 
+  // objects found by bounding volume hierarchy query, capacity reused
+  std::vector<int> nearby_objects_;
+
+  // incremented whenever static objects change, signed distance grid of other version is stale
+  int scene_version_;
+
+  // signed distance grid of static objects, baked in background thread
+  SignedDistanceField distance_field_;
+
   // transform listerner
   tf::TransformListener tf_listener_;
 
@@ -256,6 +301,15 @@ private:
    */
   bool getTransform(const std::string& from, const std::string& to, geometry_msgs::PoseStamped& stamped_pose);
 
+  /**
+   * @brief setPrimitivePose: set pose of primitive relative to root frame
+   * @param frame_id: frame in which pose is given, root frame if empty
+   * @param pose: center pose of object relative to frame_id
+   * @param primitive: static object with resultant position and rotation
+   * @return true if transform from root frame to frame_id found else false
+   */
+  bool setPrimitivePose(const std::string& frame_id, const geometry_msgs::Pose& pose, CollisionPrimitive& primitive);
+
   bool addStaticObjectServiceCB(predictive_control::StaticCollisionObjectRequest& request,
                                 predictive_control::StaticCollisionObjectResponse& response);
 
@@ -265,6 +319,18 @@ private:
   bool removeAllStaticObjectsServiceCB(predictive_control::StaticCollisionObjectRequest& request,
                                        predictive_control::StaticCollisionObjectResponse& response);
 
+  /**
+   * @brief removeStaticObject: remove static object from objects and bounding volume hierarchy,
+   *                            last object moved to its index
+   * @param index: index of object in static_objects_
+   */
+  void removeStaticObject(const int& index);
+
+  /**
+   * @brief onStaticObjectsChanged: increment scene version and request bake of signed distance grid
+   */
+  void onStaticObjectsChanged();
+
   /**
    * @brief createStaticFrame: visulize intermidiate added frame, relative to root frame
    * @param stamped: Center position of ball
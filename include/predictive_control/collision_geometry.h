@@ -0,0 +1,77 @@
+// This file containts primitive shapes of static obstacles and closed form signed distance of robot spheres to them
+
+#ifndef PREDICTIVE_CONTROL_COLLISION_GEOMETRY_H
+#define PREDICTIVE_CONTROL_COLLISION_GEOMETRY_H
+
+// Eigen includes
+#include <Eigen/Core>
+
+// std includes
+#include <string>
+
+enum CollisionPrimitiveType
+{
+  COLLISION_PRIMITIVE_BOX = 0,
+  COLLISION_PRIMITIVE_CYLINDER,
+  COLLISION_PRIMITIVE_SPHERE
+};
+
+struct CollisionPrimitive
+{
+  /** Static obstacle owning its shape, independent of visualization marker
+   * - Pose is center of shape relative to chain root, cylinder axis along local z
+   * - Dimensions are full size like marker scale: box (x, y, z), cylinder (diameter, diameter, height),
+   *   sphere (diameter, diameter, diameter)
+   */
+
+  // unique id of obstacle, same as text of its marker
+  std::string id;
+
+  CollisionPrimitiveType type;
+
+  // center and orientation relative to chain root
+  Eigen::Vector3d position;
+  Eigen::Matrix3d rotation;
+
+  // full size of shape
+  Eigen::Vector3d dimensions;
+};
+
+/**
+ * @brief getCollisionPrimitiveType: primitive type of shape name
+ * @param name: shape name, box, cylinder or sphere (lower or upper case)
+ * @param type: resultant primitive type
+ * @return true if shape name known else false
+ */
+bool getCollisionPrimitiveType(const std::string& name, CollisionPrimitiveType& type);
+
+/**
+ * @brief computeSignedDistance: closed form signed distance of point to surface of primitive
+ * @param primitive: static obstacle
+ * @param point: point relative to chain root
+ * @param gradient: resultant gradient of distance with respect to point, unit vector away from surface
+ * @return distance to surface, negative inside of primitive
+ */
+double computeSignedDistance(const CollisionPrimitive& primitive, const Eigen::Vector3d& point,
+                             Eigen::Vector3d& gradient);
+
+/**
+ * @brief computeSphereSignedDistance: signed distance between surface of sphere and surface of primitive
+ * @param primitive: static obstacle
+ * @param center: center of sphere relative to chain root
+ * @param radius: radius of sphere
+ * @param gradient: resultant gradient of distance with respect to center of sphere
+ * @return distance between surfaces, negative if sphere penetrates primitive
+ */
+double computeSphereSignedDistance(const CollisionPrimitive& primitive, const Eigen::Vector3d& center,
+                                   const double& radius, Eigen::Vector3d& gradient);
+
+/**
+ * @brief computeBoundingBox: axis aligned bounding box of primitive relative to chain root
+ * @param primitive: static obstacle
+ * @param min: resultant lower corner
+ * @param max: resultant upper corner
+ */
+void computeBoundingBox(const CollisionPrimitive& primitive, Eigen::Vector3d& min, Eigen::Vector3d& max);
+
+#endif
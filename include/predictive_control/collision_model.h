@@ -0,0 +1,114 @@
+// This file containts flat (structure of arrays) collision model of spheres attached to kinematic chain
+
+#ifndef PREDICTIVE_CONTROL_COLLISION_MODEL_H
+#define PREDICTIVE_CONTROL_COLLISION_MODEL_H
+
+// Eigen includes
+#include <Eigen/Core>
+
+// std includes
+#include <map>
+#include <string>
+#include <vector>
+
+class CollisionModel
+{
+  /** Spheres attached to segments of serial chain, stored as contiguous arrays
+   * - Layout (segment, interpolation, radius, name) added once, storage of all arrays allocated while adding
+   * - Center of sphere on line between origin of previous and own segment: p = p(i - 1) + t * (p(i) - p(i - 1)),
+   *   t = 1 places sphere at segment origin, t = 0.5 in middle of segment
+   * - Centers relative to chain root stored per coordinate (x, y, z arrays), cost functions loop over arrays
+   * - Names only kept in separate index for lookup and debug output, never touched by update
+   */
+
+public:
+  /**
+   * @brief CollisionModel: Default constructor, empty model
+   */
+  CollisionModel();
+
+  /**
+   * @brief clear: remove all spheres
+   */
+  void clear();
+
+  /**
+   * @brief addSphere: append sphere to layout
+   * @param name: unique name of sphere, e.g. frame name used for visualization
+   * @param segment: index of segment (link id) sphere is attached to
+   * @param interpolation: position between origin of previous segment (0) and origin of segment (1)
+   * @param radius: sphere radius
+   * @return index of sphere, -1 if name already exists
+   */
+  int addSphere(const std::string& name, const int segment, const double interpolation, const double radius);
+
+  /**
+   * @brief updateCenters: compute centers of spheres attached to changed segments
+   * @param FK_Homogenous_Matrix: Forward kinematic of every segment relative to chain root
+   * @param first_changed_segment: first segment changed since last update, spheres in front of it are kept
+   */
+  void updateCenters(const std::vector<Eigen::MatrixXd>& FK_Homogenous_Matrix, const int& first_changed_segment = 0);
+
+  /**
+   * @brief findSphere: index of sphere with given name
+   * @param name: name of sphere
+   * @return index of sphere, -1 if not found
+   */
+  int findSphere(const std::string& name) const;
+
+  int getNumberOfSpheres() const
+  {
+    return names_.size();
+  }
+
+  bool empty() const
+  {
+    return names_.empty();
+  }
+
+  const std::string& getName(const int index) const
+  {
+    return names_[index];
+  }
+
+  // per sphere arrays, size of number of spheres
+  const Eigen::VectorXd& getCenterX() const
+  {
+    return center_x_;
+  }
+
+  const Eigen::VectorXd& getCenterY() const
+  {
+    return center_y_;
+  }
+
+  const Eigen::VectorXd& getCenterZ() const
+  {
+    return center_z_;
+  }
+
+  const Eigen::VectorXd& getRadius() const
+  {
+    return radius_;
+  }
+
+  const Eigen::VectorXi& getLinkId() const
+  {
+    return link_id_;
+  }
+
+private:
+  // centers relative to chain root, radius and segment of every sphere
+  Eigen::VectorXd center_x_;
+  Eigen::VectorXd center_y_;
+  Eigen::VectorXd center_z_;
+  Eigen::VectorXd radius_;
+  Eigen::VectorXi link_id_;
+  Eigen::VectorXd interpolation_;
+
+  // name of every sphere and its lookup, only changed by addSphere
+  std::vector<std::string> names_;
+  std::map<std::string, int> name_index_;
+};
+
+#endif
@@ -0,0 +1,135 @@
+
+// This file containts native condensed QP solver of frame tracker, linear velocity integrator model dot(x) = J * v
+
+#ifndef PREDICTIVE_CONTROL_CONDENSED_QP_TRACKER_H
+#define PREDICTIVE_CONTROL_CONDENSED_QP_TRACKER_H
+
+// ros includes
+#include <ros/ros.h>
+
+// Eigen includes
+#include <Eigen/Eigen>
+#include <Eigen/Dense>
+#include <Eigen/Core>
+
+// std includes
+#include <iostream>
+#include <string>
+#include <vector>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// predictive includes
+#include <predictive_control/predictive_configuration.h>
+#include <predictive_control/mpc_core.h>
+
+class pd_condensed_qp_tracker : public predictive_configuration
+{
+  /** Native MPC engine of frame tracker, no ACADO symbolic overhead
+   * - Jacobian constant over horizon, explicit Euler discretization x(k+1) = x(k) + dt * J * v(k)
+   * - States eliminated (condensing), Hessian and gradient built in closed form
+   * - Box constrained QP solved by warm started primal active set method
+   * - Dispatch to compile time specialized MpcCore for common degree of freedom and horizon combinations
+   */
+
+public:
+  /**
+   * @brief pd_condensed_qp_tracker: Default constructor, allocate memory
+   */
+  pd_condensed_qp_tracker();
+
+  /**
+   * @brief ~pd_condensed_qp_tracker: Default distructor, free memory
+   */
+  ~pd_condensed_qp_tracker();
+
+  /**
+   * @brief initialize: initialize horizon, weights and preallocate QP data
+   * @return true with successful initialize else false
+   */
+  bool initialize();
+
+  /**
+   * @brief setDeadline: compute budget of next solve, solver return best feasible iterate when reached
+   * @param time_budget: budget in seconds, zero or negative disable deadline
+   */
+  void setDeadline(const double& time_budget);
+
+  /**
+   * @brief setStageControlLimits: joint velocity limits per interval used by next solves, intersected with joint
+   * velocity limits
+   * @param min_limit: minimum joint velocity, stacked [v(0) | v(1) | ... | v(N-1)], empty vector remove stage limits
+   * @param max_limit: maximum joint velocity, stacked [v(0) | v(1) | ... | v(N-1)], empty vector remove stage limits
+   */
+  void setStageControlLimits(const Eigen::VectorXd& min_limit, const Eigen::VectorXd& max_limit);
+
+  /**
+   * @brief solve: build condensed QP and solve it, warm started from shifted solution of previous call
+   * @param Jacobian_Matrix: Jacobian Matrix use to generate dynamic system of equation
+   * @param current_pose: current end effector pose, initial state
+   * @param goal_pose: Goal pose where want to reach
+   * @param collision_activation: 1.0 activate collision cost, 0.0 deactivate collision cost
+   * @param collision_distance: total self collision distance cost
+   * @param terminal_control: control at end of horizon, last control is pinned to this value
+   * @param control: Resultant control at first step
+   * @return true when QP solved to optimality else false (control is still feasible)
+   */
+  bool solve(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& current_pose,
+             const Eigen::VectorXd& goal_pose, const double& collision_activation, const double& collision_distance,
+             const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control);
+
+  /**
+   * @brief solve: linear time varying variant, one Jacobian per interval evaluated along predicted trajectory
+   * @param stage_jacobians: Jacobian Matrix of each interval, size of horizon
+   * @param current_pose: current end effector pose, initial state
+   * @param goal_pose: Goal pose where want to reach
+   * @param collision_activation: 1.0 activate collision cost, 0.0 deactivate collision cost
+   * @param collision_distance: total self collision distance cost
+   * @param terminal_control: control at end of horizon, last control is pinned to this value
+   * @param control: Resultant control at first step
+   * @return true when QP solved to optimality else false (control is still feasible)
+   */
+  bool solve(const std::vector<Eigen::MatrixXd>& stage_jacobians, const Eigen::VectorXd& current_pose,
+             const Eigen::VectorXd& goal_pose, const double& collision_activation, const double& collision_distance,
+             const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control);
+
+  /**
+   * @brief getPredictedControls: control trajectory of last solve, stacked [v(0) | v(1) | ... | v(N-1)]
+   * @param controls: Resultant controls, sized with degree of freedom * horizon
+   */
+  void getPredictedControls(Eigen::VectorXd& controls) const;
+
+  /**
+   * @brief getNumIterations: number of active set iterations of last solve
+   * @return number of iterations
+   */
+  int getNumIterations() const;
+
+  /**
+   * @brief getStatus: result of last solve, see MpcCoreStatus
+   * @return status
+   */
+  int getStatus() const;
+
+  /**
+   * @brief isSpecialized: true when compile time specialized core is used for configured dimensions
+   */
+  bool isSpecialized() const;
+
+private:
+  // dimensions, number of states always 6 (3 position and 3 orientation)
+  int control_dimension_;
+  int horizon_;
+
+  // compile time specialized core (fixed degree of freedom and horizon) or runtime sized fallback
+  boost::shared_ptr<MpcCoreBase> mpc_core_;
+
+  /**
+   * @brief checkStatus: report unexpected result of last solve
+   * @return true when QP solved to optimality else false
+   */
+  bool checkStatus() const;
+};
+
+#endif
@@ -0,0 +1,129 @@
+
+// This file containts high rate output stage, interpolate predicted control trajectory between two solves
+
+#ifndef PREDICTIVE_CONTROL_CONTROL_INTERPOLATOR_H
+#define PREDICTIVE_CONTROL_CONTROL_INTERPOLATOR_H
+
+// ros includes
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <std_msgs/Float64MultiArray.h>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// std includes
+#include <string>
+#include <algorithm>
+
+// boost includes
+#include <boost/scoped_ptr.hpp>
+
+// predictive includes
+#include <predictive_control/triple_buffer.h>
+
+// control trajectory of one solve, stacked [v(0) | v(1) | ... | v(N-1)], v(k) start at stamp + k * delta_t
+struct ControlTrajectory
+{
+  bool valid;
+  ros::Time stamp;
+  Eigen::VectorXd controls;
+
+  ControlTrajectory() : valid(false)
+  {
+  }
+};
+
+class ControlInterpolator
+{
+  /** Multi rate output stage of predictive controller
+   * - Control timer hand over predicted control trajectory of every solve (lock free, latest value)
+   * - Own timer on own callback queue and spinner, keeps publishing while solve block control timer
+   * - Catmull-Rom spline through controls of trajectory indexed by time since solve
+   * - Interpolated velocity clamped to joint velocity limits, zero velocity once trajectory exhausted
+   */
+
+public:
+  /**
+   * @brief ControlInterpolator: Default constructor, allocate memory
+   */
+  ControlInterpolator();
+
+  /**
+   * @brief ~ControlInterpolator: Default distructor, stop timer and spinner
+   */
+  ~ControlInterpolator();
+
+  /**
+   * @brief initialize: preallocate trajectory buffers, advertise command topic and start interpolation timer
+   * @param nh: node handle used to advertise topic and create timer
+   * @param topic: topic of joint velocity command
+   * @param frequency: publish rate of interpolated command (hz)
+   * @param delta_t: duration of one interval of control trajectory
+   * @param min_velocity: minimum joint velocity limit
+   * @param max_velocity: maximum joint velocity limit
+   * @param intervals: number of intervals of control trajectory
+   * @return true with successful initialize else false
+   */
+  bool initialize(ros::NodeHandle& nh, const std::string& topic, const double& frequency, const double& delta_t,
+                  const Eigen::VectorXd& min_velocity, const Eigen::VectorXd& max_velocity, const int& intervals);
+
+  /**
+   * @brief setTrajectory: hand over control trajectory of latest solve, call only from one thread
+   * @param stamp: time at which first control of trajectory is applied
+   * @param controls: stacked control trajectory [v(0) | v(1) | ... | v(N-1)]
+   */
+  void setTrajectory(const ros::Time& stamp, const Eigen::VectorXd& controls);
+
+  /**
+   * @brief stop: command zero velocity from now on, call only from thread which call setTrajectory
+   * @param stamp: time of stop request
+   */
+  void stop(const ros::Time& stamp);
+
+  /**
+   * @brief getAppliedCommand: latest command published by interpolation timer, call only from one thread
+   * @return joint velocity command, zero before first trajectory is applied
+   */
+  const std_msgs::Float64MultiArray& getAppliedCommand();
+
+  /**
+   * @brief evaluate: interpolated control of trajectory at given time, clamped to velocity limits
+   * @param trajectory: control trajectory of one solve
+   * @param time: time since first control of trajectory (second)
+   * @param velocity: Resultant joint velocity
+   */
+  void evaluate(const ControlTrajectory& trajectory, const double& time, Eigen::VectorXd& velocity) const;
+
+private:
+  int degree_of_freedom_;
+  int intervals_;
+  double delta_t_;
+
+  Eigen::VectorXd min_velocity_;
+  Eigen::VectorXd max_velocity_;
+
+  // control timer -> interpolation timer
+  TripleBuffer<ControlTrajectory> buffer_;
+
+  // interpolation timer runs on own queue, independent of global queue of control timer
+  ros::CallbackQueue callback_queue_;
+  boost::scoped_ptr<ros::AsyncSpinner> spinner_;
+  ros::Timer timer_;
+  ros::Publisher command_pub_;
+
+  // preallocated data of interpolation timer
+  Eigen::VectorXd velocity_;
+  std_msgs::Float64MultiArray command_;
+
+  // interpolation timer -> reader of applied command
+  TripleBuffer<std_msgs::Float64MultiArray> command_buffer_;
+
+  /**
+   * @brief interpolationCallBack: publish interpolated command of latest trajectory
+   * @param event: timer event
+   */
+  void interpolationCallBack(const ros::TimerEvent& event);
+};
+
+#endif
@@ -0,0 +1,52 @@
+
+// This file containts interface of closed form kinematics, exported by predictive_kinematics_generator
+
+#ifndef PREDICTIVE_CONTROL_GENERATED_KINEMATICS_H
+#define PREDICTIVE_CONTROL_GENERATED_KINEMATICS_H
+
+class GeneratedKinematics
+{
+  /** Forward kinematic and Jacobian of one kinematic chain, generated at build time from urdf
+   * - Straight line code, fixed transforms constant folded, one sin/cos pair per joint
+   * - Segment poses column major 4x4 matrices [T(0) | T(1) | ... ], relative to chain base link
+   * - Jacobian column major 6 x degree of freedom, linear velocity first
+   */
+
+public:
+  /**
+   * @brief getDegreeOfFreedom: number of revolute joints of generated chain
+   */
+  static int getDegreeOfFreedom();
+
+  /**
+   * @brief getNumberOfSegments: number of segments of generated chain
+   */
+  static int getNumberOfSegments();
+
+  /**
+   * @brief getChainBaseLink: base link of generated chain
+   */
+  static const char* getChainBaseLink();
+
+  /**
+   * @brief getChainTipLink: tip link of generated chain
+   */
+  static const char* getChainTipLink();
+
+  /**
+   * @brief calculateForwardKinematics: pose of every segment tip
+   * @param joints_angle: joint values, size of degree of freedom
+   * @param segment_poses: Resultant segment poses, size 16 * number of segments
+   */
+  static void calculateForwardKinematics(const double* joints_angle, double* segment_poses);
+
+  /**
+   * @brief calculateJacobian: pose of every segment tip and Jacobian of end effector
+   * @param joints_angle: joint values, size of degree of freedom
+   * @param segment_poses: Resultant segment poses, size 16 * number of segments
+   * @param jacobian: Resultant Jacobian matrix, size 6 * degree of freedom
+   */
+  static void calculateJacobian(const double* joints_angle, double* segment_poses, double* jacobian);
+};
+
+#endif
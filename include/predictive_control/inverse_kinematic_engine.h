@@ -0,0 +1,219 @@
+// This file containts damped least squares inverse kinematic of serial chain, warm started and multi seed mode
+
+#ifndef PREDICTIVE_CONTROL_INVERSE_KINEMATIC_ENGINE_H
+#define PREDICTIVE_CONTROL_INVERSE_KINEMATIC_ENGINE_H
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/Cholesky>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// std includes
+#include <atomic>
+#include <random>
+#include <vector>
+
+#include <predictive_control/kinematic_engine.h>
+
+class InverseKinematicEngine
+{
+  /** Inverse kinematic of serial chain by damped least squares iterations
+   * - Error: position difference and rotation vector (log map) of goal rotation times current rotation transposed
+   * - Step: dq = J^T (J J^T + lambda^2 I)^-1 e, only 6x6 system per iteration, step norm limited
+   * - Joint values clamped to position limits after every step (minimum >= maximum means unlimited joint)
+   * - Warm start from given seed (usually current joint state), if it fails random seeds within limits are solved in
+   *   parallel, first converged worker stops the others
+   * - Worker threads started once in initialize and woken per solve, no thread created per goal
+   * - Every worker owns copy of kinematic engine and buffers, no heap allocation in warm started solve
+   */
+
+public:
+  typedef Eigen::Matrix<double, 6, 1> ErrorVector;
+  typedef Eigen::Matrix<double, 6, 6> SystemMatrix;
+
+  /**
+   * @brief InverseKinematicEngine: Default constructor, not initialized
+   */
+  InverseKinematicEngine();
+
+  /**
+   * @brief ~InverseKinematicEngine: stop and join worker threads
+   */
+  ~InverseKinematicEngine();
+
+  /**
+   * @brief initialize: copy kinematic chain and store solver settings
+   * @param engine: kinematic engine of chain, copied (incremental mode disabled in copy)
+   * @param min_limit: minimum joint position limits
+   * @param max_limit: maximum joint position limits
+   * @param max_iterations: maximum damped least squares iterations per seed
+   * @param damping: damping factor lambda, bound joint step near singular configurations
+   * @param tolerance: norm of pose error (position and rotation vector) treated as converged
+   * @param number_of_seeds: seeds tried by parallel mode, warm start included, one disables parallel mode
+   * @param number_of_threads: worker threads of parallel mode, started here and kept till destruction
+   * @return true with non empty chain and matching limits else false
+   */
+  bool initialize(const KinematicEngine& engine, const std::vector<double>& min_limit,
+                  const std::vector<double>& max_limit, const int& max_iterations, const double& damping,
+                  const double& tolerance, const int& number_of_seeds, const int& number_of_threads);
+
+  /**
+   * @brief solve: joint values which reach goal pose, warm started from seed, random seeds if warm start fails
+   * @param goal: goal pose of end effector relative to chain root
+   * @param seed: initial joint values, usually current joint state
+   * @param joints_angle: Resultant joint values, best found values if goal not reached
+   * @return true if goal pose reached within tolerance else false
+   */
+  bool solve(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed, Eigen::VectorXd& joints_angle);
+
+  /**
+   * @brief solveFromSeed: joint values which reach goal pose from single seed, no parallel mode
+   * @param goal: goal pose of end effector relative to chain root
+   * @param seed: initial joint values
+   * @param joints_angle: Resultant joint values, best found values if goal not reached
+   * @return true if goal pose reached within tolerance else false
+   */
+  bool solveFromSeed(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed, Eigen::VectorXd& joints_angle);
+
+  // norm of remaining pose error of last solve
+  double getError() const
+  {
+    return error_;
+  }
+
+  // iterations of last solve summed over all seeds
+  int getNumIterations() const
+  {
+    return num_iterations_;
+  }
+
+  // seeds tried by last solve, one if warm start converged
+  int getNumSeeds() const
+  {
+    return num_seeds_;
+  }
+
+  int getDegreeOfFreedom() const
+  {
+    return degree_of_freedom_;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  /** own kinematic engine and buffers of one seed solve, one per worker thread */
+  struct Worker
+  {
+    KinematicEngine engine;
+    Eigen::VectorXd joints_angle;
+    Eigen::VectorXd best_joints_angle;
+    Eigen::VectorXd step;
+    ErrorVector error;
+    ErrorVector weighted_error;
+    SystemMatrix system;
+    Eigen::LDLT<SystemMatrix> ldlt;
+    double best_error;
+    int iterations;
+    bool converged;
+
+    // result of parallel mode over all seeds of this worker
+    Eigen::VectorXd result;
+    double result_error;
+    double result_distance;
+    int total_iterations;
+    int seeds_tried;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::vector<Worker, Eigen::aligned_allocator<Worker> > WorkerVector;
+
+  int degree_of_freedom_;
+  int max_iterations_;
+  double damping_;
+  double tolerance_;
+  int number_of_seeds_;
+
+  Eigen::VectorXd min_limit_;
+  Eigen::VectorXd max_limit_;
+
+  // worker 0 solves warm start, all workers solve random seeds in parallel mode (one seed per row)
+  WorkerVector workers_;
+  Eigen::MatrixXd seeds_;
+  std::mt19937 random_generator_;
+
+  // persistent threads of workers 1 ... n - 1, job guarded by pool_mutex_, caller solves worker 0 itself
+  std::vector<boost::shared_ptr<boost::thread> > threads_;
+  boost::mutex pool_mutex_;
+  boost::condition_variable job_condition_;
+  boost::condition_variable done_condition_;
+  const Eigen::Isometry3d* job_goal_;
+  const Eigen::VectorXd* job_seed_;
+  int job_;
+  int pending_workers_;
+  bool running_;
+  std::atomic<bool> stop_;
+
+  // result of last solve
+  double error_;
+  int num_iterations_;
+  int num_seeds_;
+
+  /**
+   * @brief calculatePoseError: position difference and rotation vector between goal and current pose
+   * @param goal: goal pose relative to chain root
+   * @param current: current pose relative to chain root
+   * @param error: Resultant error, [position, rotation vector]
+   */
+  static void calculatePoseError(const Eigen::Isometry3d& goal, const Eigen::Isometry3d& current,
+                                 ErrorVector& error);
+
+  /**
+   * @brief clamp: clamp joint values to position limits
+   * @param joints_angle: joint values, clamped in place
+   */
+  void clamp(Eigen::VectorXd& joints_angle) const;
+
+  /**
+   * @brief iterate: damped least squares iterations of one worker from its current joint values
+   * @param goal: goal pose relative to chain root
+   * @param worker: worker holding initial joint values, result written to best_joints_angle
+   * @param stop: stop request of other workers, null in single seed solve
+   */
+  void iterate(const Eigen::Isometry3d& goal, Worker& worker, const std::atomic<bool>* stop) const;
+
+  /**
+   * @brief solveRandomSeeds: spread random seeds over worker threads, first converged worker stops the others
+   * @param goal: goal pose relative to chain root
+   * @param seed: warm start joint values, solution closest to it is kept
+   * @param joints_angle: Resultant joint values
+   * @return true if any seed converged else false
+   */
+  bool solveRandomSeeds(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed, Eigen::VectorXd& joints_angle);
+
+  /**
+   * @brief solveSeeds: solve seeds index, index + number of workers, ... until converged or stop requested
+   * @param goal: goal pose relative to chain root
+   * @param seed: warm start joint values, converged solution closest to it is kept
+   * @param index: index of worker
+   * @param stop: stop request, set by worker which converged
+   */
+  void solveSeeds(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed, const int index,
+                  std::atomic<bool>* stop);
+
+  /**
+   * @brief runWorker: worker thread, wait for job and solve seeds of worker index
+   * @param index: index of worker, greater than zero
+   */
+  void runWorker(const int index);
+
+  /**
+   * @brief stopWorkers: stop and join worker threads
+   */
+  void stopWorkers();
+};
+
+#endif
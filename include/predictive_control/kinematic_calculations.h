@@ -36,6 +36,15 @@
 //#include <iomanip> std::setprecision(5)
 
 #include <predictive_control/predictive_configuration.h>
+#include <predictive_control/kinematic_engine.h>
+#include <predictive_control/batch_kinematic_engine.h>
+#include <predictive_control/inverse_kinematic_engine.h>
+#include <predictive_control/rigid_body_dynamics.h>
+
+// closed form kinematics, available when built with USE_GENERATED_KINEMATICS
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+#include <predictive_control/generated_kinematics.h>
+#endif
 
 class Kinematic_calculations : public predictive_configuration
 {
@@ -82,8 +91,7 @@ public:
 
   /**
    * @brief calculateForwardKinematicsUsingKDLSolver: Calculate forward kinematics start from root frame to tip link of
-   * manipulator
-   *                                                  by using kdl recursive solver
+   * manipulator by chaining kdl segment poses in single pass, also update FK_Homogenous_Matrix_
    * @param joints_angle: Current joint angle
    * @param FK_Matrix: Resultant Forward Kinematic Matrix
    */
@@ -91,7 +99,7 @@ public:
 
   /**
    * @brief calculateJacobianMatrixUsingKDLSolver: calculate Jacobian Matrix and Forward Kinematics (end effector pose)
-   *                                               by using kdl recursive solver
+   * by using cached kdl recursive solvers, also update FK_Homogenous_Matrix_
    * @param joints_angle: Current joint angle
    * @param FK_Matrix: Resultant formward kinematic matrix
    * @param Jacobian_Matrix: Resultant Jacobian Matrix
@@ -99,6 +107,136 @@ public:
   void calculateJacobianMatrixUsingKDLSolver(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix,
                                              Eigen::MatrixXd& Jacobian_Matrix);
 
+  /**
+   * @brief calculateForwardKinematicsUsingIsometryEngine: Calculate forward kinematics start from root frame to tip
+   * link of manipulator by using allocation free isometry engine, also update FK_Homogenous_Matrix_
+   * @param joints_angle: Current joint angle
+   * @param FK_Matrix: Resultant Forward Kinematic Matrix
+   */
+  void calculateForwardKinematicsUsingIsometryEngine(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix);
+
+  /**
+   * @brief calculateJacobianMatrixUsingIsometryEngine: calculate Jacobian Matrix and Forward Kinematics (end effector
+   * pose) by using allocation free isometry engine, also update FK_Homogenous_Matrix_
+   * @param joints_angle: Current joint angle
+   * @param FK_Matrix: Resultant formward kinematic matrix
+   * @param Jacobian_Matrix: Resultant Jacobian Matrix
+   */
+  void calculateJacobianMatrixUsingIsometryEngine(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix,
+                                                  Eigen::MatrixXd& Jacobian_Matrix);
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+  /**
+   * @brief calculateForwardKinematicsUsingGeneratedCode: Calculate forward kinematics start from root frame to tip
+   * link of manipulator by using closed form generated code, also update FK_Homogenous_Matrix_
+   * @param joints_angle: Current joint angle
+   * @param FK_Matrix: Resultant Forward Kinematic Matrix
+   */
+  void calculateForwardKinematicsUsingGeneratedCode(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix);
+
+  /**
+   * @brief calculateJacobianMatrixUsingGeneratedCode: calculate Jacobian Matrix and Forward Kinematics (end effector
+   * pose) by using closed form generated code, also update FK_Homogenous_Matrix_
+   * @param joints_angle: Current joint angle
+   * @param FK_Matrix: Resultant formward kinematic matrix
+   * @param Jacobian_Matrix: Resultant Jacobian Matrix
+   */
+  void calculateJacobianMatrixUsingGeneratedCode(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix,
+                                                 Eigen::MatrixXd& Jacobian_Matrix);
+#endif
+
+  /**
+   * @brief calculateJacobianDerivative: calculate time derivative of Jacobian Matrix analytically from segment poses
+   * (isometry engine, independent of kinematic backend)
+   * @param joints_angle: Current joint angle
+   * @param joints_velocity: Current joint velocity
+   * @param Jacobian_Derivative: Resultant time derivative of Jacobian Matrix, 6 x degree of freedom
+   */
+  void calculateJacobianDerivative(const Eigen::VectorXd& joints_angle, const Eigen::VectorXd& joints_velocity,
+                                   Eigen::MatrixXd& Jacobian_Derivative);
+
+  /**
+   * @brief calculateJacobianHessian: calculate partial derivative of Jacobian Matrix with respect to every joint
+   * analytically from segment poses (isometry engine, independent of kinematic backend)
+   * @param joints_angle: Current joint angle
+   * @param Jacobian_Hessian: Resultant derivatives, element j is dJ/dq_j of size 6 x degree of freedom
+   */
+  void calculateJacobianHessian(const Eigen::VectorXd& joints_angle, std::vector<Eigen::MatrixXd>& Jacobian_Hessian);
+
+  /**
+   * @brief calculateMassMatrix: calculate joint space inertia (mass) matrix by composite rigid body algorithm, urdf
+   * inertials, independent of kinematic backend
+   * @param joints_angle: Current joint angle
+   * @param Mass_Matrix: Resultant mass matrix, degree of freedom x degree of freedom
+   */
+  void calculateMassMatrix(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& Mass_Matrix);
+
+  /**
+   * @brief calculateInverseDynamics: calculate joint efforts by recursive Newton-Euler algorithm, urdf inertials and
+   * gravity along negative z axis of root link
+   * @param joints_angle: Current joint angle
+   * @param joints_velocity: Current joint velocity
+   * @param joints_acceleration: Desired joint acceleration
+   * @param joints_effort: Resultant joint efforts (torques)
+   */
+  void calculateInverseDynamics(const Eigen::VectorXd& joints_angle, const Eigen::VectorXd& joints_velocity,
+                                const Eigen::VectorXd& joints_acceleration, Eigen::VectorXd& joints_effort);
+
+  /**
+   * @brief calculateBiasEffort: calculate joint efforts of zero joint acceleration (gravity, Coriolis and centrifugal
+   * terms) by recursive Newton-Euler algorithm
+   * @param joints_angle: Current joint angle
+   * @param joints_velocity: Current joint velocity
+   * @param joints_effort: Resultant joint efforts (torques)
+   */
+  void calculateBiasEffort(const Eigen::VectorXd& joints_angle, const Eigen::VectorXd& joints_velocity,
+                           Eigen::VectorXd& joints_effort);
+
+  /**
+   * @brief getFirstChangedSegment: first segment of FK_Homogenous_Matrix_ updated by last forward kinematics call,
+   * segments before it unchanged. Number of segments if nothing changed, 0 without incremental kinematics
+   */
+  int getFirstChangedSegment() const
+  {
+    return first_changed_segment_;
+  }
+
+  /**
+   * @brief calculateForwardKinematicsBatch: Calculate forward kinematics of many joint configurations at once,
+   * structure of arrays layout (AVX2 lanes across configurations when built with USE_AVX2_KINEMATICS)
+   * @param joints_angle: Joint angles, number of configurations x degree of freedom (one configuration per row)
+   * @return batch engine holding segment poses of all configurations, valid until next batch call
+   */
+  const BatchKinematicEngine& calculateForwardKinematicsBatch(const Eigen::MatrixXd& joints_angle);
+
+  /**
+   * @brief calculateJacobianMatrixBatch: calculate Jacobian Matrix and Forward Kinematics of many joint
+   * configurations at once, structure of arrays layout (AVX2 lanes across configurations when built with
+   * USE_AVX2_KINEMATICS)
+   * @param joints_angle: Joint angles, number of configurations x degree of freedom (one configuration per row)
+   * @return batch engine holding segment poses and Jacobians of all configurations, valid until next batch call
+   */
+  const BatchKinematicEngine& calculateJacobianMatrixBatch(const Eigen::MatrixXd& joints_angle);
+
+  /**
+   * @brief calculateInverseKinematics: calculate joint angles which reach given end effector pose by damped least
+   * squares, joint position limits enforced, random seeds solved in parallel if warm start fails
+   * @param FK_Matrix: Goal end effector pose relative to root link, homogeneous matrix
+   * @param seed: Warm start joint angle, usually current joint angle
+   * @param joints_angle: Resultant joint angle, closest found if goal not reached
+   * @return true if goal reached within ik_tolerance else false
+   */
+  bool calculateInverseKinematics(const Eigen::MatrixXd& FK_Matrix, const Eigen::VectorXd& seed,
+                                  Eigen::VectorXd& joints_angle);
+
+  /**
+   * @brief getInverseKinematicEngine: inverse kinematic engine, error and iterations of last solve
+   */
+  const InverseKinematicEngine& getInverseKinematicEngine() const
+  {
+    return *inverse_kinematic_engine_;
+  }
+
   /**
    * @brief calculate_inverse_jacobian_bySVD: calculate inverse of Jacobian Matrix using Singular Value Decomposition
    * @param jacobian: Jacobian Matrix
@@ -151,6 +289,31 @@ private:
   // Axis of Joints
   std::vector<Eigen::Vector3i> axis;
 
+  // allocation free forward kinematic and Jacobian engine, used with kinematic_backend 'isometry'
+  boost::shared_ptr<KinematicEngine> kinematic_engine_;
+
+  // kdl solvers and buffers owned for lifetime of class, used with kinematic_backend 'kdl' and KDL solver functions
+  boost::shared_ptr<KDL::ChainJntToJacSolver> jacobian_solver_;
+  KDL::JntArray kdl_joints_value_;
+  KDL::Frame kdl_frame_;
+  KDL::Jacobian kdl_jacobian_;
+
+  // dirty range of FK_Homogenous_Matrix_, entries in front of it copied from kinematic_engine_ by previous call
+  int first_changed_segment_;
+  bool engine_poses_copied_;
+
+  // same chain as kinematic_engine_, evaluate many joint configurations at once
+  boost::shared_ptr<BatchKinematicEngine> batch_kinematic_engine_;
+
+  // damped least squares inverse kinematics on copy of isometry engine, independent of kinematic backend
+  boost::shared_ptr<InverseKinematicEngine> inverse_kinematic_engine_;
+
+  // mass matrix and inverse dynamics from urdf inertials of chain segments
+  boost::shared_ptr<RigidBodyDynamics> rigid_body_dynamics_;
+
+  // segment poses of generated kinematics, column major 4x4 per segment, used with kinematic_backend 'generated'
+  std::vector<double> generated_segment_poses_;
+
   /**
    * @brief initializeDataMember: initialize data member from kinematic chain
    * @param chain: kinematic chain of robotic description, usually it's full desciption of robots
@@ -163,6 +326,35 @@ private:
    */
   void initializeLimitParameter(const urdf::Model& model);
 
+  /**
+   * @brief initializeKinematicEngine: build isometry engine from kinematic chain and joint axis of urdf model
+   * @param chain: kinematic chain of robotic description
+   * @param model: urdf model of robot desciption
+   * @return true with supported chain (revolute and fixed joints only) else false
+   */
+  bool initializeKinematicEngine(const KDL::Chain& chain, const urdf::Model& model);
+
+  /**
+   * @brief initializeRigidBodyDynamics: collect segment inertials of kinematic chain, kinematic engine should be
+   * initialized before
+   * @param chain: kinematic chain of robotic description
+   * @return true with valid inertial of every segment else false
+   */
+  bool initializeRigidBodyDynamics(const KDL::Chain& chain);
+
+  /**
+   * @brief initializeKDLSolver: construct kdl solvers and buffers of kinematic chain once
+   * @param chain: kinematic chain of robotic description
+   */
+  void initializeKDLSolver(const KDL::Chain& chain);
+
+  /**
+   * @brief initializeGeneratedKinematics: check generated code belongs to configured chain, else fall back to isometry
+   * engine
+   * @return true if generated code is used else false
+   */
+  bool initializeGeneratedKinematics();
+
   /*
   template<typedef T>
   void transformKDLTOEigen(const KDL::Frame& frame, T& matrix)
@@ -0,0 +1,209 @@
+// This file containts allocation free forward kinematic and Jacobian engine of serial chain with revolute joints
+
+#ifndef PREDICTIVE_CONTROL_KINEMATIC_ENGINE_H
+#define PREDICTIVE_CONTROL_KINEMATIC_ENGINE_H
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
+// std includes
+#include <vector>
+
+// joint of segment, rotation about axis of segment tip frame applied after fixed frame to tip
+enum KinematicJointType
+{
+  KINEMATIC_JOINT_FIXED = 0,     // no joint value
+  KINEMATIC_JOINT_ROT_AXIS = 1,  // revolute joint about x, y or z axis (sign stored separately)
+  KINEMATIC_JOINT_ROT_ANY = 2    // revolute joint about arbitrary unit axis
+};
+
+class KinematicEngine
+{
+  /** Forward kinematic and Jacobian of serial chain in pre-sized storage
+   * - Segment pose: T(i) = T(i-1) * F(i) * R(axis, q), F(i) fixed frame to tip of segment
+   * - Axis aligned joints only rotate two columns of rotation matrix, one sin/cos pair per joint
+   * - All storage allocated while chain is built, no heap allocation and no logging per call
+   * - Incremental mode recompute poses only from first joint changed beyond epsilon, Jacobian reused if none changed
+   * - Second order terms from joint axes and origins: time derivative of Jacobian and Hessian (dJ/dq)
+   */
+
+public:
+  typedef std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d> > IsometryVector;
+
+  // maximum degree of freedom, Jacobian is stored without heap allocation
+  static const int MAX_DOF = 16;
+  typedef Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, MAX_DOF> JacobianMatrix;
+  typedef std::vector<JacobianMatrix, Eigen::aligned_allocator<JacobianMatrix> > JacobianVector;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @brief KinematicEngine: Default constructor, empty chain
+   */
+  KinematicEngine();
+
+  /**
+   * @brief clear: remove all segments of chain
+   */
+  void clear();
+
+  /**
+   * @brief addFixedSegment: append segment without joint to chain
+   * @param frame_to_tip: fixed frame from segment root to segment tip
+   */
+  void addFixedSegment(const Eigen::Isometry3d& frame_to_tip);
+
+  /**
+   * @brief addRevoluteSegment: append segment with revolute joint to chain, joint values ordered as segments
+   * @param frame_to_tip: fixed frame from segment root to segment tip
+   * @param axis: axis of rotation expressed in segment tip frame
+   * @return true with valid (non zero) axis else false
+   */
+  bool addRevoluteSegment(const Eigen::Isometry3d& frame_to_tip, const Eigen::Vector3d& axis);
+
+  /**
+   * @brief setIncremental: reuse cached poses of segments in front of first changed joint
+   * @param incremental: enable incremental mode, disabled by default
+   * @param epsilon: joint value change treated as unchanged
+   */
+  void setIncremental(const bool& incremental, const double& epsilon);
+
+  /**
+   * @brief getFirstChangedSegment: first segment recomputed by last forward kinematics call (dirty range till end of
+   * chain), number of segments if nothing changed, always 0 without incremental mode
+   */
+  int getFirstChangedSegment() const
+  {
+    return first_changed_segment_;
+  }
+
+  /**
+   * @brief calculateForwardKinematics: pose of every segment tip relative to chain root
+   * @param joints_angle: joint values, size of degree of freedom
+   * @return pose of last segment (end effector)
+   */
+  const Eigen::Isometry3d& calculateForwardKinematics(const Eigen::VectorXd& joints_angle);
+
+  /**
+   * @brief calculateJacobian: forward kinematics and geometric Jacobian of end effector, linear velocity first
+   * @param joints_angle: joint values, size of degree of freedom
+   * @return Jacobian matrix relative to chain root, 6 x degree of freedom
+   */
+  const JacobianMatrix& calculateJacobian(const Eigen::VectorXd& joints_angle);
+
+  /**
+   * @brief calculateJacobianDerivative: time derivative of Jacobian, dJ/dt = sum_j dJ/dq_j * joint velocity_j
+   * @param joints_angle: joint values, size of degree of freedom
+   * @param joints_velocity: joint velocities, size of degree of freedom
+   * @return time derivative of Jacobian relative to chain root, 6 x degree of freedom
+   */
+  const JacobianMatrix& calculateJacobianDerivative(const Eigen::VectorXd& joints_angle,
+                                                    const Eigen::VectorXd& joints_velocity);
+
+  /**
+   * @brief calculateJacobianHessian: partial derivative of Jacobian with respect to every joint value
+   * @param joints_angle: joint values, size of degree of freedom
+   * @return element j is dJ/dq_j, 6 x degree of freedom each
+   */
+  const JacobianVector& calculateJacobianHessian(const Eigen::VectorXd& joints_angle);
+
+  /**
+   * @brief getSegmentPose: pose of segment tip relative to chain root computed by last call
+   * @param segment: index of segment
+   * @return pose of segment tip
+   */
+  const Eigen::Isometry3d& getSegmentPose(const int& segment) const
+  {
+    return segment_poses_[segment];
+  }
+
+  /**
+   * @brief getSegmentPoses: pose of all segment tips relative to chain root computed by last call
+   * @return pose of segment tips
+   */
+  const IsometryVector& getSegmentPoses() const
+  {
+    return segment_poses_;
+  }
+
+  /**
+   * @brief getEndEffectorPose: pose of last segment computed by last call
+   * @return pose of end effector
+   */
+  const Eigen::Isometry3d& getEndEffectorPose() const
+  {
+    return segment_poses_.back();
+  }
+
+  /**
+   * @brief getFrameToTip: fixed frame from segment root to segment tip
+   * @param segment: index of segment
+   * @return fixed frame of segment
+   */
+  const Eigen::Isometry3d& getFrameToTip(const int& segment) const
+  {
+    return frames_to_tip_[segment];
+  }
+
+  /**
+   * @brief getJointType: type of segment joint, see KinematicJointType
+   * @param segment: index of segment
+   * @return joint type
+   */
+  int getJointType(const int& segment) const
+  {
+    return joint_types_[segment];
+  }
+
+  /**
+   * @brief getJointAxis: unit axis of segment joint expressed in segment tip frame
+   * @param segment: index of segment
+   * @return unit axis, z axis for fixed segment
+   */
+  const Eigen::Vector3d& getJointAxis(const int& segment) const
+  {
+    return axes_[segment];
+  }
+
+  int getNumberOfSegments() const
+  {
+    return segment_poses_.size();
+  }
+
+  int getDegreeOfFreedom() const
+  {
+    return degree_of_freedom_;
+  }
+
+private:
+  int degree_of_freedom_;
+
+  // per segment fixed frame, joint type, rotation axis (index and sign or unit vector) and joint index
+  IsometryVector frames_to_tip_;
+  std::vector<int> joint_types_;
+  std::vector<int> axis_index_;
+  std::vector<double> axis_sign_;
+  std::vector<Eigen::Vector3d> axes_;
+  std::vector<int> joint_index_;
+
+  // computed pose of every segment tip and Jacobian of end effector
+  IsometryVector segment_poses_;
+  JacobianMatrix jacobian_;
+
+  // origin of every joint relative to chain root (axes are angular part of Jacobian), second order terms
+  Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, MAX_DOF> joint_origins_;
+  JacobianMatrix jacobian_derivative_;
+  JacobianVector jacobian_hessian_;
+
+  // incremental mode, joint values used for cached poses and validity of cached poses and Jacobian
+  bool incremental_;
+  double epsilon_;
+  Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MAX_DOF, 1> cached_joints_angle_;
+  bool poses_valid_;
+  bool jacobian_valid_;
+  int first_changed_segment_;
+};
+
+#endif
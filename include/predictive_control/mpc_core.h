@@ -0,0 +1,691 @@
+
+// This file containts compile time specialized MPC core (degree of freedom and horizon length as template parameter)
+
+#ifndef PREDICTIVE_CONTROL_MPC_CORE_H
+#define PREDICTIVE_CONTROL_MPC_CORE_H
+
+// Eigen includes
+#include <Eigen/Eigen>
+#include <Eigen/Dense>
+#include <Eigen/Core>
+
+// std includes
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// result of last solve, every status except MPC_CORE_FAILED leave feasible control trajectory
+enum MpcCoreStatus
+{
+  MPC_CORE_CONVERGED = 0,         // KKT conditions satisfied
+  MPC_CORE_DEADLINE_REACHED = 1,  // stopped at deadline, best feasible iterate
+  MPC_CORE_MAX_ITERATIONS = 2,    // stopped at iteration limit, best feasible iterate
+  MPC_CORE_FAILED = 3             // no usable iterate
+};
+
+class MpcCoreBase
+{
+  /** Runtime interface of MPC core, hide template parameters from caller
+   * - Condensed QP of linear velocity integrator model dot(x) = J * v, Jacobian constant over horizon
+   * - Box constraints on joint velocities, last control pinned to terminal control
+   */
+
+public:
+  virtual ~MpcCoreBase()
+  {
+  }
+
+  /**
+   * @brief setWeights: set LSQ weights, same meaning as lsq_state/control_weight_factors of ACADO formulation
+   * @param state_weights: weight of pose error (3 position and 3 orientation)
+   * @param control_weights: weight of joint velocity, size of degree of freedom
+   * @param collision_weight: weight of collision cost
+   */
+  virtual void setWeights(const Eigen::VectorXd& state_weights, const Eigen::VectorXd& control_weights,
+                          const double& collision_weight) = 0;
+
+  /**
+   * @brief setControlLimits: set joint velocity limits used as box constraints
+   * @param min_limit: minimum joint velocity
+   * @param max_limit: maximum joint velocity
+   */
+  virtual void setControlLimits(const Eigen::VectorXd& min_limit, const Eigen::VectorXd& max_limit) = 0;
+
+  /**
+   * @brief setStageControlLimits: additional limits per interval, intersected with joint velocity limits
+   * @param min_limit: minimum joint velocity, stacked [v(0) | v(1) | ... | v(N-1)], empty vector remove stage limits
+   * @param max_limit: maximum joint velocity, stacked [v(0) | v(1) | ... | v(N-1)], empty vector remove stage limits
+   */
+  virtual void setStageControlLimits(const Eigen::VectorXd& min_limit, const Eigen::VectorXd& max_limit) = 0;
+
+  /**
+   * @brief setHorizon: set time discretization and solver settings
+   * @param delta_t: time discretization (end_time - start_time / number of interval)
+   * @param max_iterations: maximum number of active set iterations
+   * @param tolerance: tolerance on multipliers of active bounds
+   * @param warm_start: start from shifted solution and active set of previous call
+   */
+  virtual void setSolverSettings(const double& delta_t, const int& max_iterations, const double& tolerance,
+                                 const bool& warm_start) = 0;
+
+  /**
+   * @brief setDeadline: compute budget of next solve, counted from call of solve
+   * @param time_budget: budget in seconds, zero or negative disable deadline
+   */
+  virtual void setDeadline(const double& time_budget) = 0;
+
+  /**
+   * @brief solve: build condensed QP and solve it
+   * @param Jacobian_Matrix: Jacobian Matrix use to generate dynamic system of equation
+   * @param current_pose: current end effector pose, initial state
+   * @param goal_pose: Goal pose where want to reach
+   * @param collision_activation: 1.0 activate collision cost, 0.0 deactivate collision cost
+   * @param collision_distance: total self collision distance cost
+   * @param terminal_control: control at end of horizon, last control is pinned to this value
+   * @param control: Resultant control at first step, should be sized with degree of freedom
+   * @return true when QP solved to optimality else false (control is still feasible)
+   */
+  virtual bool solve(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& current_pose,
+                     const Eigen::VectorXd& goal_pose, const double& collision_activation,
+                     const double& collision_distance, const Eigen::VectorXd& terminal_control,
+                     Eigen::VectorXd& control) = 0;
+
+  /**
+   * @brief solve: linear time varying variant, one Jacobian per interval evaluated along predicted trajectory
+   * @param stage_jacobians: Jacobian Matrix of each interval, size of horizon
+   * @param current_pose: current end effector pose, initial state
+   * @param goal_pose: Goal pose where want to reach
+   * @param collision_activation: 1.0 activate collision cost, 0.0 deactivate collision cost
+   * @param collision_distance: total self collision distance cost
+   * @param terminal_control: control at end of horizon, last control is pinned to this value
+   * @param control: Resultant control at first step, should be sized with degree of freedom
+   * @return true when QP solved to optimality else false (control is still feasible)
+   */
+  virtual bool solve(const std::vector<Eigen::MatrixXd>& stage_jacobians, const Eigen::VectorXd& current_pose,
+                     const Eigen::VectorXd& goal_pose, const double& collision_activation,
+                     const double& collision_distance, const Eigen::VectorXd& terminal_control,
+                     Eigen::VectorXd& control) = 0;
+
+  /**
+   * @brief getPredictedControls: control trajectory of last solve, stacked [v(0) | v(1) | ... | v(N-1)]
+   * @param controls: Resultant controls, should be sized with degree of freedom * horizon
+   */
+  virtual void getPredictedControls(Eigen::VectorXd& controls) const = 0;
+
+  /**
+   * @brief getNumIterations: number of active set iterations of last solve
+   */
+  virtual int getNumIterations() const = 0;
+
+  /**
+   * @brief getStatus: MpcCoreStatus of last solve
+   */
+  virtual int getStatus() const = 0;
+
+  /**
+   * @brief getDegreeOfFreedom: number of controls per interval
+   */
+  virtual int getDegreeOfFreedom() const = 0;
+
+  /**
+   * @brief getHorizon: number of intervals
+   */
+  virtual int getHorizon() const = 0;
+
+  /**
+   * @brief isSpecialized: true when dimensions are fixed at compile time
+   */
+  virtual bool isSpecialized() const = 0;
+};
+
+template <int DOF, int N>
+class MpcCore : public MpcCoreBase
+{
+  /** Compile time specialized MPC core, Eigen::Dynamic for both parameters gives runtime sized fallback
+   * - Fixed size Eigen types let compiler unroll and vectorize, no heap allocation for fixed dimensions
+   * - H(i,j) = dt^2 (N - max(i,j)) J^T Q J + delta(i,j) R,  g(i) = dt (N - i) J^T Q (x0 - goal)
+   * - Box constrained QP solved by warm started primal active set method, every iterate is feasible and cost is
+   *   non increasing, so solver can stop at deadline and return current iterate
+   */
+
+public:
+  static const int STATE = 6;
+  static const int VARIABLES = (DOF == Eigen::Dynamic || N == Eigen::Dynamic) ? Eigen::Dynamic : DOF * N;
+
+  typedef Eigen::Matrix<double, STATE, 1> StateVector;
+  typedef Eigen::Matrix<double, STATE, DOF> JacobianMatrix;
+  typedef Eigen::Matrix<double, DOF, STATE> WeightedJacobianMatrix;
+  typedef Eigen::Matrix<double, DOF, 1> ControlVector;
+  typedef Eigen::Matrix<double, DOF, DOF> ControlMatrix;
+  typedef Eigen::Matrix<double, VARIABLES, VARIABLES> HessianMatrix;
+  typedef Eigen::Matrix<double, VARIABLES, 1> VariableVector;
+  typedef Eigen::Matrix<int, VARIABLES, 1> ActiveSetVector;
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, VARIABLES, VARIABLES> ReducedMatrix;
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, VARIABLES, 1> ReducedVector;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @brief MpcCore: allocate memory, runtime dimensions only used by Eigen::Dynamic fallback
+   * @param degree_of_freedom: number of controls per interval
+   * @param horizon: number of intervals
+   */
+  MpcCore(const int& degree_of_freedom = DOF, const int& horizon = N)
+    : dof_(DOF == Eigen::Dynamic ? degree_of_freedom : DOF)
+    , horizon_(N == Eigen::Dynamic ? horizon : N)
+    , variables_(dof_ * horizon_)
+    , delta_t_(1.0)
+    , collision_weight_(0.0)
+    , stage_limits_(false)
+    , llt_(dof_ * horizon_)
+    , max_iterations_(3 * variables_)
+    , num_iterations_(0)
+    , status_(MPC_CORE_CONVERGED)
+    , tolerance_(1e-9)
+    , time_budget_(0.0)
+    , warm_start_(true)
+    , solution_available_(false)
+    , time_varying_(false)
+  {
+    Jacobian_Matrix_.setZero(STATE, dof_);
+    stage_jacobians_.resize(horizon_, Jacobian_Matrix_);
+    stage_weighted_jacobians_.resize(horizon_, WeightedJacobianMatrix::Zero(dof_, STATE));
+    state_weights_.setZero(STATE);
+    error_.setZero(STATE);
+    control_weights_.setZero(dof_);
+    control_min_.setZero(dof_);
+    control_max_.setZero(dof_);
+    JtQe_.setZero(dof_);
+    collision_direction_.setZero(dof_);
+    JtQJ_.setZero(dof_, dof_);
+    H_.setZero(variables_, variables_);
+    g_.setZero(variables_);
+    lb_.setZero(variables_);
+    ub_.setZero(variables_);
+    stage_min_.setZero(variables_);
+    stage_max_.setZero(variables_);
+    z_.setZero(variables_);
+    gradient_.setZero(variables_);
+    active_set_.setZero(variables_);
+    free_index_.setZero(variables_);
+    H_free_.setZero(variables_, variables_);
+    rhs_free_.setZero(variables_);
+    z_free_.setZero(variables_);
+  }
+
+  void setWeights(const Eigen::VectorXd& state_weights, const Eigen::VectorXd& control_weights,
+                  const double& collision_weight)
+  {
+    state_weights_ = state_weights.head(STATE);
+    control_weights_ = control_weights.head(dof_);
+    collision_weight_ = collision_weight;
+  }
+
+  void setControlLimits(const Eigen::VectorXd& min_limit, const Eigen::VectorXd& max_limit)
+  {
+    control_min_ = min_limit.head(dof_);
+    control_max_ = max_limit.head(dof_);
+  }
+
+  void setStageControlLimits(const Eigen::VectorXd& min_limit, const Eigen::VectorXd& max_limit)
+  {
+    stage_limits_ = min_limit.size() >= variables_ && max_limit.size() >= variables_;
+    if (stage_limits_)
+    {
+      stage_min_ = min_limit.head(variables_);
+      stage_max_ = max_limit.head(variables_);
+    }
+  }
+
+  void setSolverSettings(const double& delta_t, const int& max_iterations, const double& tolerance,
+                         const bool& warm_start)
+  {
+    delta_t_ = delta_t;
+    max_iterations_ = max_iterations;
+    tolerance_ = tolerance;
+    warm_start_ = warm_start;
+  }
+
+  void setDeadline(const double& time_budget)
+  {
+    time_budget_ = time_budget;
+  }
+
+  bool solve(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& current_pose,
+             const Eigen::VectorXd& goal_pose, const double& collision_activation, const double& collision_distance,
+             const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control)
+  {
+    // copy into fixed size storage, no allocation
+    Jacobian_Matrix_ = Jacobian_Matrix;
+    time_varying_ = false;
+
+    return solveProblem(current_pose, goal_pose, collision_activation, collision_distance, terminal_control, control);
+  }
+
+  bool solve(const std::vector<Eigen::MatrixXd>& stage_jacobians, const Eigen::VectorXd& current_pose,
+             const Eigen::VectorXd& goal_pose, const double& collision_activation, const double& collision_distance,
+             const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control)
+  {
+    // missing intervals keep Jacobian of last given interval
+    for (int i = 0u; i < horizon_; ++i)
+    {
+      stage_jacobians_[i] = stage_jacobians[std::min<int>(i, stage_jacobians.size() - 1)];
+    }
+    time_varying_ = true;
+
+    return solveProblem(current_pose, goal_pose, collision_activation, collision_distance, terminal_control, control);
+  }
+
+  void getPredictedControls(Eigen::VectorXd& controls) const
+  {
+    controls = z_;
+  }
+  int getNumIterations() const
+  {
+    return num_iterations_;
+  }
+
+  int getStatus() const
+  {
+    return status_;
+  }
+
+  int getDegreeOfFreedom() const
+  {
+    return dof_;
+  }
+
+  int getHorizon() const
+  {
+    return horizon_;
+  }
+
+  bool isSpecialized() const
+  {
+    return VARIABLES != Eigen::Dynamic;
+  }
+
+private:
+  // dimensions
+  int dof_;
+  int horizon_;
+  int variables_;
+  double delta_t_;
+
+  // model and weights
+  JacobianMatrix Jacobian_Matrix_;
+  StateVector state_weights_;
+  StateVector error_;
+  ControlVector control_weights_;
+  ControlVector control_min_;
+  ControlVector control_max_;
+  ControlVector JtQe_;
+  ControlVector collision_direction_;
+  ControlMatrix JtQJ_;
+  double collision_weight_;
+
+  // condensed QP, min 0.5 z^T H z + g^T z, lb <= z <= ub
+  HessianMatrix H_;
+  VariableVector g_;
+  VariableVector lb_;
+  VariableVector ub_;
+
+  // limits per interval (effort constraints), intersected with joint velocity limits
+  bool stage_limits_;
+  VariableVector stage_min_;
+  VariableVector stage_max_;
+
+  // solution and active set (0 free, -1 lower bound, 1 upper bound, 2 pinned), kept for warm start
+  VariableVector z_;
+  VariableVector gradient_;
+  ActiveSetVector active_set_;
+
+  // reduced system over free variables, maximum size known at compile time
+  ActiveSetVector free_index_;
+  ReducedMatrix H_free_;
+  ReducedVector rhs_free_;
+  ReducedVector z_free_;
+  Eigen::LLT<ReducedMatrix> llt_;
+
+  // solver settings
+  int max_iterations_;
+  int num_iterations_;
+  int status_;
+  double tolerance_;
+  double time_budget_;
+  std::chrono::steady_clock::time_point deadline_;
+  bool warm_start_;
+  bool solution_available_;
+
+  // linear time varying model, one Jacobian per interval
+  bool time_varying_;
+  std::vector<JacobianMatrix, Eigen::aligned_allocator<JacobianMatrix> > stage_jacobians_;
+  std::vector<WeightedJacobianMatrix, Eigen::aligned_allocator<WeightedJacobianMatrix> > stage_weighted_jacobians_;
+
+  /**
+   * @brief solveProblem: shift previous solution, build condensed QP from stored Jacobians and solve it
+   */
+  bool solveProblem(const Eigen::VectorXd& current_pose, const Eigen::VectorXd& goal_pose,
+                    const double& collision_activation, const double& collision_distance,
+                    const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control)
+  {
+    deadline_ = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(std::max(time_budget_, 0.0)));
+
+    if (!solution_available_ || !warm_start_)
+    {
+      z_.setZero();
+      active_set_.setZero();
+    }
+    else
+    {
+      shiftSolution();
+    }
+
+    error_ = (current_pose - goal_pose).head(STATE);
+
+    buildCondensedProblem(collision_activation, collision_distance, terminal_control);
+    bool success = solveBoxQP();
+
+    // no usable iterate (non finite data), next solve start cold
+    if (!z_.allFinite())
+    {
+      status_ = MPC_CORE_FAILED;
+      z_.setZero();
+      active_set_.setZero();
+      solution_available_ = false;
+      control = z_.head(dof_);
+      return false;
+    }
+
+    solution_available_ = true;
+    control = z_.head(dof_);
+
+    return success;
+  }
+
+  /**
+   * @brief buildCondensedProblem: closed form Hessian, gradient and bounds of condensed QP
+   */
+  void buildCondensedProblem(const double& collision_activation, const double& collision_distance,
+                             const Eigen::VectorXd& terminal_control)
+  {
+    const int n = dof_;
+
+    if (time_varying_)
+    {
+      // x(k) - goal = e0 + dt * sum(J(j) * v(j), j < k), stage costs k > max(i,j) share block J(i)^T Q J(j)
+      for (int i = 0u; i < horizon_; ++i)
+      {
+        stage_weighted_jacobians_[i].noalias() = stage_jacobians_[i].transpose() * state_weights_.asDiagonal();
+      }
+
+      for (int i = 0u; i < horizon_; ++i)
+      {
+        for (int j = i; j < horizon_; ++j)
+        {
+          H_.block(i * n, j * n, n, n).noalias() =
+              (delta_t_ * delta_t_ * (horizon_ - j)) * stage_weighted_jacobians_[i] * stage_jacobians_[j];
+          if (j != i)
+          {
+            H_.block(j * n, i * n, n, n) = H_.block(i * n, j * n, n, n).transpose();
+          }
+        }
+        H_.block(i * n, i * n, n, n).diagonal() += control_weights_;
+        g_.segment(i * n, n).noalias() = (delta_t_ * (horizon_ - i)) * stage_weighted_jacobians_[i] * error_;
+      }
+    }
+    else
+    {
+      // x(k) - goal = e0 + dt * J * sum(v(0..k-1)), summing stage costs k = 1..N gives closed form blocks
+      JtQJ_.noalias() = Jacobian_Matrix_.transpose() * state_weights_.asDiagonal() * Jacobian_Matrix_;
+      JtQe_.noalias() = Jacobian_Matrix_.transpose() * state_weights_.asDiagonal() * error_;
+
+      for (int i = 0u; i < horizon_; ++i)
+      {
+        for (int j = 0u; j < horizon_; ++j)
+        {
+          H_.block(i * n, j * n, n, n) = (delta_t_ * delta_t_ * (horizon_ - std::max(i, j))) * JtQJ_;
+        }
+        H_.block(i * n, i * n, n, n).diagonal() += control_weights_;
+        g_.segment(i * n, n) = (delta_t_ * (horizon_ - i)) * JtQe_;
+      }
+    }
+
+    // collision cost per stage: w * (a * (d / dt - 1^T J(k) v(k)))^2
+    if (collision_activation > 0.0)
+    {
+      const double weight = collision_weight_ * collision_activation * collision_activation;
+      const double offset = weight * collision_distance / delta_t_;
+      for (int i = 0u; i < horizon_; ++i)
+      {
+        collision_direction_ = (time_varying_ ? stage_jacobians_[i] : Jacobian_Matrix_).colwise().sum().transpose();
+        H_.block(i * n, i * n, n, n).noalias() += weight * collision_direction_ * collision_direction_.transpose();
+        g_.segment(i * n, n) -= offset * collision_direction_;
+      }
+    }
+
+    // velocity bounds, intersected with stage limits (empty intersection keep lower bound), last control pinned to
+    // terminal control
+    for (int i = 0u; i < horizon_; ++i)
+    {
+      lb_.segment(i * n, n) = control_min_;
+      ub_.segment(i * n, n) = control_max_;
+    }
+
+    if (stage_limits_)
+    {
+      lb_ = lb_.cwiseMax(stage_min_);
+      ub_ = ub_.cwiseMin(stage_max_).cwiseMax(lb_);
+    }
+
+    for (int i = 0u, k = (horizon_ - 1) * n; i < n; ++i, ++k)
+    {
+      lb_(k) = std::min(std::max(terminal_control(i), lb_(k)), ub_(k));
+      ub_(k) = lb_(k);
+    }
+  }
+
+  /**
+   * @brief solveBoxQP: primal active set method, start from current z_ and active_set_
+   * @return true when KKT conditions are satisfied else false
+   */
+  bool solveBoxQP()
+  {
+    const int n = variables_;
+
+    // make start point feasible and consistent with active set
+    for (int i = 0u; i < n; ++i)
+    {
+      if (lb_(i) >= ub_(i))
+      {
+        active_set_(i) = 2;
+        z_(i) = lb_(i);
+      }
+      else if (active_set_(i) == -1 || z_(i) <= lb_(i))
+      {
+        active_set_(i) = -1;
+        z_(i) = lb_(i);
+      }
+      else if (active_set_(i) == 1 || z_(i) >= ub_(i))
+      {
+        active_set_(i) = 1;
+        z_(i) = ub_(i);
+      }
+      else
+      {
+        active_set_(i) = 0;
+      }
+    }
+
+    for (num_iterations_ = 0; num_iterations_ < max_iterations_; ++num_iterations_)
+    {
+      // anytime, current iterate is feasible and best so far
+      if (time_budget_ > 0.0 && std::chrono::steady_clock::now() >= deadline_)
+      {
+        status_ = MPC_CORE_DEADLINE_REACHED;
+        return false;
+      }
+
+      // reduced system over free variables, H_FF z_F = -(g_F + H_FA z_A)
+      int free_size = 0;
+      for (int i = 0u; i < n; ++i)
+      {
+        if (active_set_(i) == 0)
+        {
+          free_index_(free_size++) = i;
+        }
+      }
+
+      for (int a = 0u; a < free_size; ++a)
+      {
+        const int row = free_index_(a);
+        double rhs = -g_(row);
+        for (int j = 0u; j < n; ++j)
+        {
+          if (active_set_(j) != 0)
+          {
+            rhs -= H_(row, j) * z_(j);
+          }
+        }
+        rhs_free_(a) = rhs;
+
+        for (int b = 0u; b < free_size; ++b)
+        {
+          H_free_(a, b) = H_(row, free_index_(b));
+        }
+      }
+
+      if (free_size > 0)
+      {
+        llt_.compute(H_free_.topLeftCorner(free_size, free_size));
+        z_free_.head(free_size) = llt_.solve(rhs_free_.head(free_size));
+      }
+
+      // step towards solution of reduced system until first bound blocks
+      double alpha = 1.0;
+      int blocking_index = -1, blocking_bound = 0;
+      for (int a = 0u; a < free_size; ++a)
+      {
+        const int i = free_index_(a);
+        const double step = z_free_(a) - z_(i);
+        if (step < 0.0 && z_(i) + step < lb_(i))
+        {
+          const double t = (lb_(i) - z_(i)) / step;
+          if (t < alpha)
+          {
+            alpha = t;
+            blocking_index = i;
+            blocking_bound = -1;
+          }
+        }
+        else if (step > 0.0 && z_(i) + step > ub_(i))
+        {
+          const double t = (ub_(i) - z_(i)) / step;
+          if (t < alpha)
+          {
+            alpha = t;
+            blocking_index = i;
+            blocking_bound = 1;
+          }
+        }
+      }
+
+      for (int a = 0u; a < free_size; ++a)
+      {
+        const int i = free_index_(a);
+        z_(i) += alpha * (z_free_(a) - z_(i));
+      }
+
+      if (blocking_index >= 0)
+      {
+        active_set_(blocking_index) = blocking_bound;
+        z_(blocking_index) = (blocking_bound < 0) ? lb_(blocking_index) : ub_(blocking_index);
+        continue;
+      }
+
+      // check sign of multipliers of active bounds, release most violating one
+      gradient_.noalias() = H_ * z_;
+      gradient_ += g_;
+
+      int release_index = -1;
+      double max_violation = tolerance_;
+      for (int i = 0u; i < n; ++i)
+      {
+        const double violation =
+            (active_set_(i) == -1) ? -gradient_(i) : ((active_set_(i) == 1) ? gradient_(i) : 0.0);
+        if (violation > max_violation)
+        {
+          max_violation = violation;
+          release_index = i;
+        }
+      }
+
+      if (release_index < 0)
+      {
+        status_ = MPC_CORE_CONVERGED;
+        return true;
+      }
+
+      active_set_(release_index) = 0;
+    }
+
+    status_ = MPC_CORE_MAX_ITERATIONS;
+    return false;
+  }
+
+  /**
+   * @brief shiftSolution: shift solution and active set one interval backwards, last interval doubled
+   */
+  void shiftSolution()
+  {
+    const int n = dof_;
+    for (int i = 0u; i < horizon_ - 1; ++i)
+    {
+      z_.segment(i * n, n) = z_.segment((i + 1) * n, n);
+      active_set_.segment(i * n, n) = active_set_.segment((i + 1) * n, n);
+    }
+
+    // pinned last interval becomes free in shifted solution
+    for (int i = 0u; i < (horizon_ - 1) * n; ++i)
+    {
+      if (active_set_(i) == 2)
+      {
+        active_set_(i) = 0;
+      }
+    }
+  }
+};
+
+/**
+ * @brief createMpcCore: runtime dispatcher, choose compile time specialized core for degree of freedom (joints_name
+ * size) and horizon (discretization_intervals), otherwise runtime sized fallback
+ * @param degree_of_freedom: number of controls per interval
+ * @param horizon: number of intervals
+ * @return MPC core
+ */
+inline boost::shared_ptr<MpcCoreBase> createMpcCore(const int& degree_of_freedom, const int& horizon)
+{
+#define PREDICTIVE_CONTROL_MPC_CORE_CASE(DOF, N)                                                                       \
+  if (degree_of_freedom == DOF && horizon == N)                                                                        \
+  {                                                                                                                    \
+    return boost::shared_ptr<MpcCoreBase>(new MpcCore<DOF, N>());                                                      \
+  }
+
+  PREDICTIVE_CONTROL_MPC_CORE_CASE(6, 4)
+  PREDICTIVE_CONTROL_MPC_CORE_CASE(6, 5)
+  PREDICTIVE_CONTROL_MPC_CORE_CASE(6, 8)
+  PREDICTIVE_CONTROL_MPC_CORE_CASE(7, 4)
+  PREDICTIVE_CONTROL_MPC_CORE_CASE(7, 5)
+  PREDICTIVE_CONTROL_MPC_CORE_CASE(7, 8)
+
+#undef PREDICTIVE_CONTROL_MPC_CORE_CASE
+
+  return boost::shared_ptr<MpcCoreBase>(new MpcCore<Eigen::Dynamic, Eigen::Dynamic>(degree_of_freedom, horizon));
+}
+
+#endif
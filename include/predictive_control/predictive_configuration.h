@@ -86,12 +86,32 @@ public:
 
   // predictive control
   double clock_frequency_;  // hz clock Frequency
+  bool use_solver_thread_;  // solve optimal control problem on dedicated thread
+  double interpolation_frequency_;  // hz publish rate of interpolated command, zero disable interpolation
+  bool use_latency_compensation_;   // solve from initial state predicted over measured latency
+  double latency_filter_gain_;      // gain of exponential moving average of measured latency
+  std::string kinematic_backend_;   // forward kinematic and Jacobian, "homogeneous", "isometry", "generated" or "kdl"
+  bool use_incremental_kinematics_;        // recompute poses only from first changed joint (isometry backend)
+  double incremental_kinematics_epsilon_;  // rad joint value change treated as unchanged
+  bool check_goal_reachability_;           // solve inverse kinematics of every move action goal
+  int ik_max_iterations_;                  // damped least squares iterations per seed
+  double ik_damping_;                      // damping factor of damped least squares step
+  double ik_tolerance_;                    // norm of pose error (m, rad) treated as reached
+  int ik_number_of_seeds_;                 // seeds tried if warm start fails, one disable random seeds
+  int ik_number_of_threads_;               // worker threads of random seeds
   double sampling_time_;
 
   // self collision distance
   double ball_radius_;
   double minimum_collision_distance_;
   double collision_weight_factor_;
+  bool ignore_adjacent_links_;  // exclude ball pairs of same or adjacent link from self collision cost
+  std::vector<std::string> self_collision_ignore_pairs_;  // ball names, consecutive two excluded from cost
+
+  // static collision avoidance
+  bool use_distance_field_;  // static obstacles baked into signed distance grid, rebaked on scene change
+  double distance_field_resolution_;  // distance between grid points
+  double distance_field_size_;  // edge length of grid cube centered at chain root
 
   // acado configuration
   bool use_lagrange_term_;
@@ -104,6 +124,26 @@ public:
   double start_time_horizon_;
   double end_time_horizon_;
 
+  // optimal control solver, "acado" (symbolic ACADO Toolkit), "generated" (exported real time iteration solver) or
+  // "condensed_qp" (native Eigen condensed QP)
+  std::string solver_mode_;
+
+  // warm start solver with shifted state, control trajectory and multipliers of previous solve
+  bool warm_start_;
+
+  // linear time varying model, Jacobian re-evaluated at joint configuration predicted by previous solution
+  bool use_ltv_model_;
+
+  // second order LTV model, stage Jacobian averaged over interval with time derivative of Jacobian
+  bool use_jacobian_derivative_;
+
+  // joint velocity change per interval bounded by effort limits, mass matrix and bias effort of current state
+  bool use_effort_constraints_;
+
+  // compute budget of single control tick (sec), solver return best feasible iterate when reached,
+  // 0.0 derive it from clock frequency
+  double solver_deadline_;
+
 private:
   /**
    * @brief free_allocated_memory: remove all allocated data just for memory management
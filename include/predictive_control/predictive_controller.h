@@ -27,10 +27,12 @@
 #include <math.h>
 #include <algorithm>
 #include <limits>
+#include <atomic>
 
 // boost includes
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
 
 // yaml parsing
 #include <fstream>
@@ -41,6 +43,9 @@
 #include <predictive_control/kinematic_calculations.h>
 #include <predictive_control/collision_detection.h>
 #include <predictive_control/predictive_trajectory_generator.h>
+#include <predictive_control/triple_buffer.h>
+#include <predictive_control/transform_cache.h>
+#include <predictive_control/control_interpolator.h>
 
 // actions, srvs, msgs
 #include <actionlib/server/simple_action_server.h>
@@ -49,6 +54,31 @@
 #include <predictive_control/moveActionGoal.h>
 #include <predictive_control/collision_avoidance.h>
 
+// snapshot of joint state callback, input of solver thread
+struct SolverInput
+{
+  ros::Time stamp;
+  Eigen::MatrixXd Jacobian_Matrix;
+  Eigen::VectorXd joint_position;
+  Eigen::VectorXd current_gripper_pose;
+  Eigen::VectorXd goal_gripper_pose;
+  double self_collision_distance;
+  Eigen::VectorXd static_collision_vector;
+
+  // command applied to robot at snapshot, propagated over latency by solver thread
+  std_msgs::Float64MultiArray applied_velocity;
+};
+
+// result of solver thread, picked up by control timer
+struct SolverOutput
+{
+  ros::Time stamp;
+  std_msgs::Float64MultiArray controlled_velocity;
+  predictive_control::SolverStatistics statistics;
+  ros::Time control_stamp;
+  Eigen::VectorXd control_trajectory;
+};
+
 /*
 struct hold_pose
 {
@@ -130,6 +160,9 @@ public:
   // publish trajectory
   ros::Publisher traj_pub_;
 
+  // publish solve time, deadline hits/misses and fallbacks of optimal control solver
+  ros::Publisher solver_statistics_pub_;
+
 private:
   ros::NodeHandle nh;
 
@@ -138,6 +171,9 @@ private:
 
   tf::TransformListener tf_listener_;
 
+  // latest transform of target frame relative to root link, refreshed without blocking control loop
+  boost::shared_ptr<TransformCache> target_transform_cache_;
+
   // degree of freedom
   uint32_t degree_of_freedom_;
 
@@ -163,6 +199,11 @@ private:
   Eigen::VectorXd current_gripper_pose_;
   Eigen::VectorXd goal_gripper_pose_;
 
+  // joint values reaching goal of last move action (inverse kinematics), terminal joint reference,
+  // written by reachability thread
+  Eigen::VectorXd goal_joint_position_;
+  std::atomic<bool> goal_reachable_;
+
   // current pose hold vector
   // hold_pose hold_pose_;
 
@@ -209,6 +250,46 @@ private:
   // predictive trajectory generator
   boost::shared_ptr<pd_frame_tracker> pd_trajectory_generator_;
 
+  // solver thread, only this thread use pd_trajectory_generator_ when enabled
+  bool use_solver_thread_;
+  boost::thread solver_thread_;
+  std::atomic<bool> stop_solver_thread_;
+
+  // lock free handoff, joint state callback -> solver thread -> control timer
+  TripleBuffer<SolverInput> solver_input_buffer_;
+  TripleBuffer<SolverOutput> solver_output_buffer_;
+
+  // last controlled velocity of solver thread, initial guess and terminal control of next solve
+  std_msgs::Float64MultiArray solver_velocity_;
+
+  // reachability thread, tf transform and inverse kinematics of move action goal off callback queue,
+  // newer goal replaces pending one, guarded by reachability_mutex_
+  boost::thread reachability_thread_;
+  boost::mutex reachability_mutex_;
+  boost::condition_variable reachability_condition_;
+  geometry_msgs::PoseStamped pending_goal_pose_;
+  Eigen::VectorXd pending_goal_seed_;
+  bool goal_pending_;
+  bool stop_reachability_thread_;
+
+  // number of control ticks took longer than clock period
+  uint64_t timer_overruns_;
+
+  // high rate output stage, interpolate commanded trajectory of last solve, null when publishing at solve rate
+  boost::shared_ptr<ControlInterpolator> control_interpolator_;
+  ros::Time commanded_stamp_;
+  Eigen::VectorXd commanded_trajectory_;
+
+  // latency compensation, latency estimate written by control timer and read by solver thread
+  bool use_latency_compensation_;
+  std::atomic<double> latency_estimate_;
+  bool latency_initialized_;
+  ros::Time joint_state_stamp_;
+
+  // initial state of solve predicted over latency, used either by control timer or solver thread
+  Eigen::VectorXd predicted_joint_position_;
+  Eigen::VectorXd predicted_gripper_pose_;
+
   // move to goal position action
   boost::scoped_ptr<actionlib::SimpleActionServer<predictive_control::moveAction> > move_action_server_;
 
@@ -228,6 +309,39 @@ private:
    */
   void spinNode();
 
+  /**
+   * @brief solverThread: solve optimal control problem whenever new snapshot is published by joint state callback
+   */
+  void solverThread();
+
+  /**
+   * @brief reachabilityThread: check reachability of every goal handed over by move action goal callback
+   */
+  void reachabilityThread();
+
+  /**
+   * @brief publishSolverInput: write snapshot of Jacobian, poses and collision cost to solver thread
+   */
+  void publishSolverInput();
+
+  /**
+   * @brief predictInitialState: integrate measured state over estimated latency with last applied command,
+   * dot(q) = v and dot(x) = J * v, result stored in predicted_joint_position_ and predicted_gripper_pose_
+   * @param Jacobian_Matrix: Jacobian Matrix at measured joint values
+   * @param joint_position: measured joint values
+   * @param gripper_pose: measured gripper pose, 3 position and 3 orientation (rpy)
+   * @param velocity: last applied joint velocity command
+   */
+  void predictInitialState(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& joint_position,
+                           const Eigen::VectorXd& gripper_pose, const std_msgs::Float64MultiArray& velocity);
+
+  /**
+   * @brief updateLatencyEstimate: filter latency from joint state measurement till command goes out
+   * @param measurement_stamp: stamp of joint state used by solve
+   * @param command_stamp: time at which command of solve goes out
+   */
+  void updateLatencyEstimate(const ros::Time& measurement_stamp, const ros::Time& command_stamp);
+
   /**
    * @brief runNode: Continue updating this function depend on clock frequency
    * @param event: Used for computation of duration of first and last event
@@ -289,6 +403,23 @@ private:
    */
   bool checkInfinitesimalPose(const Eigen::VectorXd& pose);
 
+  /**
+   * @brief getTargetFromTrackingPose: pose of target frame relative to tracking frame, tracking frame from FK_Matrix_
+   * and target frame from transform cache, never blocks on tf
+   * @param pose: Resultant pose, 3 position and 3 orientation (rpy)
+   * @return true when target transform available else false (pose unchanged)
+   */
+  bool getTargetFromTrackingPose(Eigen::VectorXd& pose);
+
+  /**
+   * @brief checkGoalReachability: solve inverse kinematics of goal pose warm started from joint position of goal
+   * arrival, result stored in goal_joint_position_ and goal_reachable_, called by reachability thread only
+   * @param target_pose: goal pose of end effector
+   * @param seed: joint position when goal arrived
+   * @return true if goal pose reachable within joint limits else false
+   */
+  bool checkGoalReachability(const geometry_msgs::PoseStamped& target_pose, const Eigen::VectorXd& seed);
+
   /**
    * @brief transformStdVectorToEigenVector: tranform std vector to eigen vectors as std vectos are slow to random
    * access
@@ -0,0 +1,123 @@
+
+// This file containts wrapper of generated real time iteration solver, exported by predictive_solver_generator
+
+#ifndef PREDICTIVE_CONTROL_PREDICTIVE_RTI_SOLVER_H
+#define PREDICTIVE_CONTROL_PREDICTIVE_RTI_SOLVER_H
+
+// ros includes
+#include <ros/ros.h>
+
+// Eigen includes
+#include <Eigen/Eigen>
+#include <Eigen/Core>
+
+// std includes
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+class pd_rti_solver
+{
+  /** Wrapper of generated real time iteration solver
+   * - Generated code uses static memory with fixed dimension, only single instance exists per process
+   * - Fill initial state, online data (Jacobian, collision terms, terminal control) and references (goal pose)
+   * - Run one preparation and feedback step per control tick
+   */
+
+public:
+  /**
+   * @brief pd_rti_solver: Default constructor, allocate memory
+   */
+  pd_rti_solver();
+
+  /**
+   * @brief ~pd_rti_solver: Default distructor, free memory
+   */
+  ~pd_rti_solver();
+
+  /**
+   * @brief initialize: initialize generated solver and weighting matrices, check dimensions against configuration
+   * @param degree_of_freedom: degree of freedom of manipulator, should be same as generated control dimension
+   * @param lsq_state_weight_factors: lsq weight factors of state (3 position and 3 orientation)
+   * @param lsq_control_weight_factors: lsq weight factors of control, same size as degree of freedom
+   * @param collision_weight_factor: weight factor of collision cost
+   * @return true with successful initialize else false
+   */
+  bool initialize(const unsigned int& degree_of_freedom, const Eigen::VectorXd& lsq_state_weight_factors,
+                  const Eigen::VectorXd& lsq_control_weight_factors, const double& collision_weight_factor);
+
+  /**
+   * @brief solve: run one real time iteration and get control at first step
+   * @param Jacobian_Matrix: Jacobian Matrix use as online data of dynamic system
+   * @param current_pose: current end effector pose, initial state
+   * @param goal_pose: Goal pose where want to reach, reference of state
+   * @param collision_activation: 1.0 activate collision cost, 0.0 deactivate collision cost
+   * @param collision_distance: total self collision distance cost
+   * @param terminal_control: control at end of horizon, equality constraint on last interval
+   * @param control: Resultant control at first step
+   * @return true when QP solved successfully else false
+   */
+  bool solve(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& current_pose,
+             const Eigen::VectorXd& goal_pose, const double& collision_activation, const double& collision_distance,
+             const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control);
+
+  /**
+   * @brief solve: linear time varying variant, one Jacobian per shooting node as online data
+   * @param stage_jacobians: Jacobian Matrix of each interval, size of horizon
+   * @param current_pose: current end effector pose, initial state
+   * @param goal_pose: Goal pose where want to reach, reference of state
+   * @param collision_activation: 1.0 activate collision cost, 0.0 deactivate collision cost
+   * @param collision_distance: total self collision distance cost
+   * @param terminal_control: control at end of horizon, equality constraint on last interval
+   * @param control: Resultant control at first step
+   * @return true when QP solved successfully else false
+   */
+  bool solve(const std::vector<Eigen::MatrixXd>& stage_jacobians, const Eigen::VectorXd& current_pose,
+             const Eigen::VectorXd& goal_pose, const double& collision_activation, const double& collision_distance,
+             const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control);
+
+  /**
+   * @brief initializeHorizon: cold start, initialize all shooting nodes with current state and zero control
+   * @param current_pose: current end effector pose
+   */
+  void initializeHorizon(const Eigen::VectorXd& current_pose);
+
+  /**
+   * @brief shiftHorizon: warm start, shift state and control trajectory one interval, last interval doubled
+   */
+  void shiftHorizon();
+
+  /**
+   * @brief getPredictedControls: control trajectory of last real time iteration, stacked [v(0) | ... | v(N-1)]
+   * @param controls: Resultant controls, sized with degree of freedom * number of intervals
+   */
+  void getPredictedControls(Eigen::VectorXd& controls) const;
+
+  /**
+   * @brief getKKTValue: KKT value of last real time iteration
+   * @return kkt value
+   */
+  double getKKTValue() const;
+
+  /**
+   * @brief getObjectiveValue: objective value of last real time iteration
+   * @return objective value
+   */
+  double getObjectiveValue() const;
+
+private:
+  bool initialized_;
+
+  /**
+   * @brief setOnlineData: write Jacobian, collision terms and terminal control of single shooting node
+   */
+  void setOnlineData(const int& node, const Eigen::MatrixXd& Jacobian_Matrix, const double& collision_activation,
+                     const double& collision_distance, const Eigen::VectorXd& terminal_control);
+
+  /**
+   * @brief runIteration: set initial state and references, run preparation and feedback step
+   */
+  bool runIteration(const Eigen::VectorXd& current_pose, const Eigen::VectorXd& goal_pose, Eigen::VectorXd& control);
+};
+
+#endif
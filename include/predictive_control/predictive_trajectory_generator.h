@@ -12,7 +12,6 @@
 #include <std_msgs/String.h>
 #include <std_msgs/Float64MultiArray.h>
 #include <tf/tf.h>
-#include <tf/transform_listener.h>
 
 // Eigen includes
 #include <Eigen/Eigen>
@@ -25,6 +24,8 @@
 #include <algorithm>
 #include <iomanip>  //print false or true
 #include <math.h>
+#include <cmath>
+#include <limits>
 
 // boost includes
 #include <boost/shared_ptr.hpp>
@@ -40,6 +41,15 @@
 
 // predictive includes
 #include <predictive_control/predictive_configuration.h>
+#include <predictive_control/async_logger.h>
+#include <predictive_control/condensed_qp_tracker.h>
+#include <predictive_control/kinematic_calculations.h>
+#include <predictive_control/SolverStatistics.h>
+
+// generated real time iteration solver, available when built with USE_GENERATED_RTI_SOLVER
+#ifdef PREDICTIVE_CONTROL_GENERATED_SOLVER
+#include <predictive_control/predictive_rti_solver.h>
+#endif
 
 using namespace ACADO;
 
@@ -63,20 +73,22 @@ public:
   ~pd_frame_tracker();
 
   /**
-   * @brief initialize: initialize frame tracker class and data members
+   * @brief initialize: initialize frame tracker class and data members, build optimal control problem once
    * @return true with successful initialize else false
    */
   bool initialize();  // virtual
 
   /**
    * @brief solveOptimalControlProblem: Handle execution of whole class, solve optimal control problem using ACADO
-   * Toolkit
+   * Toolkit. Problem is built once in initialize, here only online parameters are updated and solver is stepped
    * @param Jacobian_Matrix: Jacobian Matrix use to generate dynamic system of equation
+   * @param joint_position: current joint values, start of predicted joint trajectory of LTV model
    * @param last_position: current/last joint values used to initialize states
    * @param goal_pose: Goal pose where want to reach
    * @param controlled_velocity: controlled velocity use to publish
    */
-  void solveOptimalControlProblem(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& last_position,
+  void solveOptimalControlProblem(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& joint_position,
+                                  const Eigen::VectorXd& last_position,
                                   const Eigen::VectorXd& goal_pose, const double& self_collision_vector,
                                   const Eigen::VectorXd& static_collision_vector,
                                   std_msgs::Float64MultiArray& controlled_velocity);
@@ -87,6 +99,29 @@ public:
    */
   std_msgs::Float64MultiArray hardCodedOptimalControlSolver();
 
+  /**
+   * @brief getCommandedTrajectory: remaining control trajectory starting with control commanded at last solve,
+   * zero padded, all zero when no usable trajectory is left
+   * @param controls: Resultant stacked control trajectory [v(0) | v(1) | ... | v(N-1)]
+   */
+  void getCommandedTrajectory(Eigen::VectorXd& controls) const;
+
+  /**
+   * @brief getSolverStatistics: deadline, solve time and counters of solves since initialize
+   * @return solver statistics, updated every solve
+   */
+  const predictive_control::SolverStatistics& getSolverStatistics() const
+  {
+    return solver_statistics_;
+  }
+
+  /**
+   * @brief updateControllerStatistics: store statistics measured by controller with solver statistics
+   * @param timer_overruns: number of control ticks took longer than clock period
+   * @param latency: filtered latency from joint state measurement to command (sec)
+   */
+  void updateControllerStatistics(const uint64_t& timer_overruns, const double& latency);
+
   // STATIC FUNCTION, NO NEED OBJECT OF CLASS, DIRECT CALL WITHOUT OBJECT
   /**
    * @brief transformStdVectorToEigenVector: tranform std vector to eigen vectors as std vectos are slow to random
@@ -110,11 +145,80 @@ public:
   }
 
 private:
-  // tf listerner
-  tf::TransformListener tf_listener_;
 
-  // Jacobian matrix
-  DMatrix Jacobian_Matrix_;
+  // OCP variables, created once and kept alive as long as solver use them
+  boost::shared_ptr<DifferentialState> x_;
+  boost::shared_ptr<Control> v_;
+
+  // online parameters, order of declaration gives layout of online_parameter_ vector
+  // [ Jacobian (row major) | goal pose | collision activation | collision distance | terminal control ]
+  // fixed to online_parameter_ by solver each tick, not optimized
+  boost::shared_ptr<Parameter> jacobian_parameter_;
+  boost::shared_ptr<Parameter> goal_parameter_;
+  boost::shared_ptr<Parameter> collision_activation_parameter_;
+  boost::shared_ptr<Parameter> collision_distance_parameter_;
+  boost::shared_ptr<Parameter> terminal_control_parameter_;
+
+  // Differential Kinematic, optimal control problem and real time solver
+  boost::shared_ptr<DifferentialEquation> f_;
+  boost::shared_ptr<OCP> OCP_problem_;
+  boost::shared_ptr<RealTimeAlgorithm> OCP_solver_;
+  bool OCP_solver_initialized_;
+
+  // values of online parameter, updated every control tick
+  DVector online_parameter_;
+
+  // optimal control solver, "acado", "generated" or "condensed_qp"
+  std::string solver_mode_;
+
+  // native condensed QP solver
+  boost::shared_ptr<pd_condensed_qp_tracker> condensed_qp_solver_;
+
+  // terminal control and resultant control of native solver, reused every control tick
+  Eigen::VectorXd terminal_control_;
+  Eigen::VectorXd control_;
+  Eigen::VectorXd control_trajectory_;
+
+  // warm start, shifted state and control trajectory of previous solve kept inside solver as initial guess
+  bool warm_start_;
+
+  // control trajectory of last solve, copied into fallback trajectory
+  VariablesGrid predicted_controls_;
+
+  // per tick deadline, counters of deadline hits/misses and fallbacks, published by controller
+  predictive_control::SolverStatistics solver_statistics_;
+
+  // control trajectory of last usable solve, stacked [v(0) | v(1) | ... | v(N-1)], used as fallback command
+  Eigen::VectorXd fallback_controls_;
+  int fallback_index_;
+
+  // interval of stored trajectory commanded at last tick, discretization_intervals_ when zero velocity commanded
+  int commanded_interval_;
+
+  // linear time varying model, own kinematic solver so solver thread never share kinematic buffers
+  bool use_ltv_model_;
+  boost::shared_ptr<Kinematic_calculations> ltv_kinematic_solver_;
+  std::vector<Eigen::MatrixXd> stage_jacobians_;
+  Eigen::VectorXd predicted_joint_position_;
+  Eigen::MatrixXd predicted_FK_Matrix_;
+
+  // second order LTV model, joint velocity of interval and time derivative of stage Jacobian
+  bool use_jacobian_derivative_;
+  Eigen::VectorXd stage_joint_velocity_;
+  Eigen::MatrixXd stage_jacobian_derivative_;
+
+  // effort constraints, own kinematic solver (shared with LTV model) for mass matrix and bias effort
+  bool use_effort_constraints_;
+  boost::shared_ptr<Kinematic_calculations> dynamics_solver_;
+  Eigen::MatrixXd mass_matrix_;
+  Eigen::VectorXd bias_effort_;
+  Eigen::VectorXd stage_control_min_;
+  Eigen::VectorXd stage_control_max_;
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_SOLVER
+  // generated real time iteration solver
+  boost::shared_ptr<pd_rti_solver> rti_solver_;
+#endif
 
   // state initialization
   DVector state_initialize_;
@@ -151,6 +255,61 @@ private:
   Eigen::VectorXd lsq_control_weight_factors_;
   uint32_t control_vector_size_;
 
+  /**
+   * @brief setupOptimalControlProblem: create symbolic variables, differential equation, cost function and solver
+   * once, afterwards only online parameters are changed at every control tick
+   * @return true with successful setup else false
+   */
+  bool setupOptimalControlProblem();
+
+  /**
+   * @brief updateOnlineParameters: fill online parameter vector in the same order as parameters are declared
+   * @param Jacobian_Matrix: Jacobian Matrix use to generate dynamic system of equation
+   * @param goal_pose: Goal pose where want to reach
+   * @param self_collision_vector: total self collision distance cost
+   * @param controlled_velocity: last controlled velocity used as terminal control
+   */
+  void updateOnlineParameters(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& goal_pose,
+                              const double& self_collision_vector,
+                              const std_msgs::Float64MultiArray& controlled_velocity);
+
+  /**
+   * @brief updateStageJacobians: Jacobian at joint configuration of each interval, joints integrated with shifted
+   * control trajectory of previous solve, with Jacobian derivative mean Jacobian over interval
+   * @param Jacobian_Matrix: Jacobian Matrix at current joint configuration, used for first interval
+   * @param joint_position: current joint values
+   */
+  void updateStageJacobians(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& joint_position);
+
+  /**
+   * @brief updateEffortLimits: joint velocity limits per interval from effort limits, M(q) * dv / dt + h(q, v) kept
+   * inside effort limits for every joint acceleration of box |dv_j / dt| <= s / M_jj, s largest feasible scale
+   * @param joint_position: current joint values
+   * @param joint_velocity: last controlled joint velocity, start of velocity trajectory
+   */
+  void updateEffortLimits(const Eigen::VectorXd& joint_position, const Eigen::VectorXd& joint_velocity);
+
+  /**
+   * @brief storeFallbackTrajectory: keep control trajectory of usable solve as fallback command of next ticks
+   * @param controls: stacked control trajectory [v(0) | v(1) | ... | v(N-1)]
+   * @param next_index: interval applied at next tick (1 for unshifted, 0 for already shifted trajectory)
+   */
+  void storeFallbackTrajectory(const Eigen::VectorXd& controls, const int& next_index);
+
+  /**
+   * @brief applyFallbackControl: apply next control of stored trajectory, zero velocity when trajectory exhausted
+   * @param controlled_velocity: Resultant controlled velocity
+   */
+  void applyFallbackControl(std_msgs::Float64MultiArray& controlled_velocity);
+
+  /**
+   * @brief updateSolverStatistics: update compute time and deadline counters of current tick
+   * @param tick_start: wall time at start of tick
+   * @param status: result of solver, see MpcCoreStatus
+   * @param iterations: number of solver iterations
+   */
+  void updateSolverStatistics(const ros::WallTime& tick_start, const int& status, const int& iterations);
+
   /**
    * @brief generateCostFunction: generate cost function, minimizeMayaerTerm, LSQ using weighting matrix and reference
    * vector
@@ -158,10 +317,10 @@ private:
    * @param OCP_problem: Current optimal control problem
    * @param x: Differential state represent dynamic system of equations
    * @param v: Control state use to control manipulator, in our case joint velocity
-   * @param goal_pose: Target pose where want to move
+   * @param goal_pose: Target pose where want to move, online parameter
    */
   void generateCostFunction(OCP& OCP_problem, const DifferentialState& x, const Control& v,
-                            const Eigen::VectorXd& goal_pose);
+                            const Expression& goal_pose);
 
   /**
    * @brief generateCostFunction: generate collision cost function, minimizeMayaerTerm, LSQ using weighting matrix and
@@ -169,12 +328,14 @@ private:
    *                               Langrange
    * @param OCP_problem: Current optimal control problem
    * @param v: Control state use to control manipulator, in our case joint velocity
-   * @param Jacobian_Matrix: Jacobian Matrix used to get cartesian velocity
-   * @param total_distance: total distance between center of ball, sum all distance
+   * @param Jacobian_Matrix: Jacobian Matrix used to get cartesian velocity, online parameter
+   * @param activation: 1.0 activate collision cost, 0.0 deactivate collision cost, online parameter
+   * @param total_distance: total distance between center of ball, sum all distance, online parameter
    * @param delta_t: time discretization (end_time - start_time / number of interval)
    */
-  void generateCollisionCostFunction(OCP& OCP_problem, const Control& v, const Eigen::MatrixXd& Jacobian_Matrix,
-                                     const double& total_distance, const double& delta_t);
+  void generateCollisionCostFunction(OCP& OCP_problem, const Control& v, const Expression& Jacobian_Matrix,
+                                     const Expression& activation, const Expression& total_distance,
+                                     const double& delta_t);
 
   /**
    * @brief setAlgorithmOptions: setup solver options, Optimal control solver or RealTimeSolver(MPC)
@@ -207,14 +368,11 @@ private:
   void calculateQuaternionInverse(const geometry_msgs::Quaternion& quat, geometry_msgs::Quaternion& quat_inv);
 
   /**
-   * @brief getTransform: Find transformation stamed rotation is in the form of quaternion
-   * @param from: source frame from find transformation
-   * @param to: target frame till find transformation
-   * @param stamped_pose: Resultant poseStamed between source and target frame
-   * @return: true if transform else false
+   * @brief getQuaternionFromPose: Convert orientation of pose vector into quaternion
+   * @param pose: 3 position and 3 orientation (rpy)
+   * @param quat_msg: Resultant quaternion
    */
-  bool getTransform(const std::string& from, const std::string& to, Eigen::VectorXd& stamped_pose,
-                    geometry_msgs::Quaternion& quat_msg);
+  void getQuaternionFromPose(const Eigen::VectorXd& pose, geometry_msgs::Quaternion& quat_msg);
 
   /**
    * @brief clearDataMember: clear vectors means free allocated memory
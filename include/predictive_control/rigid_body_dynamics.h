@@ -0,0 +1,116 @@
+// This file containts allocation free rigid body dynamics (mass matrix and inverse dynamics) of serial chain
+
+#ifndef PREDICTIVE_CONTROL_RIGID_BODY_DYNAMICS_H
+#define PREDICTIVE_CONTROL_RIGID_BODY_DYNAMICS_H
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// std includes
+#include <vector>
+
+#include <predictive_control/kinematic_engine.h>
+
+class RigidBodyDynamics
+{
+  /** Joint space dynamics tau = M(q) * ddq + h(q, dq) of serial chain with revolute joints
+   * - Segment inertial: mass, center of mass and rotational inertia about center of mass in segment tip frame
+   * - Inverse dynamics by recursive Newton-Euler algorithm, quantities relative to chain root, gravity as base
+   *   acceleration
+   * - Mass matrix by composite rigid body algorithm, composite inertia of every subtree about its center of mass
+   * - Segment poses from own copy of kinematic engine, all storage allocated in initialize
+   */
+
+public:
+  /**
+   * @brief RigidBodyDynamics: Default constructor, empty chain
+   */
+  RigidBodyDynamics();
+
+  /**
+   * @brief initialize: copy kinematic chain and inertial of every segment
+   * @param engine: kinematic engine of chain, copied (incremental mode disabled in copy)
+   * @param masses: mass of every segment
+   * @param centers_of_mass: center of mass of every segment, expressed in segment tip frame
+   * @param inertias: rotational inertia of every segment about its center of mass, expressed in segment tip frame
+   * @return true with non empty chain and one inertial per segment else false
+   */
+  bool initialize(const KinematicEngine& engine, const std::vector<double>& masses,
+                  const std::vector<Eigen::Vector3d>& centers_of_mass, const std::vector<Eigen::Matrix3d>& inertias);
+
+  /**
+   * @brief setGravity: gravity acceleration relative to chain root, default (0, 0, -9.81)
+   * @param gravity: gravity vector
+   */
+  void setGravity(const Eigen::Vector3d& gravity);
+
+  /**
+   * @brief calculateInverseDynamics: joint efforts of given motion, recursive Newton-Euler algorithm
+   * @param joints_angle: joint values, size of degree of freedom
+   * @param joints_velocity: joint velocities, size of degree of freedom
+   * @param joints_acceleration: joint accelerations, size of degree of freedom
+   * @return joint efforts M(q) * ddq + h(q, dq), valid until next call
+   */
+  const Eigen::VectorXd& calculateInverseDynamics(const Eigen::VectorXd& joints_angle,
+                                                  const Eigen::VectorXd& joints_velocity,
+                                                  const Eigen::VectorXd& joints_acceleration);
+
+  /**
+   * @brief calculateBiasEffort: joint efforts of zero joint acceleration, gravity, Coriolis and centrifugal terms
+   * @param joints_angle: joint values, size of degree of freedom
+   * @param joints_velocity: joint velocities, size of degree of freedom
+   * @return joint efforts h(q, dq), valid until next call
+   */
+  const Eigen::VectorXd& calculateBiasEffort(const Eigen::VectorXd& joints_angle,
+                                             const Eigen::VectorXd& joints_velocity);
+
+  /**
+   * @brief calculateMassMatrix: joint space inertia matrix, composite rigid body algorithm
+   * @param joints_angle: joint values, size of degree of freedom
+   * @return symmetric positive definite mass matrix, degree of freedom x degree of freedom
+   */
+  const Eigen::MatrixXd& calculateMassMatrix(const Eigen::VectorXd& joints_angle);
+
+  int getNumberOfSegments() const
+  {
+    return masses_.size();
+  }
+
+  int getDegreeOfFreedom() const
+  {
+    return degree_of_freedom_;
+  }
+
+private:
+  int degree_of_freedom_;
+  Eigen::Vector3d gravity_;
+
+  // segment poses
+  KinematicEngine engine_;
+
+  // per segment inertial in segment tip frame
+  std::vector<double> masses_;
+  std::vector<Eigen::Vector3d> centers_of_mass_;
+  std::vector<Eigen::Matrix3d> inertias_;
+
+  // per segment quantities relative to chain root: joint axis, angular velocity, angular and linear (origin)
+  // acceleration, force and moment (about center of mass) acting on segment body
+  Eigen::Matrix3Xd axes_;
+  Eigen::Matrix3Xd angular_velocities_;
+  Eigen::Matrix3Xd angular_accelerations_;
+  Eigen::Matrix3Xd linear_accelerations_;
+  Eigen::Matrix3Xd forces_;
+  Eigen::Matrix3Xd moments_;
+
+  // composite body of every subtree: mass, center of mass relative to chain root, inertia about center of mass
+  std::vector<double> composite_masses_;
+  Eigen::Matrix3Xd composite_centers_;
+  std::vector<Eigen::Matrix3d> composite_inertias_;
+
+  Eigen::VectorXd zero_acceleration_;
+  Eigen::VectorXd joints_effort_;
+  Eigen::MatrixXd mass_matrix_;
+};
+
+#endif
@@ -0,0 +1,154 @@
+// This file containts vectorized pairwise self collision cost and gradient of collision model spheres
+
+#ifndef PREDICTIVE_CONTROL_SELF_COLLISION_KERNEL_H
+#define PREDICTIVE_CONTROL_SELF_COLLISION_KERNEL_H
+
+// Eigen includes
+#include <Eigen/Core>
+
+// std includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <predictive_control/collision_model.h>
+
+class SelfCollisionKernel
+{
+  /** Logistic self collision cost of every sphere pair, c_ij = exp((d_min^2 - |p_i - p_j|^2) / w)
+   * - Squared distances only, no square root
+   * - Excluded pairs (same or adjacent link, ignored by name) kept as bitmask per sphere, built once with layout
+   * - Pairs i < j of row i evaluated four at once when built with USE_AVX2_COLLISION (exponential vectorized too),
+   *   else scalar loop of same kernel
+   * - Per pair cost and gradient dc_ij/dp_i = -2 / w * c_ij * (p_i - p_j) stored in upper triangle (row major),
+   *   gradient with respect to p_j is negative of it, excluded pairs are zero
+   * - Storage allocated in initialize, no heap allocation per evaluation
+   */
+
+public:
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> PairMatrix;
+
+  /**
+   * @brief SelfCollisionKernel: Default constructor, no spheres
+   */
+  SelfCollisionKernel();
+
+  /**
+   * @brief initialize: allocate storage and build exclusion mask of collision model layout
+   * @param model: collision model with final layout
+   * @param ignore_adjacent_links: exclude pairs of spheres on same or adjacent link (constant distance)
+   */
+  void initialize(const CollisionModel& model, const bool& ignore_adjacent_links);
+
+  /**
+   * @brief ignorePair: exclude or include pair of spheres
+   * @param first: index of first sphere
+   * @param second: index of second sphere
+   * @param ignore: true to exclude pair from cost
+   */
+  void ignorePair(const int& first, const int& second, const bool& ignore = true);
+
+  /**
+   * @brief ignorePair: exclude pair of spheres given by name
+   * @param first: name of first sphere
+   * @param second: name of second sphere
+   * @param model: collision model used for name lookup
+   * @return true if both names found else false
+   */
+  bool ignorePair(const std::string& first, const std::string& second, const CollisionModel& model);
+
+  /**
+   * @brief isPairIgnored: check exclusion mask
+   * @param first: index of first sphere
+   * @param second: index of second sphere
+   * @return true if pair excluded from cost
+   */
+  bool isPairIgnored(const int& first, const int& second) const;
+
+  /**
+   * @brief evaluate: cost and gradient of every pair, cost of every sphere summed over its pairs
+   * @param model: collision model with current centers, same layout as initialize
+   * @param collision_min_distance: Minimum collision distance, below that should not go
+   * @param weight_factor: convergence rate
+   * @return sum of cost of all pairs
+   */
+  double evaluate(const CollisionModel& model, const double& collision_min_distance, const double& weight_factor);
+
+  // cost of every sphere, sum of cost of its pairs
+  const Eigen::VectorXd& getSphereCost() const
+  {
+    return sphere_cost_;
+  }
+
+  // cost of pair (i, j), i < j, upper triangle
+  const PairMatrix& getPairCost() const
+  {
+    return pair_cost_;
+  }
+
+  // gradient of pair cost with respect to center of first sphere of pair (i < j), x, y and z component
+  const PairMatrix& getPairGradientX() const
+  {
+    return pair_gradient_x_;
+  }
+
+  const PairMatrix& getPairGradientY() const
+  {
+    return pair_gradient_y_;
+  }
+
+  const PairMatrix& getPairGradientZ() const
+  {
+    return pair_gradient_z_;
+  }
+
+  // gradient of cost of every sphere with respect to its own center, number of spheres x 3
+  const Eigen::MatrixX3d& getSphereGradient() const
+  {
+    return sphere_gradient_;
+  }
+
+  int getNumberOfSpheres() const
+  {
+    return spheres_;
+  }
+
+  /**
+   * @brief isVectorized: true if built with AVX2 kernel
+   */
+  static bool isVectorized();
+
+private:
+  int spheres_;
+
+  // exclusion bitmask, row i holds bit j of every excluded pair, words_per_row_ words per row
+  int words_per_row_;
+  std::vector<uint64_t> mask_;
+
+  Eigen::VectorXd sphere_cost_;
+  Eigen::MatrixX3d sphere_gradient_;
+  PairMatrix pair_cost_;
+  PairMatrix pair_gradient_x_;
+  PairMatrix pair_gradient_y_;
+  PairMatrix pair_gradient_z_;
+
+  /**
+   * @brief evaluatePairs: pairs (row, j) from j = begin while Lane::WIDTH pairs are left, Lane::WIDTH pairs at once
+   * @param model: collision model with current centers
+   * @param row: index of first sphere of pairs
+   * @param begin: index of first second sphere, greater than row
+   * @param min_distance_squared: squared minimum collision distance
+   * @param inverse_weight: inverse of weight factor
+   * @return index of first second sphere not evaluated
+   */
+  template <typename Lane>
+  int evaluatePairs(const CollisionModel& model, const int& row, const int& begin, const double& min_distance_squared,
+                    const double& inverse_weight);
+
+  /**
+   * @brief getMaskBits: exclusion bits of pairs (row, j) ... (row, j + 3), bit k set if pair (row, j + k) excluded
+   */
+  uint64_t getMaskBits(const int& row, const int& j) const;
+};
+
+#endif
@@ -0,0 +1,141 @@
+// This file containts signed distance field of static obstacles baked into voxel grid, rebaked in background thread
+
+#ifndef PREDICTIVE_CONTROL_SIGNED_DISTANCE_FIELD_H
+#define PREDICTIVE_CONTROL_SIGNED_DISTANCE_FIELD_H
+
+// Eigen includes
+#include <Eigen/Core>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// std includes
+#include <atomic>
+#include <vector>
+
+#include <predictive_control/collision_geometry.h>
+
+class SignedDistanceGrid
+{
+  /** Dense voxel grid of signed distance to nearest static obstacle, immutable once baked
+   * - Grid points every resolution over axis aligned box relative to chain root, x index fastest
+   * - Distance of grid point is minimum signed distance over obstacles within truncation distance,
+   *   truncation distance where no obstacle is that close
+   * - Query interpolates trilinear between eight grid points, gradient is analytic derivative of interpolation
+   */
+
+public:
+  /**
+   * @brief SignedDistanceGrid: Default constructor, empty grid
+   */
+  SignedDistanceGrid();
+
+  /**
+   * @brief bake: compute distance of every grid point
+   * @param objects: static obstacles relative to chain root
+   * @param lower: lower corner of grid relative to chain root
+   * @param size: edge length of grid along x, y and z
+   * @param resolution: distance between grid points
+   * @param truncation: largest stored distance, obstacles farther away ignored
+   * @param cancel: baking stopped and false returned once set, NULL to bake always till end
+   * @return true if all grid points baked
+   */
+  bool bake(const std::vector<CollisionPrimitive>& objects, const Eigen::Vector3d& lower, const Eigen::Vector3d& size,
+            const double& resolution, const double& truncation, const std::atomic<bool>* cancel = NULL);
+
+  /**
+   * @brief getDistance: trilinear interpolated signed distance of point to nearest obstacle
+   * @param point: point relative to chain root
+   * @param distance: resultant distance, truncation distance if no obstacle within
+   * @param gradient: resultant gradient of interpolated distance with respect to point
+   * @return false if point outside of grid, distance and gradient not set
+   */
+  bool getDistance(const Eigen::Vector3d& point, double& distance, Eigen::Vector3d& gradient) const;
+
+  // scene version grid was baked for
+  int version;
+
+private:
+  Eigen::Vector3d lower_;
+  Eigen::Vector3i points_;
+  double resolution_;
+  double inverse_resolution_;
+  std::vector<float> values_;
+
+  float getValue(const int& x, const int& y, const int& z) const
+  {
+    return values_[(z * points_(1) + y) * points_(0) + x];
+  }
+};
+
+class SignedDistanceField
+{
+  /** Background baking of signed distance grid whenever static scene changes
+   * - requestBake copies obstacles and wakes bake thread, newer request cancels bake in progress
+   * - Baked grid swapped in under mutex, readers keep shared pointer to grid for whole cost evaluation
+   * - Grid tagged with scene version of its request, caller compares version to detect stale grid
+   */
+
+public:
+  /**
+   * @brief SignedDistanceField: Default constructor, no bake thread until initialize
+   */
+  SignedDistanceField();
+
+  /**
+   * @brief ~SignedDistanceField: stop and join bake thread
+   */
+  ~SignedDistanceField();
+
+  /**
+   * @brief initialize: set grid geometry and start bake thread
+   * @param lower: lower corner of grid relative to chain root
+   * @param size: edge length of grid along x, y and z
+   * @param resolution: distance between grid points
+   * @param truncation: largest stored distance
+   */
+  void initialize(const Eigen::Vector3d& lower, const Eigen::Vector3d& size, const double& resolution,
+                  const double& truncation);
+
+  /**
+   * @brief requestBake: bake grid of obstacles in background thread
+   * @param objects: static obstacles relative to chain root, copied
+   * @param version: scene version stored with baked grid
+   */
+  void requestBake(const std::vector<CollisionPrimitive>& objects, const int& version);
+
+  /**
+   * @brief getGrid: latest baked grid, empty pointer if none baked yet
+   */
+  boost::shared_ptr<const SignedDistanceGrid> getGrid() const;
+
+private:
+  Eigen::Vector3d lower_;
+  Eigen::Vector3d size_;
+  double resolution_;
+  double truncation_;
+
+  // pending request, guarded by mutex_
+  std::vector<CollisionPrimitive> pending_objects_;
+  int pending_version_;
+  bool pending_;
+
+  // latest baked grid, guarded by mutex_
+  boost::shared_ptr<const SignedDistanceGrid> grid_;
+
+  mutable boost::mutex mutex_;
+  boost::condition_variable condition_;
+  boost::thread bake_thread_;
+
+  // set by newer request or shutdown, checked while baking
+  std::atomic<bool> cancel_;
+  bool running_;
+
+  /**
+   * @brief run: bake thread, wait for request and bake it
+   */
+  void run();
+};
+
+#endif
@@ -0,0 +1,101 @@
+
+// This file containts non blocking latest value cache of single transform
+
+#ifndef PREDICTIVE_CONTROL_TRANSFORM_CACHE_H
+#define PREDICTIVE_CONTROL_TRANSFORM_CACHE_H
+
+// ros includes
+#include <ros/ros.h>
+#include <tf/tf.h>
+#include <tf/transform_listener.h>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// std includes
+#include <string>
+
+// predictive includes
+#include <predictive_control/triple_buffer.h>
+
+// latest looked up transform, invalid until first successful lookup
+struct CachedTransform
+{
+  bool valid;
+  tf::StampedTransform transform;
+
+  CachedTransform() : valid(false)
+  {
+  }
+};
+
+class TransformCache
+{
+  /** Latest value cache of transform between source and target frame
+   * - Timer refresh cache with non blocking lookup, never wait for transform
+   * - Reader get latest available transform without touching tf (lock free handoff)
+   * - Control loop never blocks on tf, stale transform is used until new one is available
+   */
+
+public:
+  /**
+   * @brief TransformCache: Default constructor, allocate memory
+   */
+  TransformCache();
+
+  /**
+   * @brief ~TransformCache: Default distructor, free memory
+   */
+  ~TransformCache();
+
+  /**
+   * @brief initialize: start refresh timer of cache
+   * @param nh: node handle used to create timer
+   * @param tf_listener: listener used for lookup, should live longer than this cache
+   * @param from: source frame
+   * @param to: target frame
+   * @param update_frequency: refresh rate of cache (hz)
+   * @return true with successful initialize else false
+   */
+  bool initialize(ros::NodeHandle& nh, tf::TransformListener* tf_listener, const std::string& from,
+                  const std::string& to, const double& update_frequency);
+
+  /**
+   * @brief setTargetFrame: change target frame, cache invalid until first lookup of new frame, call from thread
+   * which spin timer callback
+   * @param to: target frame
+   */
+  void setTargetFrame(const std::string& to);
+
+  /**
+   * @brief getLatest: latest available transform, never blocks
+   * @param transform: Resultant transform from source to target frame
+   * @return true when transform available else false (transform unchanged)
+   */
+  bool getLatest(tf::StampedTransform& transform);
+
+  /**
+   * @brief getLatestPose: latest available transform as pose vector, never blocks
+   * @param pose: Resultant pose, 3 position and 3 orientation (rpy)
+   * @return true when transform available else false (pose unchanged)
+   */
+  bool getLatestPose(Eigen::VectorXd& pose);
+
+private:
+  tf::TransformListener* tf_listener_;
+  ros::Timer timer_;
+
+  std::string from_;
+  std::string to_;
+
+  // refresh timer -> control loop
+  TripleBuffer<CachedTransform> buffer_;
+
+  /**
+   * @brief updateCallBack: lookup latest transform when available, no waiting
+   * @param event: timer event
+   */
+  void updateCallBack(const ros::TimerEvent& event);
+};
+
+#endif
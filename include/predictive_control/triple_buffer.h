@@ -0,0 +1,91 @@
+
+// This file containts lock free single writer single reader buffer, used to hand over data between threads
+
+#ifndef PREDICTIVE_CONTROL_TRIPLE_BUFFER_H
+#define PREDICTIVE_CONTROL_TRIPLE_BUFFER_H
+
+// std includes
+#include <atomic>
+
+template <typename T>
+class TripleBuffer
+{
+  /** Lock free handoff of latest value from one writer thread to one reader thread
+   * - Writer fill its private buffer and publish it, never blocks and never waits for reader
+   * - Reader take newest published buffer, older values are overwritten (latest value semantic)
+   * - Three preallocated buffers, exchange only swap indices, no allocation after initialize
+   */
+
+public:
+  TripleBuffer() : middle_(1), write_index_(0), read_index_(2)
+  {
+  }
+
+  /**
+   * @brief initialize: preallocate all buffers with given value, call before threads are started
+   * @param value: prototype value, should have same size as values written later
+   */
+  void initialize(const T& value)
+  {
+    for (int i = 0u; i < 3; ++i)
+    {
+      buffers_[i] = value;
+    }
+    middle_.store(1, std::memory_order_release);
+    write_index_ = 0;
+    read_index_ = 2;
+  }
+
+  /**
+   * @brief getWriteBuffer: private buffer of writer thread
+   * @return buffer to fill before publish
+   */
+  T& getWriteBuffer()
+  {
+    return buffers_[write_index_];
+  }
+
+  /**
+   * @brief publish: make write buffer visible to reader, writer continue with free buffer
+   */
+  void publish()
+  {
+    write_index_ = middle_.exchange(write_index_ | FRESH, std::memory_order_acq_rel) & INDEX;
+  }
+
+  /**
+   * @brief update: take newest published buffer as read buffer
+   * @return true when new value was published since last update else false (read buffer unchanged)
+   */
+  bool update()
+  {
+    if (!(middle_.load(std::memory_order_acquire) & FRESH))
+    {
+      return false;
+    }
+
+    read_index_ = middle_.exchange(read_index_, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  /**
+   * @brief getReadBuffer: private buffer of reader thread, latest value taken by update
+   * @return read buffer
+   */
+  const T& getReadBuffer() const
+  {
+    return buffers_[read_index_];
+  }
+
+private:
+  // index of middle buffer and flag of unread value
+  static const int INDEX = 3;
+  static const int FRESH = 4;
+
+  T buffers_[3];
+  std::atomic<int> middle_;
+  int write_index_;
+  int read_index_;
+};
+
+#endif
@@ -0,0 +1,174 @@
+
+#include <predictive_control/async_logger.h>
+
+#include <ros/console.h>
+
+#include <cstdarg>
+#include <cstdio>
+
+#include <boost/bind.hpp>
+
+// background thread sleeps this long when ring buffer is empty
+static const int DRAIN_PERIOD_MS = 2;
+
+AsyncLogger& AsyncLogger::instance()
+{
+  static AsyncLogger logger;
+  return logger;
+}
+
+AsyncLogger::AsyncLogger() : write_index_(0), read_index_(0), dropped_(0), running_(true)
+{
+  for (int i = 0u; i < BUFFER_SIZE; ++i)
+  {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  drain_thread_ = boost::thread(boost::bind(&AsyncLogger::run, this));
+}
+
+AsyncLogger::~AsyncLogger()
+{
+  running_.store(false, std::memory_order_release);
+  drain_thread_.join();
+}
+
+bool AsyncLogger::log(const int level, const char* format, ...)
+{
+  Slot* slot = claim();
+  if (!slot)
+  {
+    return false;
+  }
+
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(slot->text, MESSAGE_SIZE, format, arguments);
+  va_end(arguments);
+
+  slot->level = level;
+  publish(slot);
+  return true;
+}
+
+bool AsyncLogger::logValues(const int level, const char* label, const double* values, const int size)
+{
+  Slot* slot = claim();
+  if (!slot)
+  {
+    return false;
+  }
+
+  // stop at first truncated value, snprintf returns length it would have written
+  int length = snprintf(slot->text, MESSAGE_SIZE, "%s", label);
+  for (int i = 0u; i < size && length < MESSAGE_SIZE; ++i)
+  {
+    length += snprintf(slot->text + length, MESSAGE_SIZE - length, " %g", values[i]);
+  }
+
+  slot->level = level;
+  publish(slot);
+  return true;
+}
+
+void AsyncLogger::flush()
+{
+  const uint64_t position = write_index_.load(std::memory_order_acquire);
+  while (read_index_.load(std::memory_order_acquire) < position)
+  {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(DRAIN_PERIOD_MS));
+  }
+}
+
+// slot at position is free if its sequence equals position, full ring buffer if sequence still lags one round
+AsyncLogger::Slot* AsyncLogger::claim()
+{
+  uint64_t position = write_index_.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    Slot& slot = slots_[position & (BUFFER_SIZE - 1)];
+    const int64_t difference =
+        static_cast<int64_t>(slot.sequence.load(std::memory_order_acquire)) - static_cast<int64_t>(position);
+
+    if (difference == 0)
+    {
+      if (write_index_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+      {
+        return &slot;
+      }
+    }
+    else if (difference < 0)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return NULL;
+    }
+    else
+    {
+      position = write_index_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void AsyncLogger::publish(Slot* slot)
+{
+  slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// slot ready if its sequence equals position + 1, hand it back to producers one round later
+int AsyncLogger::drain()
+{
+  int count = 0u;
+  uint64_t position = read_index_.load(std::memory_order_relaxed);
+  for (;; ++position, ++count)
+  {
+    Slot& slot = slots_[position & (BUFFER_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+    {
+      break;
+    }
+
+    switch (slot.level)
+    {
+      case PD_LOG_LEVEL_DEBUG:
+        ROS_DEBUG("%s", slot.text);
+        break;
+      case PD_LOG_LEVEL_INFO:
+        ROS_INFO("%s", slot.text);
+        break;
+      case PD_LOG_LEVEL_WARN:
+        ROS_WARN("%s", slot.text);
+        break;
+      default:
+        ROS_ERROR("%s", slot.text);
+        break;
+    }
+
+    slot.sequence.store(position + BUFFER_SIZE, std::memory_order_release);
+    read_index_.store(position + 1, std::memory_order_release);
+  }
+
+  return count;
+}
+
+void AsyncLogger::run()
+{
+  uint64_t reported_dropped = 0u;
+  while (running_.load(std::memory_order_acquire))
+  {
+    if (drain() == 0)
+    {
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(DRAIN_PERIOD_MS));
+    }
+
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped)
+    {
+      ROS_WARN("AsyncLogger: %lu messages dropped, ring buffer full",
+               static_cast<unsigned long>(dropped - reported_dropped));
+      reported_dropped = dropped;
+    }
+  }
+
+  // messages queued before shutdown
+  drain();
+}
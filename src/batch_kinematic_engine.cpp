@@ -0,0 +1,424 @@
+// This file containts batched forward kinematic and Jacobian of many joint configurations in structure of arrays layout
+
+#include <predictive_control/batch_kinematic_engine.h>
+
+#include <cmath>
+
+#if defined(PREDICTIVE_CONTROL_AVX2) && defined(__AVX2__)
+#include <immintrin.h>
+#define PREDICTIVE_CONTROL_BATCH_AVX2
+#endif
+
+// one configuration per lane, fallback and remaining configurations of batch
+struct ScalarLane
+{
+  typedef double Type;
+  static const int WIDTH = 1;
+
+  static Type load(const double* data)
+  {
+    return *data;
+  }
+  static void store(double* data, const Type& value)
+  {
+    *data = value;
+  }
+  static Type broadcast(const double& value)
+  {
+    return value;
+  }
+  static Type add(const Type& a, const Type& b)
+  {
+    return a + b;
+  }
+  static Type sub(const Type& a, const Type& b)
+  {
+    return a - b;
+  }
+  static Type mul(const Type& a, const Type& b)
+  {
+    return a * b;
+  }
+  // a * b + c
+  static Type fmadd(const Type& a, const Type& b, const Type& c)
+  {
+    return a * b + c;
+  }
+  static void sincos(const Type& x, Type& sine, Type& cosine)
+  {
+    sine = std::sin(x);
+    cosine = std::cos(x);
+  }
+};
+
+#ifdef PREDICTIVE_CONTROL_BATCH_AVX2
+// four configurations per lane
+struct Avx2Lane
+{
+  typedef __m256d Type;
+  static const int WIDTH = 4;
+
+  static Type load(const double* data)
+  {
+    return _mm256_loadu_pd(data);
+  }
+  static void store(double* data, const Type& value)
+  {
+    _mm256_storeu_pd(data, value);
+  }
+  static Type broadcast(const double& value)
+  {
+    return _mm256_set1_pd(value);
+  }
+  static Type add(const Type& a, const Type& b)
+  {
+    return _mm256_add_pd(a, b);
+  }
+  static Type sub(const Type& a, const Type& b)
+  {
+    return _mm256_sub_pd(a, b);
+  }
+  static Type mul(const Type& a, const Type& b)
+  {
+    return _mm256_mul_pd(a, b);
+  }
+  static Type fmadd(const Type& a, const Type& b, const Type& c)
+  {
+#ifdef __FMA__
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+  }
+
+  // sine and cosine of four values, octant reduction and minimax polynomials of Cephes library (sin.c), accurate to
+  // about 1e-16 for joint angles (|x| < 1e5)
+  static void sincos(const Type& x, Type& sine, Type& cosine)
+  {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d x_sign = _mm256_and_pd(x, sign_mask);
+    const __m256d x_abs = _mm256_andnot_pd(sign_mask, x);
+
+    // octant j, rounded up to even, z = x - j * pi / 4 by extended precision reduction
+    __m128i j = _mm256_cvttpd_epi32(_mm256_mul_pd(x_abs, _mm256_set1_pd(1.27323954473516268615)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    const __m256d y = _mm256_cvtepi32_pd(j);
+    __m256d z = fmadd(y, _mm256_set1_pd(-7.85398125648498535156E-1), x_abs);
+    z = fmadd(y, _mm256_set1_pd(-3.77489470793079817668E-8), z);
+    z = fmadd(y, _mm256_set1_pd(-2.69515142907905952645E-15), z);
+    const __m256d zz = _mm256_mul_pd(z, z);
+
+    // sin(z) = z + z^3 P(z^2)
+    __m256d poly_sin = _mm256_set1_pd(1.58962301576546568060E-10);
+    poly_sin = fmadd(poly_sin, zz, _mm256_set1_pd(-2.50507477628578072866E-8));
+    poly_sin = fmadd(poly_sin, zz, _mm256_set1_pd(2.75573136213857245213E-6));
+    poly_sin = fmadd(poly_sin, zz, _mm256_set1_pd(-1.98412698295895385996E-4));
+    poly_sin = fmadd(poly_sin, zz, _mm256_set1_pd(8.33333333332211858878E-3));
+    poly_sin = fmadd(poly_sin, zz, _mm256_set1_pd(-1.66666666666666307295E-1));
+    poly_sin = fmadd(_mm256_mul_pd(poly_sin, zz), z, z);
+
+    // cos(z) = 1 - z^2 / 2 + z^4 Q(z^2)
+    __m256d poly_cos = _mm256_set1_pd(-1.13585365213876817300E-11);
+    poly_cos = fmadd(poly_cos, zz, _mm256_set1_pd(2.08757008419747316778E-9));
+    poly_cos = fmadd(poly_cos, zz, _mm256_set1_pd(-2.75573141792967388112E-7));
+    poly_cos = fmadd(poly_cos, zz, _mm256_set1_pd(2.48015872888517045348E-5));
+    poly_cos = fmadd(poly_cos, zz, _mm256_set1_pd(-1.38888888888730564116E-3));
+    poly_cos = fmadd(poly_cos, zz, _mm256_set1_pd(4.16666666666665929218E-2));
+    poly_cos = fmadd(_mm256_mul_pd(poly_cos, zz), zz, fmadd(zz, _mm256_set1_pd(-0.5), _mm256_set1_pd(1.0)));
+
+    // octant 2 and 6 swap polynomials, sine negative in octant 4 and 6, cosine negative in octant 2 and 4
+    const __m256i octant = _mm256_cvtepi32_epi64(j);
+    const __m256i two = _mm256_set1_epi64x(2), four = _mm256_set1_epi64x(4);
+    const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(octant, two), two));
+    const __m256d sine_negative = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(octant, four), four));
+    const __m256d cosine_negative =
+        _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_add_epi64(octant, two), four), four));
+    const __m256d sine_sign = _mm256_and_pd(sign_mask, sine_negative);
+    const __m256d cosine_sign = _mm256_and_pd(sign_mask, cosine_negative);
+
+    sine = _mm256_xor_pd(_mm256_xor_pd(_mm256_blendv_pd(poly_sin, poly_cos, swap), sine_sign), x_sign);
+    cosine = _mm256_xor_pd(_mm256_blendv_pd(poly_cos, poly_sin, swap), cosine_sign);
+  }
+};
+#endif
+
+BatchKinematicEngine::BatchKinematicEngine() : degree_of_freedom_(0)
+{
+}
+
+bool BatchKinematicEngine::isVectorized()
+{
+#ifdef PREDICTIVE_CONTROL_BATCH_AVX2
+  return true;
+#else
+  return false;
+#endif
+}
+
+// copy chain into flat arrays, constants are broadcast into lanes by kernel
+bool BatchKinematicEngine::initialize(const KinematicEngine& engine)
+{
+  degree_of_freedom_ = engine.getDegreeOfFreedom();
+  frames_to_tip_.clear();
+  joint_types_.clear();
+  axis_index_.clear();
+  axis_sign_.clear();
+  axes_.clear();
+  joint_index_.clear();
+  segment_poses_.resize(0, 0);
+  jacobians_.resize(0, 0);
+
+  for (int i = 0u, joint = 0u; i < engine.getNumberOfSegments(); ++i)
+  {
+    const Eigen::Isometry3d& frame = engine.getFrameToTip(i);
+    for (int c = 0u; c < 3; ++c)
+    {
+      for (int r = 0u; r < 3; ++r)
+      {
+        frames_to_tip_.push_back(frame.linear()(r, c));
+      }
+    }
+    for (int r = 0u; r < 3; ++r)
+    {
+      frames_to_tip_.push_back(frame.translation()(r));
+    }
+
+    const Eigen::Vector3d& axis = engine.getJointAxis(i);
+    int index = 0;
+    axis.cwiseAbs().maxCoeff(&index);
+
+    joint_types_.push_back(engine.getJointType(i));
+    axis_index_.push_back(index);
+    axis_sign_.push_back(axis(index) < 0.0 ? -1.0 : 1.0);
+    axes_.push_back(axis(0));
+    axes_.push_back(axis(1));
+    axes_.push_back(axis(2));
+    joint_index_.push_back(engine.getJointType(i) == KINEMATIC_JOINT_FIXED ? -1 : joint++);
+  }
+
+  return !joint_types_.empty();
+}
+
+// storage of batch, reallocated only when batch size changes
+void BatchKinematicEngine::resize(const int& batch_size)
+{
+  if (segment_poses_.rows() != batch_size)
+  {
+    segment_poses_.resize(batch_size, 12 * joint_types_.size());
+    jacobians_.resize(batch_size, 6 * degree_of_freedom_);
+  }
+}
+
+// same composition as KinematicEngine, T(i) = T(i-1) * F(i) * R(axis, q), evaluated for Lane::WIDTH configurations
+template <typename Lane>
+void BatchKinematicEngine::calculateBlock(const Eigen::MatrixXd& joints_angle, const int& configuration,
+                                          const bool& jacobian)
+{
+  typedef typename Lane::Type T;
+  const int batch_size = segment_poses_.rows();
+  const int segments = joint_types_.size();
+
+  // rotation column major R[r + 3 * c], translation p[r]
+  T R[9], p[3];
+  for (int k = 0u; k < 9; ++k)
+  {
+    R[k] = Lane::broadcast((k % 4 == 0) ? 1.0 : 0.0);
+  }
+  p[0] = p[1] = p[2] = Lane::broadcast(0.0);
+
+  for (int i = 0u; i < segments; ++i)
+  {
+    const double* F = &frames_to_tip_[12 * i];
+
+    // p = R * F.p + p, R = R * F.R
+    T next_R[9], next_p[3];
+    for (int r = 0u; r < 3; ++r)
+    {
+      next_p[r] = Lane::fmadd(R[r], Lane::broadcast(F[9]),
+                              Lane::fmadd(R[r + 3], Lane::broadcast(F[10]),
+                                          Lane::fmadd(R[r + 6], Lane::broadcast(F[11]), p[r])));
+      for (int c = 0u; c < 3; ++c)
+      {
+        next_R[r + 3 * c] =
+            Lane::fmadd(R[r], Lane::broadcast(F[3 * c]),
+                        Lane::fmadd(R[r + 3], Lane::broadcast(F[3 * c + 1]),
+                                    Lane::mul(R[r + 6], Lane::broadcast(F[3 * c + 2]))));
+      }
+    }
+
+    const int joint = joint_index_[i];
+    if (joint_types_[i] == KINEMATIC_JOINT_ROT_AXIS)
+    {
+      // rotation about axis k only mix other two columns of rotation matrix, sign of axis folded into angle
+      const T angle = Lane::load(joints_angle.col(joint).data() + configuration);
+      T s, c;
+      Lane::sincos(Lane::mul(Lane::broadcast(axis_sign_[i]), angle), s, c);
+      const int a = (axis_index_[i] + 1) % 3, b = (axis_index_[i] + 2) % 3;
+      for (int r = 0u; r < 3; ++r)
+      {
+        const T column_a = next_R[r + 3 * a];
+        const T column_b = next_R[r + 3 * b];
+        next_R[r + 3 * a] = Lane::fmadd(c, column_a, Lane::mul(s, column_b));
+        next_R[r + 3 * b] = Lane::sub(Lane::mul(c, column_b), Lane::mul(s, column_a));
+      }
+    }
+
+    else if (joint_types_[i] == KINEMATIC_JOINT_ROT_ANY)
+    {
+      // Rodrigues rotation matrix, M = c I + s [k]x + (1 - c) k k^T
+      T s, c;
+      Lane::sincos(Lane::load(joints_angle.col(joint).data() + configuration), s, c);
+      const T t = Lane::sub(Lane::broadcast(1.0), c);
+      const double* k = &axes_[3 * i];
+
+      T M[9];
+      for (int r = 0u; r < 3; ++r)
+      {
+        for (int col = 0u; col < 3; ++col)
+        {
+          M[r + 3 * col] = Lane::mul(t, Lane::broadcast(k[r] * k[col]));
+        }
+        M[r + 3 * r] = Lane::add(M[r + 3 * r], c);
+      }
+      M[2 + 3 * 1] = Lane::fmadd(s, Lane::broadcast(k[0]), M[2 + 3 * 1]);
+      M[1 + 3 * 2] = Lane::fmadd(s, Lane::broadcast(-k[0]), M[1 + 3 * 2]);
+      M[0 + 3 * 2] = Lane::fmadd(s, Lane::broadcast(k[1]), M[0 + 3 * 2]);
+      M[2 + 3 * 0] = Lane::fmadd(s, Lane::broadcast(-k[1]), M[2 + 3 * 0]);
+      M[1 + 3 * 0] = Lane::fmadd(s, Lane::broadcast(k[2]), M[1 + 3 * 0]);
+      M[0 + 3 * 1] = Lane::fmadd(s, Lane::broadcast(-k[2]), M[0 + 3 * 1]);
+
+      T rotated[9];
+      for (int r = 0u; r < 3; ++r)
+      {
+        for (int col = 0u; col < 3; ++col)
+        {
+          rotated[r + 3 * col] = Lane::fmadd(next_R[r], M[3 * col],
+                                             Lane::fmadd(next_R[r + 3], M[3 * col + 1],
+                                                         Lane::mul(next_R[r + 6], M[3 * col + 2])));
+        }
+      }
+      for (int k = 0u; k < 9; ++k)
+      {
+        next_R[k] = rotated[k];
+      }
+    }
+
+    double* pose = segment_poses_.data() + 12 * i * batch_size + configuration;
+    for (int k = 0u; k < 9; ++k)
+    {
+      R[k] = next_R[k];
+      Lane::store(pose + k * batch_size, R[k]);
+    }
+    for (int r = 0u; r < 3; ++r)
+    {
+      p[r] = next_p[r];
+      Lane::store(pose + (9 + r) * batch_size, p[r]);
+    }
+  }
+
+  if (!jacobian)
+  {
+    return;
+  }
+
+  // geometric Jacobian, column of revolute joint [z x (p - p_i); z], p is end effector position
+  for (int i = 0u; i < segments; ++i)
+  {
+    const int joint = joint_index_[i];
+    if (joint < 0)
+    {
+      continue;
+    }
+
+    const double* pose = segment_poses_.data() + 12 * i * batch_size + configuration;
+    T z[3], d[3];
+    for (int r = 0u; r < 3; ++r)
+    {
+      if (joint_types_[i] == KINEMATIC_JOINT_ROT_AXIS)
+      {
+        z[r] = Lane::mul(Lane::broadcast(axis_sign_[i]), Lane::load(pose + (r + 3 * axis_index_[i]) * batch_size));
+      }
+      else
+      {
+        const double* k = &axes_[3 * i];
+        z[r] = Lane::fmadd(Lane::load(pose + r * batch_size), Lane::broadcast(k[0]),
+                           Lane::fmadd(Lane::load(pose + (r + 3) * batch_size), Lane::broadcast(k[1]),
+                                       Lane::mul(Lane::load(pose + (r + 6) * batch_size), Lane::broadcast(k[2]))));
+      }
+      d[r] = Lane::sub(p[r], Lane::load(pose + (9 + r) * batch_size));
+    }
+
+    double* column = jacobians_.data() + 6 * joint * batch_size + configuration;
+    Lane::store(column, Lane::sub(Lane::mul(z[1], d[2]), Lane::mul(z[2], d[1])));
+    Lane::store(column + batch_size, Lane::sub(Lane::mul(z[2], d[0]), Lane::mul(z[0], d[2])));
+    Lane::store(column + 2 * batch_size, Lane::sub(Lane::mul(z[0], d[1]), Lane::mul(z[1], d[0])));
+    for (int r = 0u; r < 3; ++r)
+    {
+      Lane::store(column + (3 + r) * batch_size, z[r]);
+    }
+  }
+}
+
+// vector lanes over full blocks, scalar lane for remaining configurations
+void BatchKinematicEngine::calculate(const Eigen::MatrixXd& joints_angle, const bool& jacobian)
+{
+  resize(joints_angle.rows());
+
+  const int batch_size = joints_angle.rows();
+  int configuration = 0;
+
+#ifdef PREDICTIVE_CONTROL_BATCH_AVX2
+  for (; configuration + Avx2Lane::WIDTH <= batch_size; configuration += Avx2Lane::WIDTH)
+  {
+    calculateBlock<Avx2Lane>(joints_angle, configuration, jacobian);
+  }
+#endif
+
+  for (; configuration < batch_size; ++configuration)
+  {
+    calculateBlock<ScalarLane>(joints_angle, configuration, jacobian);
+  }
+}
+
+void BatchKinematicEngine::calculateForwardKinematics(const Eigen::MatrixXd& joints_angle)
+{
+  calculate(joints_angle, false);
+}
+
+void BatchKinematicEngine::calculateJacobian(const Eigen::MatrixXd& joints_angle)
+{
+  calculate(joints_angle, true);
+}
+
+// gather pose of one configuration from structure of arrays
+Eigen::Isometry3d BatchKinematicEngine::getSegmentPose(const int& configuration, const int& segment) const
+{
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  for (int k = 0u; k < 9; ++k)
+  {
+    pose.linear()(k % 3, k / 3) = segment_poses_(configuration, 12 * segment + k);
+  }
+  for (int r = 0u; r < 3; ++r)
+  {
+    pose.translation()(r) = segment_poses_(configuration, 12 * segment + 9 + r);
+  }
+  return pose;
+}
+
+Eigen::Isometry3d BatchKinematicEngine::getEndEffectorPose(const int& configuration) const
+{
+  return getSegmentPose(configuration, joint_types_.size() - 1);
+}
+
+// gather Jacobian of one configuration from structure of arrays
+void BatchKinematicEngine::getJacobian(const int& configuration, Eigen::MatrixXd& jacobian) const
+{
+  jacobian.resize(6, degree_of_freedom_);
+  for (int j = 0u; j < degree_of_freedom_; ++j)
+  {
+    for (int r = 0u; r < 6; ++r)
+    {
+      jacobian(r, j) = jacobians_(configuration, 6 * j + r);
+    }
+  }
+}
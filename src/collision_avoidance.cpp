@@ -87,11 +87,7 @@ void CollisionAvoidance::obstaclesDistanceCallBack(const cob_control_msgs::Obsta
              relevant_obstacle_distances_.begin();
          it != relevant_obstacle_distances_.end(); ++it)
     {
-      ROS_WARN_STREAM("link of interest: " << it->second.link_of_interest);
-      ROS_WARN_STREAM("Obstacle_id: " << it->second.obstacle_id);
-      ROS_INFO_STREAM("Frame Vector: " << it->second.frame_vector);
-      ROS_INFO_STREAM("Nearest_point_frame_vector: " << it->second.nearest_point_obstacle_vector);
-      ROS_INFO_STREAM("Nearest_point_obstacle_vector: " << it->second.nearest_point_obstacle_vector);
+      logObstacleDistance(it->second);
     }
   }
 
@@ -100,6 +96,18 @@ void CollisionAvoidance::obstaclesDistanceCallBack(const cob_control_msgs::Obsta
   this->visualizeObstacleDistance(relevant_obstacle_distances_);
 }
 
+void CollisionAvoidance::logObstacleDistance(const cob_control_msgs::ObstacleDistance& obstacle_distance)
+{
+  PD_LOG_DEBUG("CollisionAvoidance: %s <---> %s distance: %f", obstacle_distance.link_of_interest.c_str(),
+               obstacle_distance.obstacle_id.c_str(), obstacle_distance.distance);
+  PD_LOG_DEBUG("CollisionAvoidance: frame vector: %f %f %f, nearest point frame vector: %f %f %f, "
+               "nearest point obstacle vector: %f %f %f",
+               obstacle_distance.frame_vector.x, obstacle_distance.frame_vector.y, obstacle_distance.frame_vector.z,
+               obstacle_distance.nearest_point_frame_vector.x, obstacle_distance.nearest_point_frame_vector.y,
+               obstacle_distance.nearest_point_frame_vector.z, obstacle_distance.nearest_point_obstacle_vector.x,
+               obstacle_distance.nearest_point_obstacle_vector.y, obstacle_distance.nearest_point_obstacle_vector.z);
+}
+
 double CollisionAvoidance::getDistanceCostFunction()
 {
   double cost_distance(0.0);
@@ -110,12 +118,7 @@ double CollisionAvoidance::getDistanceCostFunction()
              relevant_obstacle_distances_.begin();
          it != relevant_obstacle_distances_.end(); ++it)
     {
-      ROS_ERROR_STREAM(it->second.link_of_interest);
-      ROS_ERROR_STREAM(it->second.obstacle_id);
-      ROS_WARN_STREAM(it->second.distance);
-      ROS_INFO_STREAM("Frame Vector: " << it->second.frame_vector);
-      ROS_INFO_STREAM("Nearest_point_frame_vector: " << it->second.nearest_point_obstacle_vector);
-      ROS_INFO_STREAM("Nearest_point_obstacle_vector: " << it->second.nearest_point_obstacle_vector);
+      logObstacleDistance(it->second);
 
       cost_distance += exp(((pd_config_->minimum_collision_distance_ * pd_config_->minimum_collision_distance_) -
                             (it->second.distance * it->second.distance)) /
@@ -132,11 +135,10 @@ double CollisionAvoidance::getDistanceCostFunction()
            it_map != relevant_obstacle_distances_.end(); ++it_map)
       {
         // both string are equal than execute if loop
-        ROS_WARN_STREAM(it_map->second.obstacle_id);
         if (it->find(it_map->second.obstacle_id) != std::string::npos ||
             it->find(it_map->second.link_of_interest) != std::string::npos)
         {
-          ROS_INFO("Ignoring %s obstacle from list", it->c_str());
+          PD_LOG_DEBUG("CollisionAvoidance: Ignoring %s obstacle from list", it->c_str());
         }
         else
         {
@@ -148,7 +150,7 @@ double CollisionAvoidance::getDistanceCostFunction()
     }
   }
 
-  ROS_WARN_STREAM("COLLISION COST: " << cost_distance);
+  PD_LOG_DEBUG("CollisionAvoidance: collision cost: %f", cost_distance);
 
   return cost_distance;
 }
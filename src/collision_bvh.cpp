@@ -0,0 +1,214 @@
+// This file containts bounding volume hierarchy (axis aligned bounding box tree) over static obstacles
+
+#include <predictive_control/collision_bvh.h>
+
+#include <algorithm>
+
+// traversal stack of query, height of median split tree is log2 of objects and never grows by removal
+static const int MAX_QUERY_DEPTH = 64;
+
+CollisionBoundingVolumeHierarchy::CollisionBoundingVolumeHierarchy() : root_(-1)
+{
+}
+
+void CollisionBoundingVolumeHierarchy::clear()
+{
+  nodes_.clear();
+  object_leaf_.clear();
+  root_ = -1;
+}
+
+void CollisionBoundingVolumeHierarchy::build(const std::vector<CollisionPrimitive>& objects)
+{
+  clear();
+
+  const int size = objects.size();
+  if (size == 0)
+  {
+    return;
+  }
+
+  std::vector<Eigen::Vector3d> lower(size), upper(size);
+  std::vector<int> order(size);
+  for (int i = 0u; i < size; ++i)
+  {
+    computeBoundingBox(objects[i], lower[i], upper[i]);
+    order[i] = i;
+  }
+
+  // full binary tree, 2 * size - 1 nodes
+  nodes_.reserve(2 * size - 1);
+  object_leaf_.resize(size);
+  root_ = buildNode(order, lower, upper, 0, size, -1);
+}
+
+int CollisionBoundingVolumeHierarchy::buildNode(std::vector<int>& order, const std::vector<Eigen::Vector3d>& lower,
+                                                const std::vector<Eigen::Vector3d>& upper, const int& begin,
+                                                const int& end, const int& parent)
+{
+  Node empty;
+  empty.min.setZero();
+  empty.max.setZero();
+  empty.parent = parent;
+  empty.left = -1;
+  empty.right = -1;
+  empty.object = -1;
+
+  const int node = nodes_.size();
+  nodes_.push_back(empty);
+
+  if (end - begin == 1)
+  {
+    const int object = order[begin];
+    nodes_[node].min = lower[object];
+    nodes_[node].max = upper[object];
+    nodes_[node].object = object;
+    object_leaf_[object] = node;
+    return node;
+  }
+
+  // split at median of box centers along longest axis of center bounds
+  Eigen::Vector3d center_min = lower[order[begin]] + upper[order[begin]];
+  Eigen::Vector3d center_max = center_min;
+  for (int i = begin + 1; i < end; ++i)
+  {
+    const Eigen::Vector3d center = lower[order[i]] + upper[order[i]];
+    center_min = center_min.cwiseMin(center);
+    center_max = center_max.cwiseMax(center);
+  }
+
+  int axis = 0u;
+  (center_max - center_min).maxCoeff(&axis);
+
+  const int middle = begin + (end - begin) / 2;
+  std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                   [&lower, &upper, axis](const int& a, const int& b) {
+                     return lower[a](axis) + upper[a](axis) < lower[b](axis) + upper[b](axis);
+                   });
+
+  // nodes_ may grow while building children, no reference kept across recursion
+  const int left = buildNode(order, lower, upper, begin, middle, node);
+  const int right = buildNode(order, lower, upper, middle, end, node);
+  nodes_[node].left = left;
+  nodes_[node].right = right;
+  nodes_[node].min = nodes_[left].min.cwiseMin(nodes_[right].min);
+  nodes_[node].max = nodes_[left].max.cwiseMax(nodes_[right].max);
+
+  return node;
+}
+
+void CollisionBoundingVolumeHierarchy::removeObject(const int& object)
+{
+  const int size = object_leaf_.size();
+  if (object < 0 || object >= size)
+  {
+    return;
+  }
+
+  const int leaf = object_leaf_[object];
+  const int parent = nodes_[leaf].parent;
+
+  if (parent < 0)
+  {
+    root_ = -1;
+  }
+  else
+  {
+    // sibling takes place of parent, leaf and parent stay unused until next build
+    const int sibling = (nodes_[parent].left == leaf) ? nodes_[parent].right : nodes_[parent].left;
+    const int grandparent = nodes_[parent].parent;
+
+    nodes_[sibling].parent = grandparent;
+    if (grandparent < 0)
+    {
+      root_ = sibling;
+    }
+    else
+    {
+      if (nodes_[grandparent].left == parent)
+      {
+        nodes_[grandparent].left = sibling;
+      }
+      else
+      {
+        nodes_[grandparent].right = sibling;
+      }
+
+      // shrink boxes of ancestors
+      for (int node = grandparent; node >= 0; node = nodes_[node].parent)
+      {
+        const Node& left = nodes_[nodes_[node].left];
+        const Node& right = nodes_[nodes_[node].right];
+        nodes_[node].min = left.min.cwiseMin(right.min);
+        nodes_[node].max = left.max.cwiseMax(right.max);
+      }
+    }
+  }
+
+  // last object takes removed index
+  const int last = size - 1;
+  if (object != last)
+  {
+    object_leaf_[object] = object_leaf_[last];
+    nodes_[object_leaf_[object]].object = object;
+  }
+  object_leaf_.pop_back();
+
+  if (object_leaf_.empty())
+  {
+    clear();
+  }
+}
+
+void CollisionBoundingVolumeHierarchy::querySphere(const Eigen::Vector3d& center, const double& radius,
+                                                   std::vector<int>& objects) const
+{
+  objects.clear();
+  if (root_ < 0)
+  {
+    return;
+  }
+
+  const double radius_squared = radius * radius;
+
+  int stack[MAX_QUERY_DEPTH];
+  int top = 0u;
+  stack[top++] = root_;
+
+  while (top > 0)
+  {
+    const Node& node = nodes_[stack[--top]];
+
+    // squared distance of center to box, zero inside
+    const Eigen::Vector3d excess = (node.min - center).cwiseMax(center - node.max).cwiseMax(0.0);
+    if (excess.squaredNorm() > radius_squared)
+    {
+      continue;
+    }
+
+    if (node.object >= 0)
+    {
+      objects.push_back(node.object);
+    }
+    else
+    {
+      stack[top++] = node.left;
+      stack[top++] = node.right;
+    }
+  }
+}
+
+int CollisionBoundingVolumeHierarchy::getHeight() const
+{
+  return getSubtreeHeight(root_);
+}
+
+int CollisionBoundingVolumeHierarchy::getSubtreeHeight(const int& node) const
+{
+  if (node < 0)
+  {
+    return 0;
+  }
+
+  return 1 + std::max(getSubtreeHeight(nodes_[node].left), getSubtreeHeight(nodes_[node].right));
+}
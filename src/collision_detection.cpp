@@ -1,6 +1,8 @@
 
 #include <predictive_control/collision_detection.h>
 
+#include <eigen_conversions/eigen_msg.h>
+
 CollisionRobot::CollisionRobot()
 {
   ;
@@ -15,7 +17,7 @@ CollisionRobot::~CollisionRobot()
 void CollisionRobot::clearDataMember()
 {
   marker_array_.markers.clear();
-  collision_matrix_.clear();
+  collision_model_.clear();
 }
 
 // initialize and create publisher for publishing collsion ball marker
@@ -41,123 +43,114 @@ bool CollisionRobot::initializeCollisionRobot()
 
 // update collsion ball position, publish new position of collision ball
 void CollisionRobot::updateCollisionVolume(const std::vector<Eigen::MatrixXd>& FK_Homogenous_Matrix,
-                                           const std::vector<Eigen::MatrixXd>& Transformation_Matrix)
+                                           const std::vector<Eigen::MatrixXd>& Transformation_Matrix,
+                                           const int& first_changed_segment)
 {
-  // make sure collsion matrix and marker array should be empty
-  clearDataMember();
+  // first update build layout of all balls, segment lengths of chain do not change afterwards
+  int first_changed = first_changed_segment;
+  if (collision_model_.empty())
+  {
+    generateCollisionVolume(FK_Homogenous_Matrix, Transformation_Matrix);
+    first_changed = 0;
+  }
+
+  // nothing moved since last update, keep ball centers and cost
+  if (first_changed >= FK_Homogenous_Matrix.size())
+  {
+    return;
+  }
 
   // DEBUG
   if (predictive_configuration::activate_output_)
   {
-    ROS_WARN("########### Print FK HOMOGENOUS MATRIX ############");
     for (auto it = FK_Homogenous_Matrix.begin(); it != FK_Homogenous_Matrix.end(); ++it)
     {
-      std::cout << "\n" << *it << std::endl;
+      PD_LOG_DEBUG_VALUES("CollisionRobot: FK homogenous matrix (column major):", it->data(), it->size());
     }
-    ROS_WARN("########## Print Transformation MATRIX ############");
     for (auto it = Transformation_Matrix.begin(); it != Transformation_Matrix.end(); ++it)
     {
-      std::cout << "\n" << *it << std::endl;
+      PD_LOG_DEBUG_VALUES("CollisionRobot: transformation matrix (column major):", it->data(), it->size());
     }
   }
 
-  // generate/update collision matrix
-  generateCollisionVolume(FK_Homogenous_Matrix, Transformation_Matrix);
+  // update centers of balls attached to changed segments, balls in front of dirty range are kept
+  collision_model_.updateCenters(FK_Homogenous_Matrix, first_changed);
 
   // DEBUG
   if (predictive_configuration::activate_output_)
   {
-    ROS_WARN("===== COLLISION MATRIX =====");
-    for (auto const& it : collision_matrix_)
+    for (int i = 0u; i < collision_model_.getNumberOfSpheres(); ++i)
     {
-      ROS_INFO_STREAM("CollisionRobot: " << it.first << " -> stamped: \n" << it.second);
+      PD_LOG_DEBUG("CollisionRobot: %s -> position: %f %f %f", collision_model_.getName(i).c_str(),
+                   collision_model_.getCenterX()(i), collision_model_.getCenterY()(i),
+                   collision_model_.getCenterZ()(i));
     }
   }
 
-  // visualize marker array
-  int id = 0u;
-  for (auto it = collision_matrix_.begin(); it != collision_matrix_.end(); ++it, ++id)
+  // visualize marker array, one marker per ball created with layout, only position changes
+  for (int i = 0u; i < collision_model_.getNumberOfSpheres(); ++i)
   {
-    visualizeCollisionVolume(it->second, predictive_configuration::ball_radius_, id);
+    marker_array_.markers[i].pose.position.x = collision_model_.getCenterX()(i);
+    marker_array_.markers[i].pose.position.y = collision_model_.getCenterY()(i);
+    marker_array_.markers[i].pose.position.z = collision_model_.getCenterZ()(i);
   }
 
   // publish
   marker_pub_.publish(marker_array_);
 
   // compute collision cost vectors
-  computeCollisionCost(collision_matrix_, predictive_configuration::minimum_collision_distance_,
+  computeCollisionCost(collision_model_, predictive_configuration::minimum_collision_distance_,
                        predictive_configuration::collision_weight_factor_);
 
-  // DEBUG
-  if (true)  // predictive_configuration::activate_output_
-  {
-    ROS_WARN("===== COLLISION COST VECTOR =====");
-    std::cout << collision_cost_vector_.transpose() << std::endl;
-  }
+  PD_LOG_DEBUG_VALUES("CollisionRobot: collision cost vector:", collision_cost_vector_.data(),
+                      collision_cost_vector_.size());
 }
 
-// create collision detection, specifically center position of collision matrix
+// create layout of collision balls, ball at every segment longer than ball and intermediate ball on long segments
 void CollisionRobot::generateCollisionVolume(const std::vector<Eigen::MatrixXd>& FK_Homogenous_Matrix,
                                              const std::vector<Eigen::MatrixXd>& Transformation_Matrix)
 {
-  int point = 0u, counter = 0u;
+  clearDataMember();
+
+  int point = 0u;
   std::string key = "point_";
 
-  // for (auto const& it: FK_Homogenous_Matrix)
-  for (auto it = FK_Homogenous_Matrix.begin(); it != FK_Homogenous_Matrix.end(); ++it)
+  for (int counter = 1u; counter < Transformation_Matrix.size(); ++counter)
   {
-    if (Transformation_Matrix[counter](2, 3) > 0.15 && counter != 0)
+    if (Transformation_Matrix[counter](2, 3) <= 0.15)
     {
-      // distance between two frame are more than ball randius than add intermidate ball
-      if (Transformation_Matrix[counter](2, 3) > 0.20)  // predictive_configuration::ball_radius_
-      {
-        ROS_INFO("CollisionRobot: Add intermidiate volume with point: %s", (key + std::to_string(point)).c_str());
-
-        geometry_msgs::PoseStamped stamped;
-        KDL::Frame frame, previous_frame;
-
-        // transform Eigen Matrix to Kdl Frame
-        transformEigenMatrixToKDL(*(it - 1), previous_frame);
-        transformEigenMatrixToKDL(*it, frame);
-
-        // fill up pose stamped
-        stamped.header.frame_id = predictive_configuration::chain_root_link_;
-        stamped.header.stamp = ros::Time().now();
-        stamped.pose.position.x = previous_frame.p.x() + ((frame.p.x() - previous_frame.p.x()) * 0.5);
-        stamped.pose.position.y = previous_frame.p.y() + ((frame.p.y() - previous_frame.p.y()) * 0.5);
-        stamped.pose.position.z = previous_frame.p.z() + ((frame.p.z() - previous_frame.p.z()) * 0.5);
-        previous_frame.M.GetQuaternion(stamped.pose.orientation.x, stamped.pose.orientation.y,
-                                       stamped.pose.orientation.z, stamped.pose.orientation.w);
-        // broadcast static frame
-        createStaticFrame(stamped, key + std::to_string(point));
-        collision_matrix_[key + std::to_string(point)] = stamped;
-        point = point + 1;
-      }
+      continue;
+    }
 
-      // as usally add ball at every joint
-      geometry_msgs::PoseStamped stamped;
-      KDL::Frame frame;
+    // distance between two frame are more than ball randius than add intermidate ball in middle of segment
+    if (Transformation_Matrix[counter](2, 3) > 0.20)  // predictive_configuration::ball_radius_
+    {
+      ROS_INFO("CollisionRobot: Add intermidiate volume with point: %s", (key + std::to_string(point)).c_str());
+      collision_model_.addSphere(key + std::to_string(point), counter, 0.5, predictive_configuration::ball_radius_);
+      point = point + 1;
+    }
 
-      // transform Eigen Matrix to Kdl Frame
-      transformEigenMatrixToKDL(*it, frame);
+    // as usally add ball at every joint
+    collision_model_.addSphere(key + std::to_string(point), counter, 1.0, predictive_configuration::ball_radius_);
+    point = point + 1;
+  }
 
-      // fill up pose stamped
-      stamped.header.frame_id = predictive_configuration::chain_root_link_;
-      stamped.header.stamp = ros::Time().now();
-      stamped.pose.position.x = frame.p.x();
-      stamped.pose.position.y = frame.p.y();
-      stamped.pose.position.z = frame.p.z();
-      frame.M.GetQuaternion(stamped.pose.orientation.x, stamped.pose.orientation.y, stamped.pose.orientation.z,
-                            stamped.pose.orientation.w);
+  collision_model_.updateCenters(FK_Homogenous_Matrix);
+  initializeSelfCollisionKernel(collision_model_);
 
-      collision_matrix_[key + std::to_string(point)] = stamped;
-      point = point + 1;
-    }
-    else
-    {
-      ;
-    }
-    counter = counter + 1;
+  // markers and frames of balls, frames only broadcast once for visualization of initial configuration
+  for (int i = 0u; i < collision_model_.getNumberOfSpheres(); ++i)
+  {
+    geometry_msgs::PoseStamped stamped;
+    stamped.header.frame_id = predictive_configuration::chain_root_link_;
+    stamped.header.stamp = ros::Time::now();
+    stamped.pose.position.x = collision_model_.getCenterX()(i);
+    stamped.pose.position.y = collision_model_.getCenterY()(i);
+    stamped.pose.position.z = collision_model_.getCenterZ()(i);
+    stamped.pose.orientation.w = 1.0;
+
+    createStaticFrame(stamped, collision_model_.getName(i));
+    visualizeCollisionVolume(stamped, collision_model_.getRadius()(i), i);
   }
 }
 
@@ -197,39 +190,35 @@ void CollisionRobot::visualizeCollisionVolume(const geometry_msgs::PoseStamped&
 }
 
 // compute collsion cost such way that below minimum distance cost goes to infinite, and far distance costs goes to zero
-void CollisionRobot::computeCollisionCost(const std::map<std::string, geometry_msgs::PoseStamped> collision_matrix,
-                                          const double& collision_min_distance, const double& weight_factor)
+void CollisionRobot::computeCollisionCost(const CollisionModel& collision_model, const double& collision_min_distance,
+                                          const double& weight_factor)
 {
-  collision_cost_vector_ = Eigen::VectorXd(collision_matrix.size());
+  // exclusion mask belongs to layout, rebuild only if other model is passed
+  if (self_collision_kernel_.getNumberOfSpheres() != collision_model.getNumberOfSpheres())
+  {
+    initializeSelfCollisionKernel(collision_model);
+  }
+
+  // logistic cost function of every pair of balls, pair gradients kept by kernel
+  // Nonlinear Model Predictive Control for Multi-Micro Aerial Vehicle Robust Collision Avoidance
+  // https://arxiv.org/pdf/1703.01164.pdf ... equation(10)
+  self_collision_kernel_.evaluate(collision_model, collision_min_distance, weight_factor);
+  collision_cost_vector_ = self_collision_kernel_.getSphereCost();
+}
 
-  // iterate to one by one point in collision matrix
-  int loop_counter = 0u;
-  for (auto it_out = collision_matrix.begin(); it_out != collision_matrix.end(); ++it_out, ++loop_counter)
+void CollisionRobot::initializeSelfCollisionKernel(const CollisionModel& collision_model)
+{
+  self_collision_kernel_.initialize(collision_model, predictive_configuration::ignore_adjacent_links_);
+
+  // pairs configured by ball name, e.g. balls of links never able to reach each other
+  const std::vector<std::string>& pairs = predictive_configuration::self_collision_ignore_pairs_;
+  for (int i = 0u; i + 1 < pairs.size(); i += 2)
   {
-    double dist = 0.0;
-    for (auto it_in = collision_matrix.begin(); it_in != collision_matrix.end(); ++it_in)
+    if (!self_collision_kernel_.ignorePair(pairs[i], pairs[i + 1], collision_model))
     {
-      // both string are not equal than execute if loop
-      if (it_out->first.find(it_in->first) == std::string::npos)
-      {
-        // logistic cost function
-        // Nonlinear Model Predictive Control for Multi-Micro Aerial Vehicle Robust Collision Avoidance
-        // https://arxiv.org/pdf/1703.01164.pdf ... equation(10)
-        ROS_DEBUG(" '%s'  <---> '%s'", it_out->first.c_str(), it_in->first.c_str());
-        // dist += exp( ((collision_min_distance) -
-        //              (std::abs(getEuclideanDistance(it_out->second.pose, it_in->second.pose))) ) / weight_factor);
-        dist += exp(((collision_min_distance * collision_min_distance) -
-                     (std::abs(getEuclideanDistance(it_out->second.pose, it_in->second.pose)) *
-                      std::abs(getEuclideanDistance(it_out->second.pose, it_in->second.pose)))) /
-                    weight_factor);
-
-        ROS_DEBUG_STREAM("Exponential term: " << exp(
-                             collision_min_distance -
-                             std::abs(getEuclideanDistance(it_out->second.pose, it_in->second.pose)) / weight_factor));
-      }
+      ROS_WARN("CollisionRobot: Ignore pair %s <---> %s not found in collision model", pairs[i].c_str(),
+               pairs[i + 1].c_str());
     }
-    // store cost of each point into vector
-    collision_cost_vector_(loop_counter) = dist;
   }
 }
 
@@ -292,7 +281,49 @@ void CollisionRobot::transformEigenMatrixToKDL(const Eigen::MatrixXd& matrix, KD
 //--------------------------- Static Collision Object Avoidance ----------------------------------
 //--------------------------------------------------------------------------------------------------------------------------------
 
-StaticCollision::StaticCollision()
+// cost of static object below it neglected, defines query radius of bounding volume hierarchy
+static const double STATIC_COLLISION_COST_EPSILON = 1e-6;
+
+// minimum distance between surface of robot ball and static object
+static const double STATIC_COLLISION_THRESHOLD_DISTANCE = 0.10;
+
+// distance beyond which cost exp((d_min^2 - d * |d|) / w) falls below STATIC_COLLISION_COST_EPSILON
+static double computeInfluenceDistance(const double& collision_threshold_distance, const double& weight_factor)
+{
+  const double threshold_squared = collision_threshold_distance * collision_threshold_distance;
+  return std::sqrt(std::max(threshold_squared - weight_factor * std::log(STATIC_COLLISION_COST_EPSILON), 0.0));
+}
+
+// marker shape of static object
+static int getMarkerType(const CollisionPrimitiveType& type)
+{
+  switch (type)
+  {
+    case COLLISION_PRIMITIVE_BOX:
+      return visualization_msgs::Marker::CUBE;
+    case COLLISION_PRIMITIVE_CYLINDER:
+      return visualization_msgs::Marker::CYLINDER;
+    default:
+      return visualization_msgs::Marker::SPHERE;
+  }
+}
+
+// id should be unique, object with same id replaced
+static void addStaticObject(const CollisionPrimitive& primitive, std::vector<CollisionPrimitive>& static_objects)
+{
+  for (auto it = static_objects.begin(); it != static_objects.end(); ++it)
+  {
+    if (it->id == primitive.id)
+    {
+      *it = primitive;
+      return;
+    }
+  }
+
+  static_objects.push_back(primitive);
+}
+
+StaticCollision::StaticCollision() : scene_version_(0)
 {
   ;
 }
@@ -306,7 +337,26 @@ StaticCollision::~StaticCollision()
 void StaticCollision::clearDataMember()
 {
   marker_array_.markers.clear();
-  collision_matrix_.clear();
+  static_objects_.clear();
+  static_object_tree_.clear();
+}
+
+// swap with last object, same renumbering in bounding volume hierarchy
+void StaticCollision::removeStaticObject(const int& index)
+{
+  static_object_tree_.removeObject(index);
+  static_objects_[index] = static_objects_.back();
+  static_objects_.pop_back();
+}
+
+// new scene version, signed distance grid of previous version no longer used
+void StaticCollision::onStaticObjectsChanged()
+{
+  ++scene_version_;
+  if (predictive_configuration::use_distance_field_)
+  {
+    distance_field_.requestBake(static_objects_, scene_version_);
+  }
 }
 
 // initialize and create publisher for publishing collsion ball marker
@@ -338,26 +388,33 @@ bool StaticCollision::initializeStaticCollisionObject()
   ROS_INFO("===== remove static object published with topic: "
            "~/predictive_control/collisionRobot/remove_all_static_objects =====");
 
+  // signed distance grid over cube centered at chain root, distance beyond influence of cost not stored
+  if (predictive_configuration::use_distance_field_)
+  {
+    const double size = predictive_configuration::distance_field_size_;
+    const double influence_distance = computeInfluenceDistance(STATIC_COLLISION_THRESHOLD_DISTANCE,
+                                                               predictive_configuration::collision_weight_factor_);
+    const double truncation = predictive_configuration::ball_radius_ + influence_distance;
+    distance_field_.initialize(Eigen::Vector3d::Constant(-0.5 * size), Eigen::Vector3d::Constant(size),
+                               predictive_configuration::distance_field_resolution_, truncation);
+  }
+
   ROS_WARN("STATIC COLLISION INITIALIZED!!");
 
   // generate static collision volume
   // generateStaticCollisionVolume();
 
   // DEBUG
-  if (true)
+  for (auto const& it : static_objects_)
   {
-    ROS_WARN("===== STATIC COLLISION MATRIX =====");
-    for (auto const& it : collision_matrix_)
-    {
-      ROS_INFO_STREAM("StaticCollision: " << it.first << " -> stamped: \n" << it.second);
-    }
+    PD_LOG_DEBUG("StaticCollision: %s -> position: %f %f %f", it.id.c_str(), it.position(0), it.position(1),
+                 it.position(2));
   }
 
   // visualize marker array
-  int id = 0u;
-  for (auto it = collision_matrix_.begin(); it != collision_matrix_.end(); ++it, ++id)
+  for (auto const& it : static_objects_)
   {
-    visualizeStaticCollisionVoulme(it->second);
+    visualizeStaticCollisionVoulme(it);
   }
 
   return true;
@@ -382,31 +439,11 @@ bool StaticCollision::addStaticObjectServiceCB(predictive_control::StaticCollisi
     if (request.object_id.empty())
       object_id = request.object_name;
 
-    // add object into collision matrix for cost calculation
-    collision_matrix_[object_id] = request.primitive_pose;
-    createStaticFrame(request.primitive_pose, object_id);
-
-    visualization_msgs::Marker marker;
-
-    // box
-    if (request.object_name == "box" || request.object_name == "BOX")
-    {
-      marker.type = marker.CUBE;
-    }
-
-    // cylinder
-    else if (request.object_name == "cylinder" || request.object_name == "CYLINDER")
-    {
-      marker.type = marker.CYLINDER;
-    }
-
-    // sphere
-    else if (request.object_name == "sphere" || request.object_name == "SPHERE")
-    {
-      marker.type = marker.SPHERE;
-    }
+    CollisionPrimitive primitive;
+    primitive.id = object_id;
 
-    else
+    // box, cylinder or sphere
+    if (!getCollisionPrimitiveType(request.object_name, primitive.type))
     {
       response.success = false;
       std::string message("Shape of object is not defined correctly");
@@ -415,6 +452,15 @@ bool StaticCollision::addStaticObjectServiceCB(predictive_control::StaticCollisi
       return false;
     }
 
+    // add object into static objects for cost calculation, dimension stored with object
+    primitive.dimensions << request.dimension.x, request.dimension.y, request.dimension.z;
+    setPrimitivePose(request.primitive_pose.header.frame_id, request.primitive_pose.pose, primitive);
+    addStaticObject(primitive, static_objects_);
+    createStaticFrame(request.primitive_pose, object_id);
+
+    visualization_msgs::Marker marker;
+    marker.type = getMarkerType(primitive.type);
+
     marker.action = visualization_msgs::Marker::ADD;
     marker.ns = "preview";
     marker.header.frame_id = request.primitive_pose.header.frame_id;
@@ -488,19 +534,10 @@ bool StaticCollision::addStaticObjectServiceCB(predictive_control::StaticCollisi
         getline(myfile, line);  // 3 line not useful line
         getline(myfile, line);  // 4 line
 
-        if (line.compare("box") == 0)
-        {
-          marker.type = marker.CUBE;
-        }
-
-        else if (line.compare("cylinder") == 0)
-        {
-          marker.type = marker.CYLINDER;
-        }
-
-        else if (line.compare("sphere") == 0)
+        CollisionPrimitive primitive;
+        if (getCollisionPrimitiveType(line, primitive.type))
         {
-          marker.type = marker.SPHERE;
+          marker.type = getMarkerType(primitive.type);
         }
 
         else
@@ -509,6 +546,10 @@ bool StaticCollision::addStaticObjectServiceCB(predictive_control::StaticCollisi
           std::string message("Shape of object is not defined correctly, check file on location " + filename);
           ROS_ERROR("StaticCollision: %s", message.c_str());
           response.message = message;
+
+          // keep objects read so far
+          static_object_tree_.build(static_objects_);
+          onStaticObjectsChanged();
           return false;
         }
 
@@ -539,8 +580,11 @@ bool StaticCollision::addStaticObjectServiceCB(predictive_control::StaticCollisi
         marker.header.frame_id = request.object_name;  // request.primitive_pose.header.frame_id;
         // marker.pose = stamped.pose;
 
-        // add object into collision matrix for cost calculation
-        collision_matrix_[object_id] = stamped;  // request.primitive_pose;
+        // add object into static objects for cost calculation, pose in file relative to object frame
+        primitive.id = request.file_name + " " + object_id;
+        primitive.dimensions << marker.scale.x, marker.scale.y, marker.scale.z;
+        setPrimitivePose(request.object_name, marker.pose, primitive);
+        addStaticObject(primitive, static_objects_);
 
         getline(myfile, line);  // 8 line not useful line
         getline(myfile, line);  // 9 line not useful line
@@ -561,6 +605,10 @@ bool StaticCollision::addStaticObjectServiceCB(predictive_control::StaticCollisi
 
   marker_pub_.publish(marker_array_);
 
+  // rebuild bounding volume hierarchy once per request, all objects of file added
+  static_object_tree_.build(static_objects_);
+  onStaticObjectsChanged();
+
   // response
   response.success = true;
   response.message = ("Successfully add to the environment");
@@ -580,14 +628,22 @@ bool StaticCollision::removeStaticObjectServiceCB(predictive_control::StaticColl
     if (request.object_id.empty())
       object_id = request.object_name;
 
-    // erase that object from collision matrix list
-    auto it = collision_matrix_.find(object_id);
-    collision_matrix_.erase(it);
+    // erase that object from static objects
+    for (int i = 0u; i < static_objects_.size(); ++i)
+    {
+      if (static_objects_[i].id == object_id)
+      {
+        removeStaticObject(i);
+        onStaticObjectsChanged();
+        break;
+      }
+    }
 
     // remove that object form marker list, we can requst only one object to remove
+    bool found = false;
     for (auto it = marker_array_.markers.begin(); it != marker_array_.markers.end(); ++it)
     {
-      if (it->text == request.object_id)
+      if (it->text == object_id)
       {
         it->action = visualization_msgs::Marker::DELETE;
         it->ns = "preview";
@@ -595,16 +651,17 @@ bool StaticCollision::removeStaticObjectServiceCB(predictive_control::StaticColl
         // make sure first publish it and than remove from list to maintain list
         marker_pub_.publish(marker_array_);
         marker_array_.markers.erase(it);
+        found = true;
         break;
       }
+    }
 
-      // iteration reach to end, considering not found requested object
-      if (it == marker_array_.markers.end())
-      {
-        response.success = false;
-        response.message = (" Not find requsted object into list ");
-        return false;
-      }
+    // iteration reach to end, considering not found requested object
+    if (!found)
+    {
+      response.success = false;
+      response.message = (" Not find requsted object into list ");
+      return false;
     }
 
     // response
@@ -624,19 +681,25 @@ bool StaticCollision::removeStaticObjectServiceCB(predictive_control::StaticColl
 
     ROS_WARN("Hello");
 
-    // erase that object from collision matrix list
-    for (std::map<std::string, geometry_msgs::PoseStamped>::const_iterator it = collision_matrix_.begin();
-         it != collision_matrix_.end(); ++it)
+    // erase objects of that file from static objects
+    // Be careful, removed object replaced by last one so do not put increment of index in for loop
+    for (int i = 0u; i < static_objects_.size();)
     {
       //  just check required char inside the string, if yes than remove it
-      if (it->first.find(request.file_name) != std::string::npos)
+      if (static_objects_[i].id.find(request.file_name) != std::string::npos)
+      {
+        removeStaticObject(i);
+      }
+      else
       {
-        collision_matrix_.erase(it);
+        ++i;
       }
     }
+    onStaticObjectsChanged();
     ROS_WARN("Hello");
     // remove that object form marker list, we can requst only one object to remove
-    // Be careful, here we are erasing iteration so do not put increment of iteration in for loop
+    // Be careful, erase returns next iteration so increment only kept markers
+    bool found = false;
     for (auto it = marker_array_.markers.begin(); it != marker_array_.markers.end();)
     {
       // just check required char inside the string, if yes than remove it
@@ -647,22 +710,22 @@ bool StaticCollision::removeStaticObjectServiceCB(predictive_control::StaticColl
 
         // make sure first publish it and than remove from list to maintain list
         marker_pub_.publish(marker_array_);
-        marker_array_.markers.erase(it);
+        it = marker_array_.markers.erase(it);
+        found = true;
       }
-
-      // iteration reach to end, considering not found requested object
-      else if (it == marker_array_.markers.end())
-      {
-        response.success = false;
-        response.message = (" Not find requsted object into list ");
-        return false;
-      }
-
       else
       {
         ++it;
       }
     }
+
+    // iteration reach to end, considering not found requested object
+    if (!found)
+    {
+      response.success = false;
+      response.message = (" Not find requsted object into list ");
+      return false;
+    }
     ROS_WARN("Hello");
     // response
     response.success = true;
@@ -675,53 +738,63 @@ bool StaticCollision::removeStaticObjectServiceCB(predictive_control::StaticColl
 bool StaticCollision::removeAllStaticObjectsServiceCB(predictive_control::StaticCollisionObjectRequest& request,
                                                       predictive_control::StaticCollisionObjectResponse& response)
 {
-  // remove all object from collision matrix list
-  for (std::map<std::string, geometry_msgs::PoseStamped>::const_iterator it = collision_matrix_.begin();
-       it != collision_matrix_.end(); ++it)
-  {
-    collision_matrix_.erase(it);
-  }
+  // remove all object from static objects
+  static_objects_.clear();
+  static_object_tree_.clear();
+  onStaticObjectsChanged();
 
-  // remove all object from environment
+  // remove all object from environment, publish deletion once before clear the list
   for (auto it = marker_array_.markers.begin(); it != marker_array_.markers.end(); ++it)
   {
     it->action = visualization_msgs::Marker::DELETE;
-    marker_pub_.publish(marker_array_);
-    marker_array_.markers.erase(it);
   }
+  marker_pub_.publish(marker_array_);
+  marker_array_.markers.clear();
 
   response.success = true;
   response.message = "Successfully remove all objects from environment";
   return true;
 }
 // update collsion ball position, publish new position of collision ball
-void StaticCollision::updateStaticCollisionVolume(
-    const std::map<std::string, geometry_msgs::PoseStamped>& robot_critical_points)
+void StaticCollision::updateStaticCollisionVolume(const CollisionModel& robot_model)
 {
   // DEBUG
   if (predictive_configuration::activate_output_)
   {
-    ROS_WARN("########### Print ROBOT CRITICLE POINT MATRIX ############");
-    for (auto it = robot_critical_points.begin(); it != robot_critical_points.end(); ++it)
+    for (int i = 0u; i < robot_model.getNumberOfSpheres(); ++i)
     {
-      std::cout << it->first.c_str() << ": \n" << it->second << std::endl;
+      PD_LOG_DEBUG("StaticCollision: robot critical point %s -> position: %f %f %f", robot_model.getName(i).c_str(),
+                   robot_model.getCenterX()(i), robot_model.getCenterY()(i), robot_model.getCenterZ()(i));
     }
   }
 
   // publish
   marker_pub_.publish(marker_array_);
 
+  // objects changed without rebuild
+  if (static_object_tree_.getNumberOfObjects() != static_objects_.size())
+  {
+    static_object_tree_.build(static_objects_);
+  }
+
+  // signed distance grid only if baked for current scene
+  boost::shared_ptr<const SignedDistanceGrid> distance_grid;
+  if (predictive_configuration::use_distance_field_)
+  {
+    distance_grid = distance_field_.getGrid();
+    if (distance_grid && distance_grid->version != scene_version_)
+    {
+      distance_grid.reset();
+    }
+  }
+
   // compute collision cost vectors
   computeStaticCollisionCost(
-      collision_matrix_, robot_critical_points, 0.10,
+      static_objects_, static_object_tree_, distance_grid.get(), robot_model, STATIC_COLLISION_THRESHOLD_DISTANCE,
       predictive_configuration::collision_weight_factor_);  // predictive_configuration::minimum_collision_distance_
 
-  // DEBUG
-  if (true)  // predictive_configuration::activate_output_
-  {
-    ROS_WARN("===== STATIC COLLISION COST VECTOR =====");
-    std::cout << collision_cost_vector_.transpose() << std::endl;
-  }
+  PD_LOG_DEBUG_VALUES("StaticCollision: collision cost vector:", collision_cost_vector_.data(),
+                      collision_cost_vector_.size());
 }
 
 // create collision cost for static objects
@@ -743,19 +816,27 @@ void StaticCollision::generateStaticCollisionVolume()
   stamped.pose.orientation.y = 0.0;
   stamped.pose.orientation.z = 0.0;
 
-  collision_matrix_["box"] = stamped;
+  CollisionPrimitive primitive;
+  primitive.id = "box";
+  primitive.type = COLLISION_PRIMITIVE_BOX;
+  primitive.dimensions << 1.30, 1.30, 0.10;
+  setPrimitivePose(stamped.header.frame_id, stamped.pose, primitive);
+  addStaticObject(primitive, static_objects_);
+  static_object_tree_.build(static_objects_);
+  onStaticObjectsChanged();
 
   // visualize static collision voulume
   createStaticFrame(stamped, "box");
 }
 
 // visualize static collision object
-void StaticCollision::visualizeStaticCollisionVoulme(const geometry_msgs::PoseStamped& stamped)
+void StaticCollision::visualizeStaticCollisionVoulme(const CollisionPrimitive& primitive)
 {
   visualization_msgs::Marker marker;
-  marker.type = visualization_msgs::Marker::CUBE;
+  marker.type = getMarkerType(primitive.type);
   marker.action = visualization_msgs::Marker::ADD;
   marker.ns = "preview";
+  marker.text = primitive.id;
 
   // texture
   marker.color.r = 1.0;
@@ -764,20 +845,21 @@ void StaticCollision::visualizeStaticCollisionVoulme(const geometry_msgs::PoseSt
   marker.color.a = 0.1;
 
   // dimension
-  marker.scale.x = 1.30;
-  marker.scale.y = 1.30;
-  marker.scale.z = 0.10;
+  marker.scale.x = primitive.dimensions(0);
+  marker.scale.y = primitive.dimensions(1);
+  marker.scale.z = primitive.dimensions(2);
 
   // position into world
+  const Eigen::Quaterniond orientation(primitive.rotation);
   marker.id = 0;
-  marker.header.frame_id = stamped.header.frame_id;
-  marker.pose.position.x = stamped.pose.position.x;
-  marker.pose.position.y = stamped.pose.position.y;
-  marker.pose.position.z = stamped.pose.position.z;
-  marker.pose.orientation.w = stamped.pose.orientation.w;
-  marker.pose.orientation.x = stamped.pose.orientation.x;
-  marker.pose.orientation.y = stamped.pose.orientation.y;
-  marker.pose.orientation.z = stamped.pose.orientation.z;
+  marker.header.frame_id = predictive_configuration::chain_root_link_;
+  marker.pose.position.x = primitive.position(0);
+  marker.pose.position.y = primitive.position(1);
+  marker.pose.position.z = primitive.position(2);
+  marker.pose.orientation.w = orientation.w();
+  marker.pose.orientation.x = orientation.x();
+  marker.pose.orientation.y = orientation.y();
+  marker.pose.orientation.z = orientation.z();
 
   // store created marker
   marker_array_.markers.push_back(marker);
@@ -829,6 +911,32 @@ bool StaticCollision::getTransform(const std::string& from, const std::string& t
   return transform;
 }
 
+// pose of static object relative to root frame, compose with transform of frame it is given in
+bool StaticCollision::setPrimitivePose(const std::string& frame_id, const geometry_msgs::Pose& pose,
+                                       CollisionPrimitive& primitive)
+{
+  Eigen::Affine3d object_pose;
+  tf::poseMsgToEigen(pose, object_pose);
+
+  bool transform = true;
+  if (!frame_id.empty() && frame_id != predictive_configuration::chain_root_link_)
+  {
+    geometry_msgs::PoseStamped frame_pose;
+    transform = getTransform(predictive_configuration::chain_root_link_, frame_id, frame_pose);
+    if (transform)
+    {
+      Eigen::Affine3d root_to_frame;
+      tf::poseMsgToEigen(frame_pose.pose, root_to_frame);
+      object_pose = root_to_frame * object_pose;
+    }
+  }
+
+  primitive.position = object_pose.translation();
+  primitive.rotation = object_pose.linear();
+
+  return transform;
+}
+
 // create static frame, just for visualization purpose
 void StaticCollision::createStaticFrame(const geometry_msgs::PoseStamped& stamped, const std::string& frame_name)
 {
@@ -852,119 +960,67 @@ void StaticCollision::createStaticFrame(const geometry_msgs::PoseStamped& stampe
   ros::spinOnce();
 }
 
-void StaticCollision::computeStaticCollisionCost(
-    const std::map<std::string, geometry_msgs::PoseStamped> static_collision_matrix,
-    const std::map<std::string, geometry_msgs::PoseStamped> robot_collision_matrix,
-    const double& collision_threshold_distance, const double& weight_factor)
+void StaticCollision::computeStaticCollisionCost(const std::vector<CollisionPrimitive>& static_objects,
+                                                 const CollisionBoundingVolumeHierarchy& static_object_tree,
+                                                 const SignedDistanceGrid* distance_grid,
+                                                 const CollisionModel& robot_model,
+                                                 const double& collision_threshold_distance,
+                                                 const double& weight_factor)
 
 {
-  collision_cost_vector_ = Eigen::VectorXd(robot_collision_matrix.size());
-  collision_cost_vector_.resize(robot_collision_matrix.size());
+  const int spheres = robot_model.getNumberOfSpheres();
+  const Eigen::VectorXd& x = robot_model.getCenterX();
+  const Eigen::VectorXd& y = robot_model.getCenterY();
+  const Eigen::VectorXd& z = robot_model.getCenterZ();
+  const Eigen::VectorXd& radius = robot_model.getRadius();
 
-  for (auto it : static_collision_matrix)
+  collision_cost_vector_.setZero(spheres);
+  collision_gradient_.setZero(spheres, 3);
+
+  for (auto const& it : static_objects)
   {
-    ROS_WARN_STREAM(it.first);
-    ROS_WARN_STREAM(it.second);
+    PD_LOG_DEBUG("StaticCollision: static object %s -> position: %f %f %f", it.id.c_str(), it.position(0),
+                 it.position(1), it.position(2));
   }
 
-  /*
-    // iterate to one by one point in collision matrix
-    int loop_counter = 0u;
-    for (auto it_out = static_collision_matrix.begin(); it_out != static_collision_matrix.end(); ++it_out,
-    ++loop_counter)
-    {
-      double dist = 0.0;
-      for (auto it_in = robot_collision_matrix.begin(); it_in != robot_collision_matrix.end(); ++it_in)
-      {
-        // both string are not equal than execute if loop
-        if (it_out->first.find(it_in->first) == std::string::npos)
-        {
-          // logistic cost function
-          // Nonlinear Model Predictive Control for Multi-Micro Aerial Vehicle Robust Collision Avoidance
-          // https://arxiv.org/pdf/1703.01164.pdf ... equation(10)
-          ROS_ERROR(" '%s'  <---> '%s'", it_out->first.c_str(),it_in->first.c_str());
-          //dist += exp( ((collision_min_distance) -
-          //              (std::abs(getEuclideanDistance(it_out->second.pose, it_in->second.pose))) ) / weight_factor);
-          dist += exp( ((collision_threshold_distance*collision_threshold_distance) -
-                        (std::abs(CollisionRobot::getEuclideanDistance(it_out->second.pose, it_in->second.pose)) *
-    std::abs(CollisionRobot::getEuclideanDistance(it_out->second.pose, it_in->second.pose))) ) / weight_factor);
-
-          ROS_DEBUG_STREAM("Exponential term: "<<
-                           exp(collision_threshold_distance -
-    std::abs(CollisionRobot::getEuclideanDistance(it_out->second.pose, it_in->second.pose)) / weight_factor));
-        }
-      }
-      //store cost of each point into vector
-      collision_cost_vector_(loop_counter) = dist;
-    }*/
+  // logistic cost of signed distance between surface of every robot ball and surface of every static object,
+  // d * |d| keeps cost increasing once ball penetrates object
+  const double threshold_squared = collision_threshold_distance * collision_threshold_distance;
+  const double inverse_weight = 1.0 / weight_factor;
+
+  // cost of objects farther than influence distance below STATIC_COLLISION_COST_EPSILON, not queried
+  const double influence_distance = computeInfluenceDistance(collision_threshold_distance, weight_factor);
 
-  int loop_counter = 0u;
-  for (auto it_out = robot_collision_matrix.begin(); it_out != robot_collision_matrix.end(); ++it_out, ++loop_counter)
+  Eigen::Vector3d gradient;
+  for (int i = 0u; i < spheres; ++i)
   {
-    double dist = 0.0;
-    int static_object_counter = 0u;
-    for (auto it_in = static_collision_matrix.begin(); it_in != static_collision_matrix.end();
-         ++it_in, ++static_object_counter)
+    const Eigen::Vector3d center(x(i), y(i), z(i));
+    static_object_tree.querySphere(center, radius(i) + influence_distance, nearby_objects_);
+    const int objects = nearby_objects_.size();
+
+    // single object within influence distance is nearest object of grid, so interpolated distance gives same cost as
+    // exact distance. Grid keeps no distance per object, several close objects always summed exactly below
+    double distance = 0.0;
+    if (objects == 1 && distance_grid && distance_grid->getDistance(center, distance, gradient))
     {
-      if (it_out->first.find(it_in->first) == std::string::npos)
-      {
-        // dimension should half of scale
-        double dim_x = marker_array_.markers.at(static_object_counter).scale.x * 0.5;
-        double dim_y = marker_array_.markers.at(static_object_counter).scale.y * 0.5;
-        double dim_z = marker_array_.markers.at(static_object_counter).scale.z * 0.5;
-
-        // move to center of object
-        geometry_msgs::Pose center_pose = it_in->second.pose;
-        center_pose.position.x = (it_in->second.pose.position.x) + dim_x;
-        center_pose.position.y = (it_in->second.pose.position.y) + dim_y;
-        center_pose.position.z = (it_in->second.pose.position.z) + dim_z;
-
-        // compute error vector from x_negative
-        geometry_msgs::Pose x_negative(center_pose);
-        x_negative.position.x -= dim_x;
-        double dist_x_neg = CollisionRobot::getEuclideanDistance(it_out->second.pose, x_negative);
-        dist += exp((0.010 - dist_x_neg * dist_x_neg) / weight_factor);
-        ROS_WARN_STREAM("dist_x_neg: " << CollisionRobot::getEuclideanDistance(it_out->second.pose, x_negative));
-
-        // compute error vector from x_positive
-        geometry_msgs::Pose x_positive(center_pose);
-        x_positive.position.x += dim_x;
-        double dist_x_pos = CollisionRobot::getEuclideanDistance(it_out->second.pose, x_positive);
-        dist += exp((0.010 - dist_x_pos * dist_x_pos) / weight_factor);
-        ROS_WARN_STREAM("dist_x_pos: " << CollisionRobot::getEuclideanDistance(it_out->second.pose, x_positive));
-
-        // compute error vector from y_negative
-        geometry_msgs::Pose y_negative(center_pose);
-        y_negative.position.y -= dim_y;
-        double dist_y_neg = CollisionRobot::getEuclideanDistance(it_out->second.pose, y_negative);
-        dist += exp((0.010 - dist_y_neg * dist_y_neg) / weight_factor);
-        ROS_WARN_STREAM("dist_y_neg: " << CollisionRobot::getEuclideanDistance(it_out->second.pose, y_negative));
-
-        // compute error vector from y_positive
-        geometry_msgs::Pose y_positive(center_pose);
-        y_positive.position.y += dim_y;
-        double dist_y_pos = CollisionRobot::getEuclideanDistance(it_out->second.pose, y_positive);
-        dist += exp((0.010 - dist_y_pos * dist_y_pos) / weight_factor);
-        ROS_WARN_STREAM("dist_y_pos: " << CollisionRobot::getEuclideanDistance(it_out->second.pose, y_positive));
-
-        // compute error vector from y_negative
-        geometry_msgs::Pose z_negative(center_pose);
-        z_negative.position.z -= dim_z;
-        double dist_z_neg = CollisionRobot::getEuclideanDistance(it_out->second.pose, z_negative);
-        dist += exp((0.010 - dist_z_neg * dist_z_neg) / weight_factor);
-        ROS_WARN_STREAM("dist_z_neg: " << CollisionRobot::getEuclideanDistance(it_out->second.pose, z_negative));
-
-        // compute error vector from y_positive
-        geometry_msgs::Pose z_positive(center_pose);
-        z_positive.position.z += dim_z;
-        double dist_z_pos = CollisionRobot::getEuclideanDistance(it_out->second.pose, z_positive);
-        dist += exp((0.010 - dist_z_pos * dist_z_pos) / weight_factor);
-        ROS_WARN_STREAM("dist_z_pos: " << CollisionRobot::getEuclideanDistance(it_out->second.pose, z_positive));
-      }
+      distance -= radius(i);
+      const double cost = exp((threshold_squared - distance * std::abs(distance)) * inverse_weight);
+      collision_cost_vector_(i) += cost;
+      collision_gradient_.row(i) -= (2.0 * std::abs(distance) * inverse_weight * cost) * gradient.transpose();
+      continue;
+    }
+
+    for (int k = 0u; k < objects; ++k)
+    {
+      distance = computeSphereSignedDistance(static_objects[nearby_objects_[k]], center, radius(i), gradient);
+      const double cost = exp((threshold_squared - distance * std::abs(distance)) * inverse_weight);
+
+      // store cost of each point into vector, dc/dp = -2 |d| / w * c * dd/dp
+      collision_cost_vector_(i) += cost;
+      collision_gradient_.row(i) -= (2.0 * std::abs(distance) * inverse_weight * cost) * gradient.transpose();
     }
-    // store cost of each point into vector
-    collision_cost_vector_(loop_counter) = dist;
   }
-  ROS_ERROR_STREAM("=============== STATIC COLLSION DISTANCE VECRTOR ================= ");
-  std::cout << collision_cost_vector_.transpose() << std::endl;
+
+  PD_LOG_DEBUG_VALUES("StaticCollision: collision distance vector:", collision_cost_vector_.data(),
+                      collision_cost_vector_.size());
 }
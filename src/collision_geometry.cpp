@@ -0,0 +1,172 @@
+// This file containts primitive shapes of static obstacles and closed form signed distance of robot spheres to them
+
+#include <predictive_control/collision_geometry.h>
+
+#include <algorithm>
+#include <cmath>
+
+// sign of coordinate, points on symmetry plane pushed to positive side
+static inline double sign(const double value)
+{
+  return (value < 0.0) ? -1.0 : 1.0;
+}
+
+bool getCollisionPrimitiveType(const std::string& name, CollisionPrimitiveType& type)
+{
+  if (name == "box" || name == "BOX")
+  {
+    type = COLLISION_PRIMITIVE_BOX;
+  }
+  else if (name == "cylinder" || name == "CYLINDER")
+  {
+    type = COLLISION_PRIMITIVE_CYLINDER;
+  }
+  else if (name == "sphere" || name == "SPHERE")
+  {
+    type = COLLISION_PRIMITIVE_SPHERE;
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+// distance to box: outside distance to nearest point on surface (face, edge or corner),
+// inside distance to nearest face
+static double computeBoxDistance(const Eigen::Vector3d& local, const Eigen::Vector3d& half_extents,
+                                 Eigen::Vector3d& local_gradient)
+{
+  const Eigen::Vector3d excess = local.cwiseAbs() - half_extents;
+  const Eigen::Vector3d outside = excess.cwiseMax(0.0);
+  const double outside_norm = outside.norm();
+
+  if (outside_norm > 0.0)
+  {
+    for (int i = 0u; i < 3; ++i)
+    {
+      local_gradient(i) = sign(local(i)) * outside(i) / outside_norm;
+    }
+    return outside_norm;
+  }
+
+  int axis = 0u;
+  excess.maxCoeff(&axis);
+  local_gradient.setZero();
+  local_gradient(axis) = sign(local(axis));
+  return excess(axis);
+}
+
+// distance to cylinder along local z: radial and axial excess combined like two dimensional box
+static double computeCylinderDistance(const Eigen::Vector3d& local, const double& radius, const double& half_height,
+                                      Eigen::Vector3d& local_gradient)
+{
+  const double radial = std::sqrt(local(0) * local(0) + local(1) * local(1));
+
+  // direction away from axis, any direction on axis itself
+  double radial_x = 1.0, radial_y = 0.0;
+  if (radial > 0.0)
+  {
+    radial_x = local(0) / radial;
+    radial_y = local(1) / radial;
+  }
+
+  const double radial_excess = radial - radius;
+  const double axial_excess = std::abs(local(2)) - half_height;
+
+  if (radial_excess > 0.0 || axial_excess > 0.0)
+  {
+    const double a = std::max(radial_excess, 0.0);
+    const double b = std::max(axial_excess, 0.0);
+    const double distance = std::sqrt(a * a + b * b);
+    local_gradient << a * radial_x / distance, a * radial_y / distance, b * sign(local(2)) / distance;
+    return distance;
+  }
+
+  if (radial_excess > axial_excess)
+  {
+    local_gradient << radial_x, radial_y, 0.0;
+    return radial_excess;
+  }
+
+  local_gradient << 0.0, 0.0, sign(local(2));
+  return axial_excess;
+}
+
+static double computeSphereDistance(const Eigen::Vector3d& local, const double& radius,
+                                    Eigen::Vector3d& local_gradient)
+{
+  const double norm = local.norm();
+  if (norm > 0.0)
+  {
+    local_gradient = local / norm;
+  }
+  else
+  {
+    local_gradient << 0.0, 0.0, 1.0;
+  }
+
+  return norm - radius;
+}
+
+double computeSignedDistance(const CollisionPrimitive& primitive, const Eigen::Vector3d& point,
+                             Eigen::Vector3d& gradient)
+{
+  // point in frame of primitive
+  const Eigen::Vector3d local = primitive.rotation.transpose() * (point - primitive.position);
+
+  Eigen::Vector3d local_gradient;
+  double distance = 0.0;
+  switch (primitive.type)
+  {
+    case COLLISION_PRIMITIVE_BOX:
+      distance = computeBoxDistance(local, 0.5 * primitive.dimensions, local_gradient);
+      break;
+    case COLLISION_PRIMITIVE_CYLINDER:
+      distance = computeCylinderDistance(local, 0.5 * primitive.dimensions(0), 0.5 * primitive.dimensions(2),
+                                         local_gradient);
+      break;
+    default:
+      distance = computeSphereDistance(local, 0.5 * primitive.dimensions(0), local_gradient);
+      break;
+  }
+
+  gradient = primitive.rotation * local_gradient;
+  return distance;
+}
+
+double computeSphereSignedDistance(const CollisionPrimitive& primitive, const Eigen::Vector3d& center,
+                                   const double& radius, Eigen::Vector3d& gradient)
+{
+  return computeSignedDistance(primitive, center, gradient) - radius;
+}
+
+// half extent along every root axis of rotated shape, cylinder as disc swept along its axis
+void computeBoundingBox(const CollisionPrimitive& primitive, Eigen::Vector3d& min, Eigen::Vector3d& max)
+{
+  Eigen::Vector3d half_extents;
+  switch (primitive.type)
+  {
+    case COLLISION_PRIMITIVE_BOX:
+      half_extents = primitive.rotation.cwiseAbs() * (0.5 * primitive.dimensions);
+      break;
+    case COLLISION_PRIMITIVE_CYLINDER:
+    {
+      const double radius = 0.5 * primitive.dimensions(0);
+      const double half_height = 0.5 * primitive.dimensions(2);
+      for (int i = 0u; i < 3; ++i)
+      {
+        const double axis = primitive.rotation(i, 2);
+        half_extents(i) = half_height * std::abs(axis) + radius * std::sqrt(std::max(1.0 - axis * axis, 0.0));
+      }
+      break;
+    }
+    default:
+      half_extents.setConstant(0.5 * primitive.dimensions(0));
+      break;
+  }
+
+  min = primitive.position - half_extents;
+  max = primitive.position + half_extents;
+}
@@ -0,0 +1,87 @@
+// This file containts flat (structure of arrays) collision model of spheres attached to kinematic chain
+
+#include <predictive_control/collision_model.h>
+
+CollisionModel::CollisionModel()
+{
+}
+
+void CollisionModel::clear()
+{
+  center_x_.resize(0);
+  center_y_.resize(0);
+  center_z_.resize(0);
+  radius_.resize(0);
+  link_id_.resize(0);
+  interpolation_.resize(0);
+
+  names_.clear();
+  name_index_.clear();
+}
+
+// arrays grow by one sphere, only while layout is built
+int CollisionModel::addSphere(const std::string& name, const int segment, const double interpolation,
+                              const double radius)
+{
+  if (name_index_.count(name) > 0)
+  {
+    return -1;
+  }
+
+  const int index = names_.size();
+  center_x_.conservativeResize(index + 1);
+  center_y_.conservativeResize(index + 1);
+  center_z_.conservativeResize(index + 1);
+  radius_.conservativeResize(index + 1);
+  link_id_.conservativeResize(index + 1);
+  interpolation_.conservativeResize(index + 1);
+
+  center_x_(index) = 0.0;
+  center_y_(index) = 0.0;
+  center_z_(index) = 0.0;
+  radius_(index) = radius;
+  link_id_(index) = segment;
+  interpolation_(index) = interpolation;
+
+  names_.push_back(name);
+  name_index_[name] = index;
+
+  return index;
+}
+
+void CollisionModel::updateCenters(const std::vector<Eigen::MatrixXd>& FK_Homogenous_Matrix,
+                                   const int& first_changed_segment)
+{
+  const int spheres = names_.size();
+  const int segments = FK_Homogenous_Matrix.size();
+  for (int i = 0u; i < spheres; ++i)
+  {
+    const int segment = link_id_(i);
+    if (segment < first_changed_segment || segment >= segments)
+    {
+      continue;
+    }
+
+    const Eigen::MatrixXd& frame = FK_Homogenous_Matrix[segment];
+    const double t = interpolation_(i);
+    if (t == 1.0 || segment == 0)
+    {
+      center_x_(i) = frame(0, 3);
+      center_y_(i) = frame(1, 3);
+      center_z_(i) = frame(2, 3);
+    }
+    else
+    {
+      const Eigen::MatrixXd& previous_frame = FK_Homogenous_Matrix[segment - 1];
+      center_x_(i) = previous_frame(0, 3) + t * (frame(0, 3) - previous_frame(0, 3));
+      center_y_(i) = previous_frame(1, 3) + t * (frame(1, 3) - previous_frame(1, 3));
+      center_z_(i) = previous_frame(2, 3) + t * (frame(2, 3) - previous_frame(2, 3));
+    }
+  }
+}
+
+int CollisionModel::findSphere(const std::string& name) const
+{
+  std::map<std::string, int>::const_iterator it = name_index_.find(name);
+  return (it != name_index_.end()) ? it->second : -1;
+}
@@ -0,0 +1,150 @@
+
+// This file containts native condensed QP solver of frame tracker, linear velocity integrator model dot(x) = J * v
+
+#include <predictive_control/condensed_qp_tracker.h>
+
+pd_condensed_qp_tracker::pd_condensed_qp_tracker()
+{
+  control_dimension_ = 0;
+  horizon_ = 0;
+}
+
+pd_condensed_qp_tracker::~pd_condensed_qp_tracker()
+{
+  mpc_core_.reset();
+}
+
+// initialize data member of pd_condensed_qp_tracker class
+bool pd_condensed_qp_tracker::initialize()
+{
+  // make sure predictice_configuration class initialized
+  if (!predictive_configuration::initialize_success_)
+  {
+    predictive_configuration::initialize();
+  }
+
+  const int state_dimension = 6;
+  control_dimension_ = predictive_configuration::degree_of_freedom_;
+  horizon_ = predictive_configuration::discretization_intervals_;
+
+  if (horizon_ <= 0 || control_dimension_ <= 0 ||
+      predictive_configuration::end_time_horizon_ <= predictive_configuration::start_time_horizon_)
+  {
+    ROS_ERROR("pd_condensed_qp_tracker: Invalid horizon (%d intervals) or degree of freedom (%d)", horizon_,
+              control_dimension_);
+    return false;
+  }
+
+  const double delta_t =
+      (predictive_configuration::end_time_horizon_ - predictive_configuration::start_time_horizon_) / horizon_;
+
+  // weights, same as LSQ terms of ACADO formulation
+  Eigen::VectorXd lsq_state_weight_factors(state_dimension);
+  Eigen::VectorXd lsq_control_weight_factors(control_dimension_);
+  for (int i = 0u; i < state_dimension; ++i)
+  {
+    lsq_state_weight_factors(i) = predictive_configuration::lsq_state_weight_factors_.at(i);
+  }
+
+  for (int i = 0u; i < control_dimension_; ++i)
+  {
+    lsq_control_weight_factors(i) = predictive_configuration::lsq_control_weight_factors_.at(i);
+  }
+
+  // joint velocity limits as control box
+  Eigen::VectorXd control_min_constraint(control_dimension_);
+  Eigen::VectorXd control_max_constraint(control_dimension_);
+  for (int i = 0u; i < control_dimension_; ++i)
+  {
+    control_min_constraint(i) = predictive_configuration::joints_vel_min_limit_.at(i);
+    control_max_constraint(i) = predictive_configuration::joints_vel_max_limit_.at(i);
+  }
+
+  // core preallocate QP data, no allocation in control loop
+  mpc_core_ = createMpcCore(control_dimension_, horizon_);
+  mpc_core_->setWeights(lsq_state_weight_factors, lsq_control_weight_factors, 0.5);
+  mpc_core_->setControlLimits(control_min_constraint, control_max_constraint);
+
+  // each iteration add or remove single bound
+  const int max_iterations = 3 * control_dimension_ * horizon_ + predictive_configuration::max_num_iteration_;
+  mpc_core_->setSolverSettings(delta_t, max_iterations, predictive_configuration::kkt_tolerance_,
+                               predictive_configuration::warm_start_);
+
+  if (!mpc_core_->isSpecialized())
+  {
+    ROS_WARN("pd_condensed_qp_tracker: No compile time specialization for dof %d and horizon %d, "
+             "use runtime sized core",
+             control_dimension_, horizon_);
+  }
+
+  ROS_WARN("PD_CONDENSED_QP_TRACKER INITIALIZED!!");
+  return true;
+}
+
+// build and solve condensed QP
+bool pd_condensed_qp_tracker::solve(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& current_pose,
+                                    const Eigen::VectorXd& goal_pose, const double& collision_activation,
+                                    const double& collision_distance, const Eigen::VectorXd& terminal_control,
+                                    Eigen::VectorXd& control)
+{
+  mpc_core_->solve(Jacobian_Matrix, current_pose, goal_pose, collision_activation, collision_distance,
+                   terminal_control, control);
+  return checkStatus();
+}
+
+// build and solve condensed QP of linear time varying model
+bool pd_condensed_qp_tracker::solve(const std::vector<Eigen::MatrixXd>& stage_jacobians,
+                                    const Eigen::VectorXd& current_pose, const Eigen::VectorXd& goal_pose,
+                                    const double& collision_activation, const double& collision_distance,
+                                    const Eigen::VectorXd& terminal_control, Eigen::VectorXd& control)
+{
+  mpc_core_->solve(stage_jacobians, current_pose, goal_pose, collision_activation, collision_distance,
+                   terminal_control, control);
+  return checkStatus();
+}
+
+// report unexpected result of last solve
+bool pd_condensed_qp_tracker::checkStatus() const
+{
+  if (mpc_core_->getStatus() == MPC_CORE_MAX_ITERATIONS)
+  {
+    ROS_WARN("pd_condensed_qp_tracker::solve: Active set not converged after %d iterations",
+             mpc_core_->getNumIterations());
+  }
+  else if (mpc_core_->getStatus() == MPC_CORE_FAILED)
+  {
+    ROS_ERROR("pd_condensed_qp_tracker::solve: No usable solution");
+  }
+
+  return mpc_core_->getStatus() == MPC_CORE_CONVERGED;
+}
+
+void pd_condensed_qp_tracker::setDeadline(const double& time_budget)
+{
+  mpc_core_->setDeadline(time_budget);
+}
+
+void pd_condensed_qp_tracker::setStageControlLimits(const Eigen::VectorXd& min_limit, const Eigen::VectorXd& max_limit)
+{
+  mpc_core_->setStageControlLimits(min_limit, max_limit);
+}
+
+void pd_condensed_qp_tracker::getPredictedControls(Eigen::VectorXd& controls) const
+{
+  mpc_core_->getPredictedControls(controls);
+}
+
+int pd_condensed_qp_tracker::getNumIterations() const
+{
+  return mpc_core_->getNumIterations();
+}
+
+int pd_condensed_qp_tracker::getStatus() const
+{
+  return mpc_core_->getStatus();
+}
+
+bool pd_condensed_qp_tracker::isSpecialized() const
+{
+  return mpc_core_->isSpecialized();
+}
@@ -0,0 +1,147 @@
+
+// This file containts high rate output stage, interpolate predicted control trajectory between two solves
+
+#include <predictive_control/control_interpolator.h>
+
+ControlInterpolator::ControlInterpolator()
+{
+  degree_of_freedom_ = 0;
+  intervals_ = 0;
+  delta_t_ = 0.0;
+}
+
+ControlInterpolator::~ControlInterpolator()
+{
+  timer_.stop();
+  if (spinner_)
+  {
+    spinner_->stop();
+  }
+}
+
+// preallocate buffers, start interpolation timer on own callback queue
+bool ControlInterpolator::initialize(ros::NodeHandle& nh, const std::string& topic, const double& frequency,
+                                     const double& delta_t, const Eigen::VectorXd& min_velocity,
+                                     const Eigen::VectorXd& max_velocity, const int& intervals)
+{
+  if (frequency <= 0.0 || delta_t <= 0.0 || intervals <= 0 || min_velocity.size() != max_velocity.size())
+  {
+    ROS_ERROR("ControlInterpolator: Invalid frequency %f, interval duration %f or intervals %d", frequency, delta_t,
+              intervals);
+    return false;
+  }
+
+  degree_of_freedom_ = min_velocity.size();
+  intervals_ = intervals;
+  delta_t_ = delta_t;
+  min_velocity_ = min_velocity;
+  max_velocity_ = max_velocity;
+
+  ControlTrajectory trajectory;
+  trajectory.controls.setZero(degree_of_freedom_ * intervals_);
+  buffer_.initialize(trajectory);
+
+  velocity_.setZero(degree_of_freedom_);
+  command_.data.resize(degree_of_freedom_, 0.0);
+  command_buffer_.initialize(command_);
+
+  ros::NodeHandle interpolation_nh(nh);
+  interpolation_nh.setCallbackQueue(&callback_queue_);
+  command_pub_ = interpolation_nh.advertise<std_msgs::Float64MultiArray>(topic, 1);
+  timer_ = interpolation_nh.createTimer(ros::Duration(1.0 / frequency), &ControlInterpolator::interpolationCallBack,
+                                        this);
+
+  spinner_.reset(new ros::AsyncSpinner(1, &callback_queue_));
+  spinner_->start();
+
+  return true;
+}
+
+// hand over trajectory of latest solve
+void ControlInterpolator::setTrajectory(const ros::Time& stamp, const Eigen::VectorXd& controls)
+{
+  ControlTrajectory& trajectory = buffer_.getWriteBuffer();
+  const int size = std::min<int>(controls.size(), trajectory.controls.size());
+
+  trajectory.valid = true;
+  trajectory.stamp = stamp;
+  trajectory.controls.head(size) = controls.head(size);
+  trajectory.controls.tail(trajectory.controls.size() - size).setZero();
+  buffer_.publish();
+}
+
+// zero trajectory, interpolation command zero velocity
+void ControlInterpolator::stop(const ros::Time& stamp)
+{
+  ControlTrajectory& trajectory = buffer_.getWriteBuffer();
+  trajectory.valid = true;
+  trajectory.stamp = stamp;
+  trajectory.controls.setZero();
+  buffer_.publish();
+}
+
+// Catmull-Rom spline through v(k) at time k * delta_t, last control hold till end of last interval
+void ControlInterpolator::evaluate(const ControlTrajectory& trajectory, const double& time,
+                                   Eigen::VectorXd& velocity) const
+{
+  velocity.resize(degree_of_freedom_);
+
+  // trajectory exhausted, no newer solve available, stop manipulator
+  if (time >= intervals_ * delta_t_)
+  {
+    velocity.setZero();
+    return;
+  }
+
+  const double s = std::max(time, 0.0) / delta_t_;
+  const int k = std::min<int>(static_cast<int>(s), intervals_ - 1);
+  const double t = (k == intervals_ - 1) ? 0.0 : s - k;
+  const double t2 = t * t, t3 = t2 * t;
+
+  // neighbouring controls, repeated at both ends of trajectory
+  const int k0 = std::max(k - 1, 0), k2 = std::min(k + 1, intervals_ - 1), k3 = std::min(k + 2, intervals_ - 1);
+
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    const double p0 = trajectory.controls(k0 * degree_of_freedom_ + i);
+    const double p1 = trajectory.controls(k * degree_of_freedom_ + i);
+    const double p2 = trajectory.controls(k2 * degree_of_freedom_ + i);
+    const double p3 = trajectory.controls(k3 * degree_of_freedom_ + i);
+
+    const double value = 0.5 * (2.0 * p1 + (p2 - p0) * t + (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3) * t2 +
+                                (3.0 * p1 - p0 - 3.0 * p2 + p3) * t3);
+
+    // spline may overshoot between controls
+    velocity(i) = std::min(std::max(value, min_velocity_(i)), max_velocity_(i));
+  }
+}
+
+// publish interpolated command of latest trajectory
+void ControlInterpolator::interpolationCallBack(const ros::TimerEvent& event)
+{
+  buffer_.update();
+  const ControlTrajectory& trajectory = buffer_.getReadBuffer();
+
+  // nothing solved yet, leave command topic to controller
+  if (!trajectory.valid)
+  {
+    return;
+  }
+
+  evaluate(trajectory, (ros::Time::now() - trajectory.stamp).toSec(), velocity_);
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    command_.data[i] = velocity_(i);
+  }
+  command_pub_.publish(command_);
+
+  // same sized data, no allocation
+  command_buffer_.getWriteBuffer().data = command_.data;
+  command_buffer_.publish();
+}
+
+const std_msgs::Float64MultiArray& ControlInterpolator::getAppliedCommand()
+{
+  command_buffer_.update();
+  return command_buffer_.getReadBuffer();
+}
@@ -0,0 +1,359 @@
+
+#include <predictive_control/inverse_kinematic_engine.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+// maximum norm of joint step per iteration, rad
+static const double MAX_JOINT_STEP = 0.5;
+
+InverseKinematicEngine::InverseKinematicEngine()
+  : degree_of_freedom_(0)
+  , max_iterations_(100)
+  , damping_(0.05)
+  , tolerance_(1e-4)
+  , number_of_seeds_(1)
+  , random_generator_(std::mt19937::default_seed)
+  , job_goal_(NULL)
+  , job_seed_(NULL)
+  , job_(0)
+  , pending_workers_(0)
+  , running_(false)
+  , stop_(false)
+  , error_(std::numeric_limits<double>::infinity())
+  , num_iterations_(0)
+  , num_seeds_(0)
+{
+}
+
+InverseKinematicEngine::~InverseKinematicEngine()
+{
+  stopWorkers();
+}
+
+void InverseKinematicEngine::stopWorkers()
+{
+  {
+    boost::mutex::scoped_lock lock(pool_mutex_);
+    running_ = false;
+  }
+  job_condition_.notify_all();
+
+  for (auto const& thread : threads_)
+  {
+    thread->join();
+  }
+  threads_.clear();
+}
+
+bool InverseKinematicEngine::initialize(const KinematicEngine& engine, const std::vector<double>& min_limit,
+                                        const std::vector<double>& max_limit, const int& max_iterations,
+                                        const double& damping, const double& tolerance, const int& number_of_seeds,
+                                        const int& number_of_threads)
+{
+  // workers resized below, threads of previous initialize refer to them
+  stopWorkers();
+
+  degree_of_freedom_ = engine.getDegreeOfFreedom();
+  const int limits = std::min(min_limit.size(), max_limit.size());
+  if (degree_of_freedom_ == 0 || limits < degree_of_freedom_)
+  {
+    degree_of_freedom_ = 0;
+    return false;
+  }
+
+  max_iterations_ = std::max(max_iterations, 1);
+  damping_ = damping;
+  tolerance_ = tolerance;
+  number_of_seeds_ = std::max(number_of_seeds, 1);
+
+  min_limit_.resize(degree_of_freedom_);
+  max_limit_.resize(degree_of_freedom_);
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    min_limit_(i) = min_limit[i];
+    max_limit_(i) = max_limit[i];
+  }
+
+  // worker 0 always exists for warm start, more workers only used by parallel mode
+  const int workers = (number_of_seeds_ > 1) ? std::max(std::min(number_of_threads, number_of_seeds_ - 1), 1) : 1;
+  workers_.resize(workers);
+  for (int i = 0u; i < workers; ++i)
+  {
+    workers_[i].engine = engine;
+    workers_[i].engine.setIncremental(false, 0.0);
+    workers_[i].joints_angle.setZero(degree_of_freedom_);
+    workers_[i].best_joints_angle.setZero(degree_of_freedom_);
+    workers_[i].step.setZero(degree_of_freedom_);
+    workers_[i].result.setZero(degree_of_freedom_);
+    workers_[i].best_error = std::numeric_limits<double>::infinity();
+    workers_[i].result_error = std::numeric_limits<double>::infinity();
+    workers_[i].result_distance = std::numeric_limits<double>::infinity();
+    workers_[i].iterations = 0;
+    workers_[i].total_iterations = 0;
+    workers_[i].seeds_tried = 0;
+    workers_[i].converged = false;
+  }
+
+  seeds_.setZero(number_of_seeds_, degree_of_freedom_);
+
+  // worker 0 solved by caller, threads of other workers wait for job
+  job_ = 0;
+  pending_workers_ = 0;
+  running_ = true;
+  for (int i = 1u; i < workers; ++i)
+  {
+    threads_.push_back(boost::shared_ptr<boost::thread>(
+        new boost::thread(boost::bind(&InverseKinematicEngine::runWorker, this, i))));
+  }
+
+  return true;
+}
+
+bool InverseKinematicEngine::solve(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed,
+                                   Eigen::VectorXd& joints_angle)
+{
+  if (solveFromSeed(goal, seed, joints_angle) || number_of_seeds_ == 1)
+  {
+    return error_ <= tolerance_;
+  }
+
+  // keep warm started result if no random seed does better
+  const double warm_error = error_;
+  const int warm_iterations = num_iterations_;
+  const Eigen::VectorXd warm_joints_angle = joints_angle;
+
+  bool success = solveRandomSeeds(goal, seed, joints_angle);
+  num_iterations_ += warm_iterations;
+  num_seeds_ += 1;
+
+  if (!success && warm_error <= error_)
+  {
+    joints_angle = warm_joints_angle;
+    error_ = warm_error;
+  }
+
+  return success;
+}
+
+bool InverseKinematicEngine::solveFromSeed(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed,
+                                           Eigen::VectorXd& joints_angle)
+{
+  Worker& worker = workers_.front();
+  worker.joints_angle = seed.head(degree_of_freedom_);
+  clamp(worker.joints_angle);
+
+  iterate(goal, worker, NULL);
+
+  joints_angle = worker.best_joints_angle;
+  error_ = worker.best_error;
+  num_iterations_ = worker.iterations;
+  num_seeds_ = 1;
+
+  return worker.converged;
+}
+
+// uniform random seeds within limits, worker i solves seeds i, i + workers, ...
+bool InverseKinematicEngine::solveRandomSeeds(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed,
+                                              Eigen::VectorXd& joints_angle)
+{
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  for (int k = 0u; k < number_of_seeds_ - 1; ++k)
+  {
+    for (int i = 0u; i < degree_of_freedom_; ++i)
+    {
+      const bool limited = min_limit_(i) < max_limit_(i);
+      const double lower = limited ? min_limit_(i) : -M_PI;
+      const double upper = limited ? max_limit_(i) : M_PI;
+      seeds_(k, i) = lower + (upper - lower) * distribution(random_generator_);
+    }
+  }
+
+  // wake worker threads, solve seeds of worker 0 meanwhile and wait for the others
+  const int workers = workers_.size();
+  stop_.store(false, std::memory_order_relaxed);
+  {
+    boost::mutex::scoped_lock lock(pool_mutex_);
+    job_goal_ = &goal;
+    job_seed_ = &seed;
+    pending_workers_ = workers - 1;
+    ++job_;
+  }
+  job_condition_.notify_all();
+
+  solveSeeds(goal, seed, 0, &stop_);
+  {
+    boost::mutex::scoped_lock lock(pool_mutex_);
+    while (pending_workers_ > 0)
+    {
+      done_condition_.wait(lock);
+    }
+  }
+
+  // converged results first, among them closest to warm start
+  int best = 0;
+  num_seeds_ = 0;
+  num_iterations_ = 0;
+  for (int i = 0u; i < workers; ++i)
+  {
+    num_seeds_ += workers_[i].seeds_tried;
+    num_iterations_ += workers_[i].total_iterations;
+
+    const bool converged = workers_[i].result_error <= tolerance_;
+    const bool best_converged = workers_[best].result_error <= tolerance_;
+    if ((converged && (!best_converged || workers_[i].result_distance < workers_[best].result_distance)) ||
+        (!converged && !best_converged && workers_[i].result_error < workers_[best].result_error))
+    {
+      best = i;
+    }
+  }
+
+  joints_angle = workers_[best].result;
+  error_ = workers_[best].result_error;
+
+  return error_ <= tolerance_;
+}
+
+// worker keeps its converged result closest to warm start, else its smallest error
+void InverseKinematicEngine::solveSeeds(const Eigen::Isometry3d& goal, const Eigen::VectorXd& seed, const int index,
+                                        std::atomic<bool>* stop)
+{
+  Worker& worker = workers_[index];
+  worker.seeds_tried = 0;
+  worker.total_iterations = 0;
+  worker.result_error = std::numeric_limits<double>::infinity();
+  worker.result_distance = std::numeric_limits<double>::infinity();
+
+  for (int k = index; k < number_of_seeds_ - 1 && !stop->load(std::memory_order_relaxed); k += workers_.size())
+  {
+    worker.joints_angle = seeds_.row(k).transpose();
+    iterate(goal, worker, stop);
+    ++worker.seeds_tried;
+    worker.total_iterations += worker.iterations;
+
+    const double distance = (worker.best_joints_angle - seed).norm();
+    const bool result_converged = worker.result_error <= tolerance_;
+    if ((worker.converged && (!result_converged || distance < worker.result_distance)) ||
+        (!worker.converged && !result_converged && worker.best_error < worker.result_error))
+    {
+      worker.result = worker.best_joints_angle;
+      worker.result_error = worker.best_error;
+      worker.result_distance = distance;
+    }
+
+    if (worker.converged)
+    {
+      stop->store(true, std::memory_order_relaxed);
+    }
+  }
+}
+
+void InverseKinematicEngine::runWorker(const int index)
+{
+  int job = 0u;
+  for (;;)
+  {
+    const Eigen::Isometry3d* goal;
+    const Eigen::VectorXd* seed;
+    {
+      boost::mutex::scoped_lock lock(pool_mutex_);
+      while (running_ && job_ == job)
+      {
+        job_condition_.wait(lock);
+      }
+
+      if (!running_)
+      {
+        return;
+      }
+
+      job = job_;
+      goal = job_goal_;
+      seed = job_seed_;
+    }
+
+    solveSeeds(*goal, *seed, index, &stop_);
+
+    {
+      boost::mutex::scoped_lock lock(pool_mutex_);
+      --pending_workers_;
+    }
+    done_condition_.notify_one();
+  }
+}
+
+// damped least squares iterations, best iterate kept because clamping can increase error
+void InverseKinematicEngine::iterate(const Eigen::Isometry3d& goal, Worker& worker,
+                                     const std::atomic<bool>* stop) const
+{
+  worker.best_error = std::numeric_limits<double>::infinity();
+  worker.iterations = 0;
+  worker.converged = false;
+
+  const double damping_squared = damping_ * damping_;
+  for (int iteration = 0u;; ++iteration)
+  {
+    const KinematicEngine::JacobianMatrix& jacobian = worker.engine.calculateJacobian(worker.joints_angle);
+    calculatePoseError(goal, worker.engine.getEndEffectorPose(), worker.error);
+
+    const double error = worker.error.norm();
+    if (error < worker.best_error)
+    {
+      worker.best_error = error;
+      worker.best_joints_angle = worker.joints_angle;
+    }
+
+    if (error <= tolerance_)
+    {
+      worker.converged = true;
+      return;
+    }
+
+    if (iteration >= max_iterations_ || (stop && stop->load(std::memory_order_relaxed)))
+    {
+      return;
+    }
+
+    // dq = J^T (J J^T + lambda^2 I)^-1 e
+    worker.system.noalias() = jacobian * jacobian.transpose();
+    worker.system.diagonal().array() += damping_squared;
+    worker.ldlt.compute(worker.system);
+    worker.weighted_error = worker.ldlt.solve(worker.error);
+    worker.step.noalias() = jacobian.transpose() * worker.weighted_error;
+
+    const double step_norm = worker.step.norm();
+    if (step_norm > MAX_JOINT_STEP)
+    {
+      worker.step *= MAX_JOINT_STEP / step_norm;
+    }
+
+    worker.joints_angle += worker.step;
+    clamp(worker.joints_angle);
+    ++worker.iterations;
+  }
+}
+
+// rotation error as rotation vector of R_goal * R^T, relative to chain root as angular part of Jacobian
+void InverseKinematicEngine::calculatePoseError(const Eigen::Isometry3d& goal, const Eigen::Isometry3d& current,
+                                                ErrorVector& error)
+{
+  error.head<3>() = goal.translation() - current.translation();
+
+  const Eigen::AngleAxisd rotation(goal.linear() * current.linear().transpose());
+  error.tail<3>() = rotation.angle() * rotation.axis();
+}
+
+void InverseKinematicEngine::clamp(Eigen::VectorXd& joints_angle) const
+{
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    if (min_limit_(i) < max_limit_(i))
+    {
+      joints_angle(i) = std::min(std::max(joints_angle(i), min_limit_(i)), max_limit_(i));
+    }
+  }
+}
@@ -8,6 +8,8 @@
 Kinematic_calculations::Kinematic_calculations()
 {
   segments_ = 7;
+  first_changed_segment_ = 0;
+  engine_poses_copied_ = false;
   clearDataMember();
 }
 
@@ -58,6 +60,25 @@ bool Kinematic_calculations::initialize(const std::string rbt_description)
   this->initializeDataMember(chain);
   this->initializeLimitParameter(model);
 
+  if (!this->initializeKinematicEngine(chain, model))
+  {
+    ROS_ERROR("Failed to initialize kinematic engine");
+    return false;
+  }
+
+  if (!this->initializeRigidBodyDynamics(chain))
+  {
+    ROS_ERROR("Failed to initialize rigid body dynamics");
+    return false;
+  }
+
+  this->initializeKDLSolver(chain);
+
+  if (predictive_configuration::kinematic_backend_ == "generated")
+  {
+    this->initializeGeneratedKinematics();
+  }
+
   ROS_WARN("KINEMATIC CALCULATION INTIALIZED!!");
   return true;
 }
@@ -169,9 +190,9 @@ void Kinematic_calculations::initializeLimitParameter(const urdf::Model& model)
     for (int i = 0u; i < predictive_configuration::degree_of_freedom_; ++i)
     {
       predictive_configuration::joints_effort_min_limit_[i] =
-          model.getJoint(predictive_configuration::joints_name_.at(i)).get()->limits->effort - 0.1;
+          -model.getJoint(predictive_configuration::joints_name_.at(i)).get()->limits->effort;
       predictive_configuration::joints_effort_max_limit_[i] =
-          model.getJoint(predictive_configuration::joints_name_.at(i)).get()->limits->effort + 0.1;
+          model.getJoint(predictive_configuration::joints_name_.at(i)).get()->limits->effort;
     }
     predictive_configuration::set_effort_constraints_ = true;
 
@@ -200,6 +221,128 @@ void Kinematic_calculations::initializeLimitParameter(const urdf::Model& model)
   }
 }
 
+// build isometry engine, joint axis taken from urdf model in order of joints_name_
+bool Kinematic_calculations::initializeKinematicEngine(const KDL::Chain& chain, const urdf::Model& model)
+{
+  kinematic_engine_.reset(new KinematicEngine());
+
+  for (int i = 0u, revolute_joint_number = 0u; i < segments_; ++i)
+  {
+    const KDL::Frame& frame = chain.getSegment(i).getFrameToTip();
+    Eigen::Isometry3d frame_to_tip = Eigen::Isometry3d::Identity();
+    for (unsigned int j = 0; j < 9; ++j)
+    {
+      frame_to_tip.matrix()(j / 3, j % 3) = frame.M.data[j];
+    }
+    frame_to_tip.translation() = Eigen::Vector3d(frame.p.x(), frame.p.y(), frame.p.z());
+
+    // fixed joints
+    if (chain.getSegment(i).getJoint().getType() == KDL::Joint::None)
+    {
+      kinematic_engine_->addFixedSegment(frame_to_tip);
+      continue;
+    }
+
+    // revolute joints
+    if (chain.getSegment(i).getJoint().getType() > KDL::Joint::RotZ ||
+        revolute_joint_number >= predictive_configuration::degree_of_freedom_)
+    {
+      ROS_ERROR("initializeKinematicEngine: Unsupported joint of segment %s", chain.getSegment(i).getName().c_str());
+      return false;
+    }
+
+    const urdf::Vector3& joint_axis =
+        model.getJoint(predictive_configuration::joints_name_.at(revolute_joint_number)).get()->axis;
+    if (!kinematic_engine_->addRevoluteSegment(frame_to_tip, Eigen::Vector3d(joint_axis.x, joint_axis.y, joint_axis.z)))
+    {
+      ROS_ERROR("initializeKinematicEngine: Invalid joint axis of segment %s", chain.getSegment(i).getName().c_str());
+      return false;
+    }
+    ++revolute_joint_number;
+  }
+
+  kinematic_engine_->setIncremental(predictive_configuration::use_incremental_kinematics_,
+                                    predictive_configuration::incremental_kinematics_epsilon_);
+  engine_poses_copied_ = false;
+
+  inverse_kinematic_engine_.reset(new InverseKinematicEngine());
+  if (!inverse_kinematic_engine_->initialize(
+          *kinematic_engine_, predictive_configuration::joints_min_limit_, predictive_configuration::joints_max_limit_,
+          predictive_configuration::ik_max_iterations_, predictive_configuration::ik_damping_,
+          predictive_configuration::ik_tolerance_, predictive_configuration::ik_number_of_seeds_,
+          predictive_configuration::ik_number_of_threads_))
+  {
+    ROS_ERROR("initializeKinematicEngine: Failed to initialize inverse kinematic engine");
+    return false;
+  }
+
+  batch_kinematic_engine_.reset(new BatchKinematicEngine());
+  return batch_kinematic_engine_->initialize(*kinematic_engine_);
+}
+
+// segment inertial of kdl chain is relative to segment tip frame, rotational inertia about its origin
+bool Kinematic_calculations::initializeRigidBodyDynamics(const KDL::Chain& chain)
+{
+  std::vector<double> masses(segments_);
+  std::vector<Eigen::Vector3d> centers_of_mass(segments_);
+  std::vector<Eigen::Matrix3d> inertias(segments_);
+
+  for (int i = 0u; i < segments_; ++i)
+  {
+    const KDL::RigidBodyInertia& inertial = chain.getSegment(i).getInertia();
+    const KDL::Vector& cog = inertial.getCOG();
+    const KDL::RotationalInertia rotational_inertia = inertial.getRotationalInertia();
+
+    masses[i] = inertial.getMass();
+    centers_of_mass[i] = Eigen::Vector3d(cog.x(), cog.y(), cog.z());
+    for (unsigned int j = 0; j < 9; ++j)
+    {
+      inertias[i](j / 3, j % 3) = rotational_inertia.data[j];
+    }
+
+    // parallel axis theorem, inertia about center of mass
+    inertias[i] -= masses[i] * (centers_of_mass[i].squaredNorm() * Eigen::Matrix3d::Identity() -
+                                centers_of_mass[i] * centers_of_mass[i].transpose());
+  }
+
+  rigid_body_dynamics_.reset(new RigidBodyDynamics());
+  return rigid_body_dynamics_->initialize(*kinematic_engine_, masses, centers_of_mass, inertias);
+}
+
+// kdl solvers keep reference of chain, construct them once chain is final
+void Kinematic_calculations::initializeKDLSolver(const KDL::Chain& chain)
+{
+  jacobian_solver_.reset(new KDL::ChainJntToJacSolver(chain));
+  kdl_joints_value_.resize(chain.getNrOfJoints());
+  kdl_jacobian_.resize(chain.getNrOfJoints());
+  kdl_frame_ = KDL::Frame::Identity();
+}
+
+// generated code is exported for one chain, use it only if it matches configured chain
+bool Kinematic_calculations::initializeGeneratedKinematics()
+{
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+  if (GeneratedKinematics::getDegreeOfFreedom() == predictive_configuration::degree_of_freedom_ &&
+      GeneratedKinematics::getNumberOfSegments() == segments_ &&
+      predictive_configuration::chain_base_link_ == GeneratedKinematics::getChainBaseLink() &&
+      predictive_configuration::chain_tip_link_ == GeneratedKinematics::getChainTipLink())
+  {
+    generated_segment_poses_.resize(16 * segments_, 0.0);
+    return true;
+  }
+
+  ROS_WARN("initializeGeneratedKinematics: Generated kinematics of chain '%s' - '%s' does not match configured chain, "
+           "use 'isometry' kinematic backend",
+           GeneratedKinematics::getChainBaseLink(), GeneratedKinematics::getChainTipLink());
+#else
+  ROS_WARN("initializeGeneratedKinematics: Build without generated kinematics (USE_GENERATED_KINEMATICS), use "
+           "'isometry' kinematic backend");
+#endif
+
+  predictive_configuration::kinematic_backend_ = "isometry";
+  return false;
+}
+
 // generate rotation matrix using joint angle and axis of rotation
 /// Note: if angle value has less floating point accuracy than gives wrong answers like wrong 1.57, correct
 /// 1.57079632679.
@@ -247,6 +390,26 @@ void Kinematic_calculations::generateTransformationMatrixFromJointValues(const u
 // calculate end effector pose using joint angles
 void Kinematic_calculations::calculateForwardKinematics(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix)
 {
+  if (predictive_configuration::kinematic_backend_ == "isometry")
+  {
+    calculateForwardKinematicsUsingIsometryEngine(joints_angle, FK_Matrix);
+    return;
+  }
+
+  if (predictive_configuration::kinematic_backend_ == "kdl")
+  {
+    calculateForwardKinematicsUsingKDLSolver(joints_angle, FK_Matrix);
+    return;
+  }
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+  if (predictive_configuration::kinematic_backend_ == "generated")
+  {
+    calculateForwardKinematicsUsingGeneratedCode(joints_angle, FK_Matrix);
+    return;
+  }
+#endif
+
   // initialize local member and parameters
   FK_Matrix = Eigen::Matrix4d::Identity();
   Eigen::MatrixXd till_joint_FK_Matrix = Eigen::Matrix4d::Identity();
@@ -294,6 +457,8 @@ void Kinematic_calculations::calculateForwardKinematics(const Eigen::VectorXd& j
 
   // take last segment value that is FK Matrix
   FK_Matrix = FK_Homogenous_Matrix_[segments_ - 1];
+  first_changed_segment_ = 0;
+  engine_poses_copied_ = false;
 
   if (predictive_configuration::activate_output_)
   {
@@ -306,6 +471,26 @@ void Kinematic_calculations::calculateForwardKinematics(const Eigen::VectorXd& j
 void Kinematic_calculations::calculateJacobianMatrix(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& FK_Matrix,
                                                      Eigen::MatrixXd& Jacobian_Matrix)
 {
+  if (predictive_configuration::kinematic_backend_ == "isometry")
+  {
+    calculateJacobianMatrixUsingIsometryEngine(joints_angle, FK_Matrix, Jacobian_Matrix);
+    return;
+  }
+
+  if (predictive_configuration::kinematic_backend_ == "kdl")
+  {
+    calculateJacobianMatrixUsingKDLSolver(joints_angle, FK_Matrix, Jacobian_Matrix);
+    return;
+  }
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+  if (predictive_configuration::kinematic_backend_ == "generated")
+  {
+    calculateJacobianMatrixUsingGeneratedCode(joints_angle, FK_Matrix, Jacobian_Matrix);
+    return;
+  }
+#endif
+
   // initialize paramters and local variables
   const int jacobian_matrix_rows = 6, jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
   FK_Matrix = Eigen::Matrix4d::Identity();
@@ -412,85 +597,194 @@ void Kinematic_calculations::calculateJacobianMatrix(const Eigen::VectorXd& join
   }
 }
 
-// calculate end effector pose using joint angles by using standard kdl pose recursive solver
-void Kinematic_calculations::calculateForwardKinematicsUsingKDLSolver(const Eigen::VectorXd& joints_angle,
-                                                                      Eigen::MatrixXd& FK_Matrix)
+// calculate end effector pose using isometry engine, no allocation once matrices have right size
+void Kinematic_calculations::calculateForwardKinematicsUsingIsometryEngine(const Eigen::VectorXd& joints_angle,
+                                                                           Eigen::MatrixXd& FK_Matrix)
 {
-  FK_Matrix = Eigen::Matrix4d::Identity();
-  KDL::Frame frame = KDL::Frame::Identity();
-  KDL::JntArray joints_value;  //= KDL::JntArray::resize(joints_angle.size())
-  joints_value.data = joints_angle;
+  FK_Matrix = kinematic_engine_->calculateForwardKinematics(joints_angle).matrix();
 
-  ROS_INFO_STREAM("Forward Kinematics using KDL recursive solver with joint values: ");
-  ROS_INFO_STREAM(joints_angle.transpose());
-
-  // compute tf transformation between root frame and base link of manipulator
-  if (predictive_configuration::chain_root_link_ != predictive_configuration::chain_base_link_)
+  // segment poses used by collision detection, only dirty range changed
+  first_changed_segment_ = engine_poses_copied_ ? kinematic_engine_->getFirstChangedSegment() : 0;
+  for (int i = first_changed_segment_; i < segments_; ++i)
   {
-    ROS_WARN("'%s' and '%s' are not same frame", chain_root_link_.c_str(), chain_base_link_.c_str());
+    FK_Homogenous_Matrix_[i] = kinematic_engine_->getSegmentPose(i).matrix();
   }
+  engine_poses_copied_ = true;
+}
 
-  // kdl recursive solver to determine end effoctor position by given joint angle
-  KDL::ChainFkSolverPos_recursive pose_recursive_solver(chain);
-  int success_state = pose_recursive_solver.JntToCart(joints_value, frame);
+// calculate end effector pose and Jacobian using isometry engine, no allocation once matrices have right size
+void Kinematic_calculations::calculateJacobianMatrixUsingIsometryEngine(const Eigen::VectorXd& joints_angle,
+                                                                        Eigen::MatrixXd& FK_Matrix,
+                                                                        Eigen::MatrixXd& Jacobian_Matrix)
+{
+  Jacobian_Matrix = kinematic_engine_->calculateJacobian(joints_angle);
+  FK_Matrix = kinematic_engine_->getEndEffectorPose().matrix();
 
-  // success_state < 0 something went wrong
-  if (success_state < 0)
+  // segment poses used by collision detection, only dirty range changed
+  first_changed_segment_ = engine_poses_copied_ ? kinematic_engine_->getFirstChangedSegment() : 0;
+  for (int i = first_changed_segment_; i < segments_; ++i)
   {
-    ROS_ERROR("calculateForwardKinematicsUsingKDLSolver: Failed to compute forward kinematic using recursive solver");
+    FK_Homogenous_Matrix_[i] = kinematic_engine_->getSegmentPose(i).matrix();
   }
-  else
+  engine_poses_copied_ = true;
+}
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+// calculate end effector pose using closed form generated code, no allocation once matrices have right size
+void Kinematic_calculations::calculateForwardKinematicsUsingGeneratedCode(const Eigen::VectorXd& joints_angle,
+                                                                          Eigen::MatrixXd& FK_Matrix)
+{
+  GeneratedKinematics::calculateForwardKinematics(joints_angle.data(), generated_segment_poses_.data());
+
+  // segment poses used by collision detection
+  for (int i = 0u; i < segments_; ++i)
   {
-    ROS_INFO("calculateForwardKinematicsUsingKDLSolver: Successed to compute forward kinematic using recursive solver");
-    transformKDLToEigenMatrix(frame, FK_Matrix);
+    FK_Homogenous_Matrix_[i] = Eigen::Map<const Eigen::Matrix4d>(generated_segment_poses_.data() + 16 * i);
   }
+  FK_Matrix = FK_Homogenous_Matrix_[segments_ - 1];
+  first_changed_segment_ = 0;
+  engine_poses_copied_ = false;
 }
 
-// calculate diffrential velocity (linear and angular) called Jacobian Matrix by using standard kdl pose recursive
-// solver
-void Kinematic_calculations::calculateJacobianMatrixUsingKDLSolver(const Eigen::VectorXd& joints_angle,
-                                                                   Eigen::MatrixXd& FK_Matrix,
-                                                                   Eigen::MatrixXd& Jacobian_Matrix)
+// calculate end effector pose and Jacobian using closed form generated code, no allocation once matrices have right
+// size
+void Kinematic_calculations::calculateJacobianMatrixUsingGeneratedCode(const Eigen::VectorXd& joints_angle,
+                                                                       Eigen::MatrixXd& FK_Matrix,
+                                                                       Eigen::MatrixXd& Jacobian_Matrix)
 {
-  // initialize paramters and local variables
-  const int jacobian_matrix_rows = 6, jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
-  FK_Matrix = Eigen::Matrix4d::Identity();
-  Jacobian_Matrix.resize(jacobian_matrix_rows, jacobian_matrix_columns);
-  KDL::Frame frame = KDL::Frame::Identity();
-  KDL::Jacobian KDL_Jacobian = KDL::Jacobian(predictive_configuration::degree_of_freedom_);
-  KDL::JntArray joints_value;
-  joints_value.data = joints_angle;
+  Jacobian_Matrix.resize(6, predictive_configuration::degree_of_freedom_);
+  GeneratedKinematics::calculateJacobian(joints_angle.data(), generated_segment_poses_.data(), Jacobian_Matrix.data());
 
-  ROS_INFO_STREAM("Forward Kinematics using KDL recursive solver with joint values: ");
-  ROS_INFO_STREAM(joints_angle.transpose());
+  // segment poses used by collision detection
+  for (int i = 0u; i < segments_; ++i)
+  {
+    FK_Homogenous_Matrix_[i] = Eigen::Map<const Eigen::Matrix4d>(generated_segment_poses_.data() + 16 * i);
+  }
+  FK_Matrix = FK_Homogenous_Matrix_[segments_ - 1];
+  first_changed_segment_ = 0;
+  engine_poses_copied_ = false;
+}
+#endif
 
-  // compute tf transformation between root frame and base link of manipulator
-  if (predictive_configuration::chain_root_link_ != predictive_configuration::chain_base_link_)
+// time derivative of Jacobian, Jdot * joint velocity is acceleration part independent of joint acceleration
+void Kinematic_calculations::calculateJacobianDerivative(const Eigen::VectorXd& joints_angle,
+                                                         const Eigen::VectorXd& joints_velocity,
+                                                         Eigen::MatrixXd& Jacobian_Derivative)
+{
+  Jacobian_Derivative = kinematic_engine_->calculateJacobianDerivative(joints_angle, joints_velocity);
+}
+
+// derivative of Jacobian with respect to each joint value, curvature of kinematic map
+void Kinematic_calculations::calculateJacobianHessian(const Eigen::VectorXd& joints_angle,
+                                                      std::vector<Eigen::MatrixXd>& Jacobian_Hessian)
+{
+  const KinematicEngine::JacobianVector& hessian = kinematic_engine_->calculateJacobianHessian(joints_angle);
+  const int joints = hessian.size();
+  Jacobian_Hessian.resize(joints);
+  for (int j = 0u; j < joints; ++j)
   {
-    ROS_WARN("'%s' and '%s' are not same frame", chain_root_link_.c_str(), chain_base_link_.c_str());
+    Jacobian_Hessian[j] = hessian[j];
   }
+}
 
-  // kdl recursive solver to determine end effoctor position by given joint angle
-  KDL::ChainFkSolverPos_recursive pose_recursive_solver(chain);
-  int fk_success_state = pose_recursive_solver.JntToCart(joints_value, frame);
+// damped least squares inverse kinematics, goal given as homogeneous matrix like forward kinematics result
+bool Kinematic_calculations::calculateInverseKinematics(const Eigen::MatrixXd& FK_Matrix, const Eigen::VectorXd& seed,
+                                                        Eigen::VectorXd& joints_angle)
+{
+  Eigen::Isometry3d goal = Eigen::Isometry3d::Identity();
+  goal.linear() = FK_Matrix.block<3, 3>(0, 0);
+  goal.translation() = FK_Matrix.block<3, 1>(0, 3);
 
-  // kdl recursive solver to determine jacobian matrix by given joint angle
-  KDL::ChainJntToJacSolver jacobian_solver(chain);
-  int success_state = jacobian_solver.JntToJac(joints_value, KDL_Jacobian);
+  return inverse_kinematic_engine_->solve(goal, seed, joints_angle);
+}
 
-  // success_state < 0 something went wrong
-  if (success_state < 0 || fk_success_state < 0)
+// composite rigid body algorithm, allocation free after first call
+void Kinematic_calculations::calculateMassMatrix(const Eigen::VectorXd& joints_angle, Eigen::MatrixXd& Mass_Matrix)
+{
+  Mass_Matrix = rigid_body_dynamics_->calculateMassMatrix(joints_angle);
+}
+
+// recursive Newton-Euler algorithm
+void Kinematic_calculations::calculateInverseDynamics(const Eigen::VectorXd& joints_angle,
+                                                      const Eigen::VectorXd& joints_velocity,
+                                                      const Eigen::VectorXd& joints_acceleration,
+                                                      Eigen::VectorXd& joints_effort)
+{
+  joints_effort = rigid_body_dynamics_->calculateInverseDynamics(joints_angle, joints_velocity, joints_acceleration);
+}
+
+// recursive Newton-Euler algorithm with zero joint acceleration
+void Kinematic_calculations::calculateBiasEffort(const Eigen::VectorXd& joints_angle,
+                                                 const Eigen::VectorXd& joints_velocity, Eigen::VectorXd& joints_effort)
+{
+  joints_effort = rigid_body_dynamics_->calculateBiasEffort(joints_angle, joints_velocity);
+}
+
+// calculate segment poses of many joint configurations, one configuration per row
+const BatchKinematicEngine& Kinematic_calculations::calculateForwardKinematicsBatch(const Eigen::MatrixXd& joints_angle)
+{
+  batch_kinematic_engine_->calculateForwardKinematics(joints_angle);
+  return *batch_kinematic_engine_;
+}
+
+// calculate segment poses and Jacobian of many joint configurations, one configuration per row
+const BatchKinematicEngine& Kinematic_calculations::calculateJacobianMatrixBatch(const Eigen::MatrixXd& joints_angle)
+{
+  batch_kinematic_engine_->calculateJacobian(joints_angle);
+  return *batch_kinematic_engine_;
+}
+
+// calculate end effector pose using joint angles by chaining kdl segment poses, no allocation once matrices have right
+// size
+void Kinematic_calculations::calculateForwardKinematicsUsingKDLSolver(const Eigen::VectorXd& joints_angle,
+                                                                      Eigen::MatrixXd& FK_Matrix)
+{
+  if (joints_angle.size() != static_cast<int>(kdl_joints_value_.rows()))
   {
-    ROS_ERROR("calculateJacobianMatrixUsingKDLSolver: Failed to compute forward kinematic or Jacobian matrix using "
-              "recursive solver");
+    ROS_ERROR("calculateForwardKinematicsUsingKDLSolver: Joint angles size does not match kdl chain");
+    return;
   }
-  else
+  kdl_joints_value_.data = joints_angle;
+
+  // segment poses used by collision detection, single pass over chain same as kdl recursive solver, pose of each
+  // segment kept instead of solving again till every segment
+  const int segments = segments_;
+  kdl_frame_ = KDL::Frame::Identity();
+  for (int i = 0u, joint = 0u; i < segments; ++i)
   {
-    ROS_INFO("calculateJacobianMatrixUsingKDLSolver: Successed to compute forward kinematic and Jacobian matrix using "
-             "recursive solver");
-    transformKDLToEigenMatrix(frame, FK_Matrix);
-    Jacobian_Matrix = KDL_Jacobian.data;
+    const KDL::Segment& segment = chain.getSegment(i);
+    if (segment.getJoint().getType() != KDL::Joint::None)
+    {
+      kdl_frame_ = kdl_frame_ * segment.pose(kdl_joints_value_(joint++));
+    }
+    else
+    {
+      kdl_frame_ = kdl_frame_ * segment.pose(0.0);
+    }
+    transformKDLToEigenMatrix(kdl_frame_, FK_Homogenous_Matrix_[i]);
+  }
+
+  FK_Matrix = FK_Homogenous_Matrix_[segments_ - 1];
+  first_changed_segment_ = 0;
+  engine_poses_copied_ = false;
+}
+
+// calculate diffrential velocity (linear and angular) called Jacobian Matrix by using cached kdl recursive solvers, no
+// allocation once matrices have right size
+void Kinematic_calculations::calculateJacobianMatrixUsingKDLSolver(const Eigen::VectorXd& joints_angle,
+                                                                   Eigen::MatrixXd& FK_Matrix,
+                                                                   Eigen::MatrixXd& Jacobian_Matrix)
+{
+  calculateForwardKinematicsUsingKDLSolver(joints_angle, FK_Matrix);
+
+  // kdl recursive solver to determine jacobian matrix by given joint angle
+  if (jacobian_solver_->JntToJac(kdl_joints_value_, kdl_jacobian_) < 0)
+  {
+    ROS_ERROR("calculateJacobianMatrixUsingKDLSolver: Failed to compute Jacobian matrix using recursive solver");
+    return;
   }
+
+  Jacobian_Matrix = kdl_jacobian_.data;
 }
 
 // calculate inverse of Jacobian matrix using Singular value decomposition
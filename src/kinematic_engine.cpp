@@ -0,0 +1,256 @@
+// This file containts allocation free forward kinematic and Jacobian engine of serial chain with revolute joints
+
+#include <predictive_control/kinematic_engine.h>
+
+#include <cmath>
+
+KinematicEngine::KinematicEngine() : incremental_(false), epsilon_(0.0)
+{
+  clear();
+}
+
+// remove all segments
+void KinematicEngine::clear()
+{
+  degree_of_freedom_ = 0;
+  frames_to_tip_.clear();
+  joint_types_.clear();
+  axis_index_.clear();
+  axis_sign_.clear();
+  axes_.clear();
+  joint_index_.clear();
+  segment_poses_.clear();
+  jacobian_.resize(6, 0);
+  joint_origins_.resize(3, 0);
+  jacobian_derivative_.resize(6, 0);
+  jacobian_hessian_.clear();
+  cached_joints_angle_.resize(0);
+  poses_valid_ = false;
+  jacobian_valid_ = false;
+  first_changed_segment_ = 0;
+}
+
+void KinematicEngine::setIncremental(const bool& incremental, const double& epsilon)
+{
+  incremental_ = incremental;
+  epsilon_ = epsilon;
+  poses_valid_ = false;
+  jacobian_valid_ = false;
+}
+
+// segment without joint value
+void KinematicEngine::addFixedSegment(const Eigen::Isometry3d& frame_to_tip)
+{
+  frames_to_tip_.push_back(frame_to_tip);
+  joint_types_.push_back(KINEMATIC_JOINT_FIXED);
+  axis_index_.push_back(0);
+  axis_sign_.push_back(1.0);
+  axes_.push_back(Eigen::Vector3d::UnitZ());
+  joint_index_.push_back(-1);
+  segment_poses_.push_back(Eigen::Isometry3d::Identity());
+  poses_valid_ = false;
+  jacobian_valid_ = false;
+}
+
+// segment with revolute joint, axis aligned joints are detected and stored as index and sign
+bool KinematicEngine::addRevoluteSegment(const Eigen::Isometry3d& frame_to_tip, const Eigen::Vector3d& axis)
+{
+  const double norm = axis.norm();
+  if (norm < 1e-12 || degree_of_freedom_ >= MAX_DOF)
+  {
+    return false;
+  }
+
+  const Eigen::Vector3d unit_axis = axis / norm;
+  int index = 0;
+  unit_axis.cwiseAbs().maxCoeff(&index);
+  const bool axis_aligned = std::fabs(std::fabs(unit_axis(index)) - 1.0) < 1e-12;
+
+  frames_to_tip_.push_back(frame_to_tip);
+  joint_types_.push_back(axis_aligned ? KINEMATIC_JOINT_ROT_AXIS : KINEMATIC_JOINT_ROT_ANY);
+  axis_index_.push_back(index);
+  axis_sign_.push_back(unit_axis(index) < 0.0 ? -1.0 : 1.0);
+  axes_.push_back(unit_axis);
+  joint_index_.push_back(degree_of_freedom_);
+  segment_poses_.push_back(Eigen::Isometry3d::Identity());
+
+  ++degree_of_freedom_;
+  jacobian_.setZero(6, degree_of_freedom_);
+  joint_origins_.setZero(3, degree_of_freedom_);
+  jacobian_derivative_.setZero(6, degree_of_freedom_);
+  jacobian_hessian_.assign(degree_of_freedom_, jacobian_);
+  cached_joints_angle_.setZero(degree_of_freedom_);
+  poses_valid_ = false;
+  jacobian_valid_ = false;
+  return true;
+}
+
+// pose of all segment tips, chain composed from root to tip, incremental mode starts at first changed joint
+const Eigen::Isometry3d& KinematicEngine::calculateForwardKinematics(const Eigen::VectorXd& joints_angle)
+{
+  const int segments = frames_to_tip_.size();
+  int start = 0;
+  if (incremental_ && poses_valid_)
+  {
+    start = segments;
+    for (int i = 0u; i < segments; ++i)
+    {
+      if (joint_index_[i] >= 0 &&
+          std::fabs(joints_angle(joint_index_[i]) - cached_joints_angle_(joint_index_[i])) > epsilon_)
+      {
+        start = i;
+        break;
+      }
+    }
+  }
+
+  first_changed_segment_ = start;
+  if (start == segments)
+  {
+    return segment_poses_.back();
+  }
+
+  // only joints of dirty range are cached, unchanged joints keep value their poses computed with
+  for (int i = start; i < segments; ++i)
+  {
+    if (joint_index_[i] >= 0)
+    {
+      cached_joints_angle_(joint_index_[i]) = joints_angle(joint_index_[i]);
+    }
+  }
+  poses_valid_ = true;
+  jacobian_valid_ = false;
+
+  Eigen::Isometry3d pose = (start == 0) ? Eigen::Isometry3d::Identity() : segment_poses_[start - 1];
+
+  for (int i = start; i < segments; ++i)
+  {
+    pose = pose * frames_to_tip_[i];
+
+    if (joint_types_[i] == KINEMATIC_JOINT_ROT_AXIS)
+    {
+      // rotation about axis k only mix other two columns of rotation matrix
+      const double angle = axis_sign_[i] * joints_angle(joint_index_[i]);
+      const double c = std::cos(angle), s = std::sin(angle);
+      const int a = (axis_index_[i] + 1) % 3, b = (axis_index_[i] + 2) % 3;
+
+      const Eigen::Vector3d column_a = pose.linear().col(a);
+      const Eigen::Vector3d column_b = pose.linear().col(b);
+      pose.linear().col(a) = c * column_a + s * column_b;
+      pose.linear().col(b) = c * column_b - s * column_a;
+    }
+
+    else if (joint_types_[i] == KINEMATIC_JOINT_ROT_ANY)
+    {
+      pose.linear() = pose.linear() * Eigen::AngleAxisd(joints_angle(joint_index_[i]), axes_[i]).toRotationMatrix();
+    }
+
+    segment_poses_[i] = pose;
+  }
+
+  return segment_poses_.back();
+}
+
+// geometric Jacobian, column of revolute joint [z x (p - p_i); z], reused while no pose changed
+// Modelling and Control of Robot Manipulators by L. Sciavicco and B. Siciliano
+const KinematicEngine::JacobianMatrix& KinematicEngine::calculateJacobian(const Eigen::VectorXd& joints_angle)
+{
+  const Eigen::Vector3d p = calculateForwardKinematics(joints_angle).translation();
+  if (jacobian_valid_)
+  {
+    return jacobian_;
+  }
+
+  const int segments = frames_to_tip_.size();
+  for (int i = 0u; i < segments; ++i)
+  {
+    if (joint_types_[i] == KINEMATIC_JOINT_FIXED)
+    {
+      continue;
+    }
+
+    // joint axis relative to root, rotation about axis does not change it
+    Eigen::Vector3d z;
+    if (joint_types_[i] == KINEMATIC_JOINT_ROT_AXIS)
+    {
+      z = axis_sign_[i] * segment_poses_[i].linear().col(axis_index_[i]);
+    }
+    else
+    {
+      z = segment_poses_[i].linear() * axes_[i];
+    }
+
+    const int column = joint_index_[i];
+    joint_origins_.col(column) = segment_poses_[i].translation();
+    jacobian_.block<3, 1>(0, column) = z.cross(p - segment_poses_[i].translation());
+    jacobian_.block<3, 1>(3, column) = z;
+  }
+
+  jacobian_valid_ = true;
+  return jacobian_;
+}
+
+// joint j in front of joint i rotates axis z_i and origin p_i, every joint moves end effector p
+//   dz_i/dq_j = z_j x z_i (j < i),  dp_i/dq_j = z_j x (p_i - p_j) (j < i),  dp/dq_j = z_j x (p - p_j)
+// time derivative sums them with joint velocities, w_i angular velocity of frame i without own joint
+const KinematicEngine::JacobianMatrix& KinematicEngine::calculateJacobianDerivative(
+    const Eigen::VectorXd& joints_angle, const Eigen::VectorXd& joints_velocity)
+{
+  calculateJacobian(joints_angle);
+  const Eigen::Vector3d p = segment_poses_.back().translation();
+  const Eigen::Vector3d p_dot = jacobian_.topRows<3>() * joints_velocity;
+
+  Eigen::Vector3d w = Eigen::Vector3d::Zero();
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    const Eigen::Vector3d z = jacobian_.block<3, 1>(3, i);
+    const Eigen::Vector3d p_i = joint_origins_.col(i);
+
+    Eigen::Vector3d p_i_dot = Eigen::Vector3d::Zero();
+    for (int j = 0u; j < i; ++j)
+    {
+      p_i_dot += joints_velocity(j) * jacobian_.block<3, 1>(3, j).cross(p_i - joint_origins_.col(j));
+    }
+
+    const Eigen::Vector3d z_dot = w.cross(z);
+    jacobian_derivative_.block<3, 1>(0, i) = z_dot.cross(p - p_i) + z.cross(p_dot - p_i_dot);
+    jacobian_derivative_.block<3, 1>(3, i) = z_dot;
+
+    w += joints_velocity(i) * z;
+  }
+
+  return jacobian_derivative_;
+}
+
+// dJ_i/dq_j = [(z_j x z_i) x (p - p_i) + z_i x (z_j x (p - p_i)); z_j x z_i]  j < i
+//             [z_i x (z_j x (p - p_j)); 0]                                   j >= i
+const KinematicEngine::JacobianVector& KinematicEngine::calculateJacobianHessian(const Eigen::VectorXd& joints_angle)
+{
+  calculateJacobian(joints_angle);
+  const Eigen::Vector3d p = segment_poses_.back().translation();
+
+  for (int j = 0u; j < degree_of_freedom_; ++j)
+  {
+    const Eigen::Vector3d z_j = jacobian_.block<3, 1>(3, j);
+    const Eigen::Vector3d p_dq_j = z_j.cross(p - joint_origins_.col(j));
+
+    for (int i = 0u; i < degree_of_freedom_; ++i)
+    {
+      const Eigen::Vector3d z_i = jacobian_.block<3, 1>(3, i);
+      if (j < i)
+      {
+        const Eigen::Vector3d z_dq_j = z_j.cross(z_i);
+        const Eigen::Vector3d d = p - joint_origins_.col(i);
+        jacobian_hessian_[j].block<3, 1>(0, i) = z_dq_j.cross(d) + z_i.cross(z_j.cross(d));
+        jacobian_hessian_[j].block<3, 1>(3, i) = z_dq_j;
+      }
+      else
+      {
+        jacobian_hessian_[j].block<3, 1>(0, i) = z_i.cross(p_dq_j);
+        jacobian_hessian_[j].block<3, 1>(3, i).setZero();
+      }
+    }
+  }
+
+  return jacobian_hessian_;
+}
@@ -191,6 +191,19 @@ bool predictive_configuration::initialize()  // const std::string& node_handle_n
   // check requested parameter availble on parameter server if not than set default value
   nh.param("robot_description", robot_description_, std::string("robot_description"));         // robot description
   nh.param("clock_frequency", clock_frequency_, double(50.0));                                 // 50 hz
+  nh.param("use_solver_thread", use_solver_thread_, bool(false));                              // solver thread
+  nh.param("interpolation_frequency", interpolation_frequency_, double(0.0));                  // disabled
+  nh.param("use_latency_compensation", use_latency_compensation_, bool(false));                // disabled
+  nh.param("latency_filter_gain", latency_filter_gain_, double(0.1));                          // filter gain
+  nh.param("kinematic_backend", kinematic_backend_, std::string("homogeneous"));               // kinematics
+  nh.param("use_incremental_kinematics", use_incremental_kinematics_, bool(false));            // disabled
+  nh.param("incremental_kinematics_epsilon", incremental_kinematics_epsilon_, double(1e-9));   // rad
+  nh.param("check_goal_reachability", check_goal_reachability_, bool(false));                  // disabled
+  nh.param("ik_max_iterations", ik_max_iterations_, int(100));                                 // iterations
+  nh.param("ik_damping", ik_damping_, double(0.05));                                           // damping
+  nh.param("ik_tolerance", ik_tolerance_, double(1e-4));                                       // m, rad
+  nh.param("ik_number_of_seeds", ik_number_of_seeds_, int(1));                                 // warm start only
+  nh.param("ik_number_of_threads", ik_number_of_threads_, int(1));                             // threads
   nh.param("sampling_time", sampling_time_, double(0.025));                                    // 0.025 second
   nh.param("activate_output", activate_output_, bool(false));                                  // debug
   nh.param("activate_controller_node_output", activate_controller_node_output_, bool(false));  // debug
@@ -202,6 +215,23 @@ bool predictive_configuration::initialize()  // const std::string& node_handle_n
                   double(0.12));  // self collision avoidance minimum distance
   nh_config.param("self_collision/collision_weight_factor", collision_weight_factor_,
                   double(0.01));  // self collision avoidance weight factor
+  nh_config.param("self_collision/ignore_adjacent_links", ignore_adjacent_links_,
+                  bool(false));  // ball pairs of same or adjacent link have constant distance
+  nh_config.param("self_collision/ignore_pairs", self_collision_ignore_pairs_,
+                  std::vector<std::string>());  // no pair excluded by name
+  if (self_collision_ignore_pairs_.size() % 2 != 0)
+  {
+    ROS_WARN(" Parameter 'self_collision/ignore_pairs' has odd number of ball names, last one ignored");
+    self_collision_ignore_pairs_.pop_back();
+  }
+
+  // static collision avoidance parameter
+  nh_config.param("static_collision/use_distance_field", use_distance_field_,
+                  bool(false));  // exact distance to every nearby obstacle
+  nh_config.param("static_collision/distance_field_resolution", distance_field_resolution_,
+                  double(0.02));  // m
+  nh_config.param("static_collision/distance_field_size", distance_field_size_,
+                  double(2.4));  // m, workspace around chain root
 
   // acado configuration parameter
   nh_config.param("acado_config/max_num_iteration", max_num_iteration_,
@@ -218,6 +248,18 @@ bool predictive_configuration::initialize()  // const std::string& node_handle_n
   nh_config.param("acado_config/use_lagrange_term", use_lagrange_term_,
                   bool(false));                                                 // use for minimize objective function
   nh_config.param("acado_config/use_mayer_term", use_mayer_term_, bool(true));  // use for minimize objective function
+  nh_config.param("acado_config/solver_mode", solver_mode_, std::string("acado"));  // optimal control solver
+  nh_config.param("acado_config/warm_start", warm_start_, bool(true));  // shift previous solution as initial guess
+  nh_config.param("acado_config/solver_deadline", solver_deadline_, double(0.0));  // compute budget per tick (sec)
+  nh_config.param("acado_config/use_ltv_model", use_ltv_model_, bool(false));  // stage wise Jacobians
+  nh_config.param("acado_config/use_jacobian_derivative", use_jacobian_derivative_, bool(false));  // second order
+  nh_config.param("acado_config/use_effort_constraints", use_effort_constraints_, bool(false));    // effort limits
+
+  // derive deadline from control period, keep margin for publishing and kinematics
+  if (solver_deadline_ <= 0.0 && clock_frequency_ > 0.0)
+  {
+    solver_deadline_ = 0.8 / clock_frequency_;
+  }
 
   initialize_success_ = true;
 
@@ -261,10 +303,29 @@ bool predictive_configuration::updateConfiguration(const predictive_configuratio
   lsq_control_weight_factors_ = new_config.lsq_control_weight_factors_;
 
   clock_frequency_ = new_config.clock_frequency_;
+  use_solver_thread_ = new_config.use_solver_thread_;
+  interpolation_frequency_ = new_config.interpolation_frequency_;
+  use_latency_compensation_ = new_config.use_latency_compensation_;
+  latency_filter_gain_ = new_config.latency_filter_gain_;
+  kinematic_backend_ = new_config.kinematic_backend_;
+  use_incremental_kinematics_ = new_config.use_incremental_kinematics_;
+  incremental_kinematics_epsilon_ = new_config.incremental_kinematics_epsilon_;
+  check_goal_reachability_ = new_config.check_goal_reachability_;
+  ik_max_iterations_ = new_config.ik_max_iterations_;
+  ik_damping_ = new_config.ik_damping_;
+  ik_tolerance_ = new_config.ik_tolerance_;
+  ik_number_of_seeds_ = new_config.ik_number_of_seeds_;
+  ik_number_of_threads_ = new_config.ik_number_of_threads_;
   sampling_time_ = new_config.sampling_time_;
   ball_radius_ = new_config.ball_radius_;
   minimum_collision_distance_ = new_config.minimum_collision_distance_;
   collision_weight_factor_ = new_config.collision_weight_factor_;
+  ignore_adjacent_links_ = new_config.ignore_adjacent_links_;
+  self_collision_ignore_pairs_ = new_config.self_collision_ignore_pairs_;
+
+  use_distance_field_ = new_config.use_distance_field_;
+  distance_field_resolution_ = new_config.distance_field_resolution_;
+  distance_field_size_ = new_config.distance_field_size_;
 
   use_lagrange_term_ = new_config.use_lagrange_term_;
   use_LSQ_term_ = new_config.use_LSQ_term_;
@@ -275,6 +336,12 @@ bool predictive_configuration::updateConfiguration(const predictive_configuratio
   integrator_tolerance_ = new_config.integrator_tolerance_;
   start_time_horizon_ = new_config.start_time_horizon_;
   end_time_horizon_ = new_config.end_time_horizon_;
+  solver_mode_ = new_config.solver_mode_;
+  warm_start_ = new_config.warm_start_;
+  solver_deadline_ = new_config.solver_deadline_;
+  use_ltv_model_ = new_config.use_ltv_model_;
+  use_jacobian_derivative_ = new_config.use_jacobian_derivative_;
+  use_effort_constraints_ = new_config.use_effort_constraints_;
 
   if (activate_output_)
   {
@@ -300,10 +367,27 @@ void predictive_configuration::print_configuration_parameter()
   ROS_INFO_STREAM("Target_frame: " << target_frame_);
   ROS_INFO_STREAM("Tracking_frame: " << tracking_frame_);
   ROS_INFO_STREAM("Clock_frequency: " << clock_frequency_);
+  ROS_INFO_STREAM("Use solver thread: " << std::boolalpha << use_solver_thread_);
+  ROS_INFO_STREAM("Interpolation frequency: " << interpolation_frequency_);
+  ROS_INFO_STREAM("Use latency compensation: " << std::boolalpha << use_latency_compensation_);
+  ROS_INFO_STREAM("Latency filter gain: " << latency_filter_gain_);
+  ROS_INFO_STREAM("Kinematic backend: " << kinematic_backend_);
+  ROS_INFO_STREAM("Use incremental kinematics: " << std::boolalpha << use_incremental_kinematics_);
+  ROS_INFO_STREAM("Incremental kinematics epsilon: " << incremental_kinematics_epsilon_);
+  ROS_INFO_STREAM("Check goal reachability: " << std::boolalpha << check_goal_reachability_);
+  ROS_INFO_STREAM("IK max iterations: " << ik_max_iterations_);
+  ROS_INFO_STREAM("IK damping: " << ik_damping_);
+  ROS_INFO_STREAM("IK tolerance: " << ik_tolerance_);
+  ROS_INFO_STREAM("IK number of seeds: " << ik_number_of_seeds_);
+  ROS_INFO_STREAM("IK number of threads: " << ik_number_of_threads_);
   ROS_INFO_STREAM("Sampling_time: " << sampling_time_);
   ROS_INFO_STREAM("Ball_radius: " << ball_radius_);
   ROS_INFO_STREAM("Minimum collision distance: " << minimum_collision_distance_);
   ROS_INFO_STREAM("Collision weight factor: " << collision_weight_factor_);
+  ROS_INFO_STREAM("Ignore adjacent links: " << std::boolalpha << ignore_adjacent_links_);
+  ROS_INFO_STREAM("Use distance field: " << std::boolalpha << use_distance_field_);
+  ROS_INFO_STREAM("Distance field resolution: " << distance_field_resolution_);
+  ROS_INFO_STREAM("Distance field size: " << distance_field_size_);
   ROS_INFO_STREAM("Use lagrange term: " << std::boolalpha << use_lagrange_term_);
   ROS_INFO_STREAM("Use LSQ term: " << std::boolalpha << use_LSQ_term_);
   ROS_INFO_STREAM("Use mayer term: " << std::boolalpha << use_mayer_term_);
@@ -313,6 +397,12 @@ void predictive_configuration::print_configuration_parameter()
   ROS_INFO_STREAM("Integrator tolerance: " << integrator_tolerance_);
   ROS_INFO_STREAM("Start time horizon: " << start_time_horizon_);
   ROS_INFO_STREAM("End time horizon: " << end_time_horizon_);
+  ROS_INFO_STREAM("Solver mode: " << solver_mode_);
+  ROS_INFO_STREAM("Warm start: " << std::boolalpha << warm_start_);
+  ROS_INFO_STREAM("Solver deadline: " << solver_deadline_);
+  ROS_INFO_STREAM("Use LTV model: " << std::boolalpha << use_ltv_model_);
+  ROS_INFO_STREAM("Use Jacobian derivative: " << std::boolalpha << use_jacobian_derivative_);
+  ROS_INFO_STREAM("Use effort constraints: " << std::boolalpha << use_effort_constraints_);
 
   // print joints name
   std::cout << "Joint names: [";
@@ -325,6 +415,14 @@ void predictive_configuration::print_configuration_parameter()
            [](std::string& str) { std::cout << str << ", "; });
   std::cout << "]" << std::endl;
 
+  // print ignored self collision pairs
+  std::cout << "Self collision ignore pairs: [";
+  for (int i = 0u; i + 1 < self_collision_ignore_pairs_.size(); i += 2)
+  {
+    std::cout << "(" << self_collision_ignore_pairs_[i] << ", " << self_collision_ignore_pairs_[i + 1] << "), ";
+  }
+  std::cout << "]" << std::endl;
+
   // print joint min limits
   std::cout << "Joint min limit: [";
   for_each(joints_min_limit_.begin(), joints_min_limit_.end(), [](double& val) { std::cout << val << ", "; });
@@ -380,6 +478,7 @@ void predictive_configuration::free_allocated_memory()
 {
   joints_name_.clear();
   collision_check_links_.clear();
+  self_collision_ignore_pairs_.clear();
   joints_min_limit_.clear();
   joints_max_limit_.clear();
   joints_vel_min_limit_.clear();
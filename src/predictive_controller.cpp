@@ -5,11 +5,36 @@
 
 predictive_control_ros::predictive_control_ros()
 {
-  ;
+  use_solver_thread_ = false;
+  stop_solver_thread_ = false;
+  timer_overruns_ = 0;
+  use_latency_compensation_ = false;
+  latency_estimate_ = 0.0;
+  latency_initialized_ = false;
+  goal_reachable_ = false;
+  goal_pending_ = false;
+  stop_reachability_thread_ = false;
 }
 
 predictive_control_ros::~predictive_control_ros()
 {
+  // stop solver thread before members used by it are destroyed
+  stop_solver_thread_ = true;
+  if (solver_thread_.joinable())
+  {
+    solver_thread_.join();
+  }
+
+  {
+    boost::mutex::scoped_lock lock(reachability_mutex_);
+    stop_reachability_thread_ = true;
+  }
+  reachability_condition_.notify_one();
+  if (reachability_thread_.joinable())
+  {
+    reachability_thread_.join();
+  }
+
   clearDataMember();
   // delete pd_config_;
   // delete kinematic_solver_;
@@ -90,6 +115,15 @@ bool predictive_control_ros::initialize()
 
     target_frame_ = pd_config_->target_frame_;
 
+    // refresh target transform at control rate, control loop only read latest cached transform
+    target_transform_cache_.reset(new TransformCache());
+    if (!target_transform_cache_->initialize(nh, &tf_listener_, pd_config_->chain_root_link_, target_frame_,
+                                             clock_frequency_))
+    {
+      ROS_ERROR("predictive_control_ros: Failed to initialize target transform cache");
+      return false;
+    }
+
     /// INFO: static function called transformStdVectorToEigenVector define in the predictive_trajectory_generator.h
     goal_tolerance_ = pd_frame_tracker::transformStdVectorToEigenVector<double>(pd_config_->goal_pose_tolerance_);
     min_position_limit_ = pd_frame_tracker::transformStdVectorToEigenVector<double>(pd_config_->joints_min_limit_);
@@ -106,6 +140,9 @@ bool predictive_control_ros::initialize()
     current_gripper_pose_.setConstant(6, 1, 1e-6);
     // getTransform(pd_config_->chain_root_link_, pd_config_->tracking_frame_, current_gripper_pose_);
 
+    // far from goal till first target transform is available in cache
+    tf_traget_from_tracking_vector_.setConstant(6, 1, 1e3);
+
     cartesian_dist_ = double(0.0);
     rotation_dist_ = double(0.0);
 
@@ -121,6 +158,8 @@ bool predictive_control_ros::initialize()
     last_position_ = Eigen::VectorXd(degree_of_freedom_);
     // current_velocity_ = Eigen::VectorXd(degree_of_freedom_);
     last_velocity_ = Eigen::VectorXd(degree_of_freedom_);
+    goal_joint_position_ = Eigen::VectorXd::Zero(degree_of_freedom_);
+    goal_reachable_ = false;
 
     // initialize FK_Matrix and Jacobian Matrix
     const int jacobian_matrix_rows = 6, jacobian_matrix_columns = degree_of_freedom_;
@@ -145,6 +184,49 @@ bool predictive_control_ros::initialize()
     cartesian_error_pub_ = nh.advertise<geometry_msgs::PoseStamped>("cartesian_error", 1);
     // traj_pub_ = nh.advertise<geometry_msgs::PoseArray>("trajectory",1);
     traj_pub_ = nh.advertise<visualization_msgs::MarkerArray>("pd_trajectory", 1);
+    solver_statistics_pub_ = nh.advertise<predictive_control::SolverStatistics>("solver_statistics", 1);
+
+    // predicted initial state, same size as measured state
+    use_latency_compensation_ = pd_config_->use_latency_compensation_;
+    predicted_joint_position_ = last_position_;
+    predicted_gripper_pose_ = current_gripper_pose_;
+
+    // high rate output stage, publishes on command topic instead of control timer
+    commanded_trajectory_.setZero(degree_of_freedom_ * pd_config_->discretization_intervals_);
+    if (pd_config_->interpolation_frequency_ > 0.0)
+    {
+      const double delta_t = (pd_config_->end_time_horizon_ - pd_config_->start_time_horizon_) /
+                             pd_config_->discretization_intervals_;
+      control_interpolator_.reset(new ControlInterpolator());
+      if (!control_interpolator_->initialize(nh, "joint_group_velocity_controller/command",
+                                             pd_config_->interpolation_frequency_, delta_t, min_velocity_limit_,
+                                             max_velocity_limit_, pd_config_->discretization_intervals_))
+      {
+        ROS_ERROR("predictive_control_ros: Failed to initialize control interpolator");
+        return false;
+      }
+    }
+
+    // preallocate handoff buffers, afterwards only same sized data is copied
+    use_solver_thread_ = pd_config_->use_solver_thread_;
+    if (use_solver_thread_)
+    {
+      SolverInput input;
+      input.Jacobian_Matrix = Jacobian_Matrix_;
+      input.joint_position = last_position_;
+      input.current_gripper_pose = current_gripper_pose_;
+      input.goal_gripper_pose = goal_gripper_pose_;
+      input.self_collision_distance = 0.0;
+      input.static_collision_vector = static_collision_avoidance_->collision_cost_vector_;
+      input.applied_velocity = controlled_velocity_;
+      solver_input_buffer_.initialize(input);
+
+      SolverOutput output;
+      output.controlled_velocity = controlled_velocity_;
+      output.control_trajectory = commanded_trajectory_;
+      solver_output_buffer_.initialize(output);
+      solver_velocity_ = controlled_velocity_;
+    }
 
     ros::Duration(1).sleep();
 
@@ -158,6 +240,16 @@ bool predictive_control_ros::initialize()
       std::cin >> ch;
     }
 
+    if (use_solver_thread_)
+    {
+      solver_thread_ = boost::thread(&predictive_control_ros::solverThread, this);
+    }
+
+    if (pd_config_->check_goal_reachability_)
+    {
+      reachability_thread_ = boost::thread(&predictive_control_ros::reachabilityThread, this);
+    }
+
     timer_ = nh.createTimer(ros::Duration(1 / clock_frequency_), &predictive_control_ros::runNode, this);
     timer_.start();
 
@@ -174,17 +266,54 @@ bool predictive_control_ros::initialize()
 // update this function 1/colck_frequency
 void predictive_control_ros::runNode(const ros::TimerEvent& event)
 {
-  std::cout.precision(20);
-
-  ROS_WARN_STREAM(goal_gripper_pose_.transpose());
+  PD_LOG_DEBUG_VALUES("predictive_control_ros: goal gripper pose:", goal_gripper_pose_.data(),
+                      goal_gripper_pose_.size());
 
   // std_msgs::Float64MultiArray enforced_velocity_vector;
   // enforceVelocityInLimits(controlled_velocity_, enforced_velocity_vector);
 
-  // solver optimal control problem
-  pd_trajectory_generator_->solveOptimalControlProblem(
-      Jacobian_Matrix_, current_gripper_pose_, goal_gripper_pose_, collision_avoidance_->getDistanceCostFunction(),
-      static_collision_avoidance_->collision_cost_vector_, controlled_velocity_);
+  // previous tick took longer than clock period
+  if (event.profile.last_duration.toSec() > 1.0 / clock_frequency_)
+  {
+    ++timer_overruns_;
+  }
+
+  if (use_solver_thread_)
+  {
+    // pick up latest result of solver thread, keep last command while solver is still busy
+    if (solver_output_buffer_.update())
+    {
+      const SolverOutput& output = solver_output_buffer_.getReadBuffer();
+      controlled_velocity_.data = output.controlled_velocity.data;
+      commanded_stamp_ = output.control_stamp;
+      commanded_trajectory_ = output.control_trajectory;
+
+      // without interpolation command goes out at this tick
+      updateLatencyEstimate(output.stamp, control_interpolator_ ? output.control_stamp : ros::Time::now());
+
+      predictive_control::SolverStatistics statistics = output.statistics;
+      statistics.timer_overruns = timer_overruns_;
+      statistics.latency = latency_estimate_;
+      solver_statistics_pub_.publish(statistics);
+    }
+  }
+  else
+  {
+    // solver optimal control problem, start from state at which command goes out, joints driven by interpolated
+    // command when interpolation is active
+    predictInitialState(Jacobian_Matrix_, last_position_, current_gripper_pose_,
+                        control_interpolator_ ? control_interpolator_->getAppliedCommand() : controlled_velocity_);
+    pd_trajectory_generator_->solveOptimalControlProblem(
+        Jacobian_Matrix_, predicted_joint_position_, predicted_gripper_pose_, goal_gripper_pose_,
+        collision_avoidance_->getDistanceCostFunction(), static_collision_avoidance_->collision_cost_vector_,
+        controlled_velocity_);
+    commanded_stamp_ = ros::Time::now();
+    pd_trajectory_generator_->getCommandedTrajectory(commanded_trajectory_);
+    updateLatencyEstimate(joint_state_stamp_, commanded_stamp_);
+
+    pd_trajectory_generator_->updateControllerStatistics(timer_overruns_, latency_estimate_);
+    solver_statistics_pub_.publish(pd_trajectory_generator_->getSolverStatistics());
+  }
 
   // controlled_velocity_ = enforced_velocity_vector;
 
@@ -219,7 +348,7 @@ void predictive_control_ros::runNode(const ros::TimerEvent& event)
 
   // check infinitesimal distance
   // Eigen::VectorXd distance_vector;
-  getTransform(pd_config_->tracking_frame_, target_frame_, tf_traget_from_tracking_vector_);
+  getTargetFromTrackingPose(tf_traget_from_tracking_vector_);
 
   // publishes error stamped for plot, trajectory
   this->publishErrorPose(tf_traget_from_tracking_vector_);
@@ -251,6 +380,14 @@ void predictive_control_ros::runNode(const ros::TimerEvent& event)
       publishZeroJointVelocity();
     }
  }*/
+  else if (control_interpolator_)
+  {
+    // interpolation timer publish command, keep it stopped after limit violation
+    if (!(position_violation && velocity_violation))
+    {
+      control_interpolator_->setTrajectory(commanded_stamp_, commanded_trajectory_);
+    }
+  }
   else
   {
     // pubish controll velocity
@@ -258,6 +395,98 @@ void predictive_control_ros::runNode(const ros::TimerEvent& event)
   }
 }
 
+// write snapshot of current kinematic state and goal to solver thread
+void predictive_control_ros::publishSolverInput()
+{
+  SolverInput& input = solver_input_buffer_.getWriteBuffer();
+  input.stamp = joint_state_stamp_;
+  input.Jacobian_Matrix = Jacobian_Matrix_;
+  input.joint_position = last_position_;
+  input.current_gripper_pose = current_gripper_pose_;
+  input.goal_gripper_pose = goal_gripper_pose_;
+  input.self_collision_distance = collision_avoidance_->getDistanceCostFunction();
+  input.static_collision_vector = static_collision_avoidance_->collision_cost_vector_;
+
+  // with interpolation applied command is interpolated one, not last solved
+  input.applied_velocity.data =
+      control_interpolator_ ? control_interpolator_->getAppliedCommand().data : controlled_velocity_.data;
+  solver_input_buffer_.publish();
+}
+
+// state at which command of next solve goes out, last command applied over whole latency
+void predictive_control_ros::predictInitialState(const Eigen::MatrixXd& Jacobian_Matrix,
+                                                 const Eigen::VectorXd& joint_position,
+                                                 const Eigen::VectorXd& gripper_pose,
+                                                 const std_msgs::Float64MultiArray& velocity)
+{
+  predicted_joint_position_ = joint_position;
+  predicted_gripper_pose_ = gripper_pose;
+
+  if (!use_latency_compensation_ || velocity.data.size() < degree_of_freedom_)
+  {
+    return;
+  }
+
+  const double latency = latency_estimate_;
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    predicted_joint_position_(i) += latency * velocity.data[i];
+    predicted_gripper_pose_ += (latency * velocity.data[i]) * Jacobian_Matrix.col(i);
+  }
+}
+
+// exponential moving average of latency, first measurement taken as it is
+void predictive_control_ros::updateLatencyEstimate(const ros::Time& measurement_stamp, const ros::Time& command_stamp)
+{
+  const double latency = (command_stamp - measurement_stamp).toSec();
+
+  // clock jump or no joint state received yet
+  if (measurement_stamp.isZero() || latency < 0.0 || latency > 1.0)
+  {
+    return;
+  }
+
+  if (!latency_initialized_)
+  {
+    latency_estimate_ = latency;
+    latency_initialized_ = true;
+    return;
+  }
+
+  const double gain = pd_config_->latency_filter_gain_;
+  latency_estimate_ = gain * latency + (1.0 - gain) * latency_estimate_;
+}
+
+// solve optimal control problem for every new snapshot, result handed over to control timer
+void predictive_control_ros::solverThread()
+{
+  while (ros::ok() && !stop_solver_thread_)
+  {
+    if (!solver_input_buffer_.update())
+    {
+      // no new snapshot, check again shortly
+      boost::this_thread::sleep_for(boost::chrono::microseconds(100));
+      continue;
+    }
+
+    const SolverInput& input = solver_input_buffer_.getReadBuffer();
+    predictInitialState(input.Jacobian_Matrix, input.joint_position, input.current_gripper_pose,
+                        input.applied_velocity);
+    pd_trajectory_generator_->solveOptimalControlProblem(input.Jacobian_Matrix, predicted_joint_position_,
+                                                         predicted_gripper_pose_, input.goal_gripper_pose,
+                                                         input.self_collision_distance, input.static_collision_vector,
+                                                         solver_velocity_);
+
+    SolverOutput& output = solver_output_buffer_.getWriteBuffer();
+    output.stamp = input.stamp;
+    output.controlled_velocity.data = solver_velocity_.data;
+    output.statistics = pd_trajectory_generator_->getSolverStatistics();
+    output.control_stamp = ros::Time::now();
+    pd_trajectory_generator_->getCommandedTrajectory(output.control_trajectory);
+    solver_output_buffer_.publish();
+  }
+}
+
 void predictive_control_ros::moveGoalCB()
 {
   if (move_action_server_->isNewGoalAvailable())
@@ -267,6 +496,19 @@ void predictive_control_ros::moveGoalCB()
     collision_detect_->createStaticFrame(move_action_goal_ptr->target_endeffector_pose,
                                          move_action_goal_ptr->target_frame_id);
     target_frame_ = move_action_goal_ptr->target_frame_id;
+    target_transform_cache_->setTargetFrame(target_frame_);
+
+    // only hand goal over, reachability thread solves inverse kinematics
+    if (pd_config_->check_goal_reachability_)
+    {
+      {
+        boost::mutex::scoped_lock lock(reachability_mutex_);
+        pending_goal_pose_ = move_action_goal_ptr->target_endeffector_pose;
+        pending_goal_seed_ = last_position_;
+        goal_pending_ = true;
+      }
+      reachability_condition_.notify_one();
+    }
 
     // erase previous trajectory
     for (auto it = traj_marker_array_.markers.begin(); it != traj_marker_array_.markers.end(); ++it)
@@ -286,6 +528,7 @@ void predictive_control_ros::movePreemptCB()
   move_action_server_->setPreempted(move_action_result_, "Action has been preempted");
   tracking_ = true;
   target_frame_ = pd_config_->target_frame_;
+  target_transform_cache_->setTargetFrame(target_frame_);
 }
 
 void predictive_control_ros::actionSuccess()
@@ -293,6 +536,7 @@ void predictive_control_ros::actionSuccess()
   move_action_server_->setSucceeded(move_action_result_, "Goal succeeded!");
   tracking_ = true;
   target_frame_ = pd_config_->target_frame_;
+  target_transform_cache_->setTargetFrame(target_frame_);
 }
 
 void predictive_control_ros::actionAbort()
@@ -300,6 +544,7 @@ void predictive_control_ros::actionAbort()
   move_action_server_->setAborted(move_action_result_, "Action has been aborted");
   tracking_ = true;
   target_frame_ = pd_config_->target_frame_;
+  target_transform_cache_->setTargetFrame(target_frame_);
 }
 
 /*
@@ -410,6 +655,9 @@ void predictive_control_ros::jointStateCallBack(const sensor_msgs::JointState::C
     last_position_ = current_position;
     last_velocity_ = current_velocity;
 
+    // measurement time of joint values, start of latency till command goes out
+    joint_state_stamp_ = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+
     // check position violation criteria, enforcing to be in limit
     // enforcePositionInLimits(current_position, last_position_);
 
@@ -421,33 +669,29 @@ void predictive_control_ros::jointStateCallBack(const sensor_msgs::JointState::C
     kinematic_solver_->getGripperPoseVectorFromFK(FK_Matrix_, current_gripper_pose_);
 
     // use intrative marker to set desired goal pose, else set it by mannually
-    getTransform(pd_config_->chain_root_link_, target_frame_, goal_gripper_pose_);
+    target_transform_cache_->getLatestPose(goal_gripper_pose_);
 
-    // update collision ball according to joint angles
+    // update collision ball according to joint angles, only balls of changed segments
     collision_detect_->updateCollisionVolume(kinematic_solver_->FK_Homogenous_Matrix_,
-                                             kinematic_solver_->Transformation_Matrix_);
+                                             kinematic_solver_->Transformation_Matrix_,
+                                             kinematic_solver_->getFirstChangedSegment());
 
     // update static collision accroding to robot critical point computed in collisionRobot class
-    // static_collision_avoidance_->updateStaticCollisionVolume(collision_detect_->collision_matrix_);
+    // static_collision_avoidance_->updateStaticCollisionVolume(collision_detect_->collision_model_);
+
+    // hand over snapshot, solver thread pick it up without blocking this callback
+    if (use_solver_thread_)
+    {
+      publishSolverInput();
+    }
 
     // Output is active, than only print joint state values
     if (pd_config_->activate_controller_node_output_)
     {
-      std::cout << "\n --------------------------------------------- \n";
-      std::cout << "Current joint position: [ " << current_position.transpose() << " ]" << std::endl;
-      std::cout << "Current joint velocity: [ " << current_velocity.transpose() << " ]" << std::endl;
-      /*std::cout << "Current joint position: [";
-      for_each(current_position.begin(), current_position.end(), [](double& p)
-                            { std::cout<< std::setprecision(5) << p << ", " ; }
-      );
-      std::cout<<"]"<<std::endl;
-
-      std::cout << "Current joint velocity: [";
-      for_each(current_velocity.begin(), current_velocity.end(), [](double& v)
-                            { std::cout<< std::setprecision(5) << v << ", " ; }
-      );
-      std::cout<<"]"<<std::endl;*/
-      std::cout << "\n --------------------------------------------- \n";
+      PD_LOG_DEBUG_VALUES("predictive_control_ros: current joint position:", current_position.data(),
+                          current_position.size());
+      PD_LOG_DEBUG_VALUES("predictive_control_ros: current joint velocity:", current_velocity.data(),
+                          current_velocity.size());
     }
   }
 }
@@ -529,13 +773,17 @@ void predictive_control_ros::publishZeroJointVelocity()
   }
 
   controlled_velocity_.data.resize(degree_of_freedom_, 0.0);
-  controlled_velocity_.data[0] = 0.0;
-  controlled_velocity_.data[1] = 0.0;
-  controlled_velocity_.data[2] = 0.0;
-  controlled_velocity_.data[3] = 0.0;
-  controlled_velocity_.data[4] = 0.0;
-  controlled_velocity_.data[5] = 0.0;
-  controlled_velocity_.data[6] = 0.0;
+  for (int i = 0u; i < degree_of_freedom_; ++i)
+  {
+    controlled_velocity_.data[i] = 0.0;
+  }
+
+  // interpolation timer own command topic, stop it instead of publishing in between
+  if (control_interpolator_)
+  {
+    control_interpolator_->stop(ros::Time::now());
+    return;
+  }
   controlled_velocity_pub_.publish(controlled_velocity_);
 }
 
@@ -632,6 +880,116 @@ bool predictive_control_ros::transformEigenToGeometryPose(const Eigen::VectorXd&
   return true;
 }
 
+// inverse kinematics of move action goal, unreachable goal only reported, tracking continues to closest pose
+// wait for goal of move action, goal arrived meanwhile replaces pending one
+void predictive_control_ros::reachabilityThread()
+{
+  geometry_msgs::PoseStamped target_pose;
+  Eigen::VectorXd seed;
+  for (;;)
+  {
+    {
+      boost::mutex::scoped_lock lock(reachability_mutex_);
+      while (!stop_reachability_thread_ && !goal_pending_)
+      {
+        reachability_condition_.wait(lock);
+      }
+
+      if (stop_reachability_thread_)
+      {
+        return;
+      }
+
+      target_pose = pending_goal_pose_;
+      seed = pending_goal_seed_;
+      goal_pending_ = false;
+    }
+
+    checkGoalReachability(target_pose, seed);
+  }
+}
+
+bool predictive_control_ros::checkGoalReachability(const geometry_msgs::PoseStamped& target_pose,
+                                                   const Eigen::VectorXd& seed)
+{
+  goal_reachable_ = false;
+
+  // goal relative to root link, same frame as forward kinematics
+  geometry_msgs::PoseStamped root_pose;
+  if (!tf_listener_.canTransform(pd_config_->chain_root_link_, target_pose.header.frame_id, ros::Time(0)))
+  {
+    ROS_WARN("checkGoalReachability: No transform from %s to %s", target_pose.header.frame_id.c_str(),
+             pd_config_->chain_root_link_.c_str());
+    return false;
+  }
+
+  try
+  {
+    geometry_msgs::PoseStamped latest_pose = target_pose;
+    latest_pose.header.stamp = ros::Time(0);
+    tf_listener_.transformPose(pd_config_->chain_root_link_, latest_pose, root_pose);
+  }
+  catch (tf::TransformException& ex)
+  {
+    ROS_WARN("checkGoalReachability: %s", ex.what());
+    return false;
+  }
+
+  tf::Pose pose;
+  tf::poseMsgToTF(root_pose.pose, pose);
+  Eigen::Matrix4d goal_FK_Matrix = Eigen::Matrix4d::Identity();
+  for (int i = 0u; i < 3; ++i)
+  {
+    for (int j = 0u; j < 3; ++j)
+    {
+      goal_FK_Matrix(i, j) = pose.getBasis()[i][j];
+    }
+    goal_FK_Matrix(i, 3) = pose.getOrigin()[i];
+  }
+
+  const ros::WallTime start = ros::WallTime::now();
+  goal_reachable_ = kinematic_solver_->calculateInverseKinematics(goal_FK_Matrix, seed, goal_joint_position_);
+  const double solve_time = (ros::WallTime::now() - start).toSec();
+
+  const InverseKinematicEngine& ik = kinematic_solver_->getInverseKinematicEngine();
+  if (goal_reachable_)
+  {
+    ROS_INFO("checkGoalReachability: Goal reachable, %d iterations, %d seeds, %.1f us", ik.getNumIterations(),
+             ik.getNumSeeds(), 1e6 * solve_time);
+  }
+  else
+  {
+    ROS_WARN("checkGoalReachability: Goal not reachable within joint limits, remaining error %f, %d seeds, %.1f us",
+             ik.getError(), ik.getNumSeeds(), 1e6 * solve_time);
+  }
+
+  return goal_reachable_;
+}
+
+// target pose relative to tracking frame, tracking frame taken from forward kinematic (relative to root link)
+bool predictive_control_ros::getTargetFromTrackingPose(Eigen::VectorXd& pose)
+{
+  tf::StampedTransform root_to_target;
+  if (!target_transform_cache_->getLatest(root_to_target))
+  {
+    return false;
+  }
+
+  tf::Transform root_to_tracking(tf::Matrix3x3(FK_Matrix_(0, 0), FK_Matrix_(0, 1), FK_Matrix_(0, 2),
+                                               FK_Matrix_(1, 0), FK_Matrix_(1, 1), FK_Matrix_(1, 2),
+                                               FK_Matrix_(2, 0), FK_Matrix_(2, 1), FK_Matrix_(2, 2)),
+                                 tf::Vector3(FK_Matrix_(0, 3), FK_Matrix_(1, 3), FK_Matrix_(2, 3)));
+  tf::Transform tracking_to_target = root_to_tracking.inverseTimes(root_to_target);
+
+  pose.resize(6);
+  pose(0) = tracking_to_target.getOrigin().x();
+  pose(1) = tracking_to_target.getOrigin().y();
+  pose(2) = tracking_to_target.getOrigin().z();
+  tf::Matrix3x3(tracking_to_target.getRotation()).getRPY(pose(3), pose(4), pose(5));
+
+  return true;
+}
+
 bool predictive_control_ros::getTransform(const std::string& from, const std::string& to, Eigen::VectorXd& stamped_pose)
 {
   bool transform = false;
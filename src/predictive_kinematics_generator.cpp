@@ -0,0 +1,545 @@
+// This file containts offline code generator, export forward kinematic and Jacobian of configured kinematic chain
+// as closed form straight line C++ code (fixed transforms constant folded, one sin/cos pair per joint)
+
+// c++ includes
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// yaml parsing
+#include <yaml-cpp/yaml.h>
+
+// kdl includes
+#include <urdf/model.h>
+#include <kdl_parser/kdl_parser.hpp>
+#include <kdl/chain.hpp>
+
+// value of generated expression, either constant known at generation time or name of local variable
+struct Symbol
+{
+  bool constant;
+  double value;
+  std::string name;
+
+  Symbol(const double& v = 0.0) : constant(true), value(v)
+  {
+  }
+
+  Symbol(const std::string& n) : constant(false), value(0.0), name(n)
+  {
+  }
+};
+
+// coefficient * a * b
+struct Product
+{
+  double coefficient;
+  Symbol a;
+  Symbol b;
+
+  Product(const double& c, const Symbol& x, const Symbol& y = Symbol(1.0)) : coefficient(c), a(x), b(y)
+  {
+  }
+};
+
+// rotation and translation of segment pose relative to chain root
+struct SymbolicFrame
+{
+  Symbol R[3][3];
+  Symbol p[3];
+};
+
+class CodeWriter
+{
+  /** Emit straight line code, every expression constant folded before it is written
+   * - Products with zero constant are dropped, unit constants are not multiplied
+   * - Expression with single unscaled variable reuse that variable, no new local
+   */
+
+public:
+  CodeWriter() : counter_(0)
+  {
+  }
+
+  void reset()
+  {
+    counter_ = 0;
+    code_.str("");
+  }
+
+  std::string code() const
+  {
+    return code_.str();
+  }
+
+  void line(const std::string& text)
+  {
+    code_ << "  " << text << "\n";
+  }
+
+  // sum of products, new local when result is not constant
+  Symbol combine(const std::vector<Product>& products)
+  {
+    double constant_sum = 0.0;
+    std::vector<std::pair<double, std::string> > terms;
+
+    for (int i = 0u; i < products.size(); ++i)
+    {
+      double coefficient = products[i].coefficient;
+      std::string factor;
+
+      if (products[i].a.constant)
+      {
+        coefficient *= products[i].a.value;
+      }
+      else
+      {
+        factor = products[i].a.name;
+      }
+
+      if (products[i].b.constant)
+      {
+        coefficient *= products[i].b.value;
+      }
+      else
+      {
+        factor = factor.empty() ? products[i].b.name : factor + " * " + products[i].b.name;
+      }
+
+      if (coefficient == 0.0)
+      {
+        continue;
+      }
+
+      if (factor.empty())
+      {
+        constant_sum += coefficient;
+      }
+      else
+      {
+        terms.push_back(std::make_pair(coefficient, factor));
+      }
+    }
+
+    constant_sum = clean(constant_sum);
+    if (terms.empty())
+    {
+      return Symbol(constant_sum);
+    }
+
+    // single variable, reuse it
+    if (terms.size() == 1 && terms[0].first == 1.0 && constant_sum == 0.0 &&
+        terms[0].second.find(' ') == std::string::npos)
+    {
+      return Symbol(terms[0].second);
+    }
+
+    std::ostringstream expression;
+    expression.precision(17);
+    for (int i = 0u; i < terms.size(); ++i)
+    {
+      const double coefficient = terms[i].first;
+      if (i == 0)
+      {
+        expression << (coefficient < 0.0 ? "-" : "");
+      }
+      else
+      {
+        expression << (coefficient < 0.0 ? " - " : " + ");
+      }
+
+      if (std::fabs(coefficient) != 1.0)
+      {
+        expression << std::fabs(coefficient) << " * ";
+      }
+      expression << terms[i].second;
+    }
+
+    if (constant_sum != 0.0)
+    {
+      expression << (constant_sum < 0.0 ? " - " : " + ") << std::fabs(constant_sum);
+    }
+
+    std::ostringstream name;
+    name << "v" << counter_++;
+    line("const double " + name.str() + " = " + expression.str() + ";");
+    return Symbol(name.str());
+  }
+
+  // literal of symbol
+  static std::string literal(const Symbol& symbol)
+  {
+    if (!symbol.constant)
+    {
+      return symbol.name;
+    }
+
+    std::ostringstream value;
+    value.precision(17);
+    value << symbol.value;
+    if (value.str().find_first_of(".e") == std::string::npos)
+    {
+      value << ".0";
+    }
+    return value.str();
+  }
+
+  // round numerical noise of kdl frames, keep exact zero and unit entries for folding
+  static double clean(const double& value)
+  {
+    if (std::fabs(value) < 1e-12)
+    {
+      return 0.0;
+    }
+    if (std::fabs(std::fabs(value) - 1.0) < 1e-12)
+    {
+      return value < 0.0 ? -1.0 : 1.0;
+    }
+    return value;
+  }
+
+private:
+  int counter_;
+  std::ostringstream code_;
+};
+
+// joint of kinematic chain, axis in segment tip frame
+struct ChainSegment
+{
+  bool revolute;
+  double frame[3][4];
+  double axis[3];
+};
+
+// pose of every segment, T(i) = T(i-1) * F(i) * R(axis, q)
+void writeForwardKinematics(CodeWriter& writer, const std::vector<ChainSegment>& segments,
+                            std::vector<SymbolicFrame>& poses)
+{
+  SymbolicFrame pose;
+  for (int r = 0u; r < 3; ++r)
+  {
+    for (int c = 0u; c < 3; ++c)
+    {
+      pose.R[r][c] = Symbol(r == c ? 1.0 : 0.0);
+    }
+    pose.p[r] = Symbol(0.0);
+  }
+
+  // one sin/cos pair per joint, shared by all entries
+  int joint = 0;
+  for (int i = 0u; i < segments.size(); ++i)
+  {
+    if (segments[i].revolute)
+    {
+      std::ostringstream text;
+      text << "const double s" << joint << " = std::sin(joints_angle[" << joint << "]);";
+      writer.line(text.str());
+      text.str("");
+      text << "const double c" << joint << " = std::cos(joints_angle[" << joint << "]);";
+      writer.line(text.str());
+      ++joint;
+    }
+  }
+
+  poses.clear();
+  joint = 0;
+  for (int i = 0u; i < segments.size(); ++i)
+  {
+    const ChainSegment& segment = segments[i];
+
+    // fixed frame to tip, constant folded
+    SymbolicFrame next;
+    for (int r = 0u; r < 3; ++r)
+    {
+      for (int c = 0u; c < 3; ++c)
+      {
+        std::vector<Product> products;
+        for (int k = 0u; k < 3; ++k)
+        {
+          products.push_back(Product(CodeWriter::clean(segment.frame[k][c]), pose.R[r][k]));
+        }
+        next.R[r][c] = writer.combine(products);
+      }
+
+      std::vector<Product> products;
+      for (int k = 0u; k < 3; ++k)
+      {
+        products.push_back(Product(CodeWriter::clean(segment.frame[k][3]), pose.R[r][k]));
+      }
+      products.push_back(Product(1.0, pose.p[r]));
+      next.p[r] = writer.combine(products);
+    }
+
+    if (segment.revolute)
+    {
+      std::ostringstream s_name, c_name;
+      s_name << "s" << joint;
+      c_name << "c" << joint;
+      const Symbol s(s_name.str()), c(c_name.str());
+
+      int k = 0;
+      double sign = 1.0;
+      bool axis_aligned = false;
+      for (int a = 0u; a < 3; ++a)
+      {
+        if (std::fabs(std::fabs(segment.axis[a]) - 1.0) < 1e-12)
+        {
+          k = a;
+          sign = segment.axis[a] < 0.0 ? -1.0 : 1.0;
+          axis_aligned = true;
+        }
+      }
+
+      SymbolicFrame rotated = next;
+      if (axis_aligned)
+      {
+        // rotation about axis k only mix other two columns
+        const int a = (k + 1) % 3, b = (k + 2) % 3;
+        for (int r = 0u; r < 3; ++r)
+        {
+          rotated.R[r][a] = writer.combine({ Product(1.0, c, next.R[r][a]), Product(sign, s, next.R[r][b]) });
+          rotated.R[r][b] = writer.combine({ Product(1.0, c, next.R[r][b]), Product(-sign, s, next.R[r][a]) });
+        }
+      }
+      else
+      {
+        // Rodrigues formula, R(axis, q) = a * a^T + (I - a * a^T) * cos(q) + [a]x * sin(q)
+        const double* n = segment.axis;
+        const double cross[3][3] = { { 0.0, -n[2], n[1] }, { n[2], 0.0, -n[0] }, { -n[1], n[0], 0.0 } };
+        Symbol rotation[3][3];
+        for (int r = 0u; r < 3; ++r)
+        {
+          for (int col = 0u; col < 3; ++col)
+          {
+            const double outer = n[r] * n[col];
+            rotation[r][col] = writer.combine({ Product(CodeWriter::clean(outer), Symbol(1.0)),
+                                                Product(CodeWriter::clean((r == col ? 1.0 : 0.0) - outer), c),
+                                                Product(CodeWriter::clean(cross[r][col]), s) });
+          }
+        }
+
+        for (int r = 0u; r < 3; ++r)
+        {
+          for (int col = 0u; col < 3; ++col)
+          {
+            std::vector<Product> products;
+            for (int m = 0u; m < 3; ++m)
+            {
+              products.push_back(Product(1.0, next.R[r][m], rotation[m][col]));
+            }
+            rotated.R[r][col] = writer.combine(products);
+          }
+        }
+      }
+
+      next = rotated;
+      ++joint;
+    }
+
+    pose = next;
+    poses.push_back(pose);
+
+    // segment pose as column major 4x4 matrix
+    for (int col = 0u; col < 4; ++col)
+    {
+      for (int r = 0u; r < 4; ++r)
+      {
+        std::string value;
+        if (r == 3)
+        {
+          value = (col == 3) ? "1.0" : "0.0";
+        }
+        else
+        {
+          value = CodeWriter::literal(col == 3 ? pose.p[r] : pose.R[r][col]);
+        }
+
+        std::ostringstream text;
+        text << "segment_poses[" << 16 * i + 4 * col + r << "] = " << value << ";";
+        writer.line(text.str());
+      }
+    }
+  }
+}
+
+// geometric Jacobian of end effector, column of revolute joint [z x (p - p_i); z]
+void writeJacobian(CodeWriter& writer, const std::vector<ChainSegment>& segments,
+                   const std::vector<SymbolicFrame>& poses)
+{
+  const SymbolicFrame& tip = poses.back();
+
+  for (int i = 0u, joint = 0u; i < segments.size(); ++i)
+  {
+    if (!segments[i].revolute)
+    {
+      continue;
+    }
+
+    // joint axis relative to root, rotation about axis does not change it
+    Symbol z[3];
+    for (int r = 0u; r < 3; ++r)
+    {
+      std::vector<Product> products;
+      for (int k = 0u; k < 3; ++k)
+      {
+        products.push_back(Product(CodeWriter::clean(segments[i].axis[k]), poses[i].R[r][k]));
+      }
+      z[r] = writer.combine(products);
+    }
+
+    Symbol d[3];
+    for (int r = 0u; r < 3; ++r)
+    {
+      d[r] = writer.combine({ Product(1.0, tip.p[r]), Product(-1.0, poses[i].p[r]) });
+    }
+
+    Symbol column[6];
+    column[0] = writer.combine({ Product(1.0, z[1], d[2]), Product(-1.0, z[2], d[1]) });
+    column[1] = writer.combine({ Product(1.0, z[2], d[0]), Product(-1.0, z[0], d[2]) });
+    column[2] = writer.combine({ Product(1.0, z[0], d[1]), Product(-1.0, z[1], d[0]) });
+    column[3] = z[0];
+    column[4] = z[1];
+    column[5] = z[2];
+
+    for (int r = 0u; r < 6; ++r)
+    {
+      std::ostringstream text;
+      text << "jacobian[" << 6 * joint + r << "] = " << CodeWriter::literal(column[r]) << ";";
+      writer.line(text.str());
+    }
+    ++joint;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <robot.urdf> <predictive_config_parameter.yaml> <export_directory>"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // read kinematic chain configuration, same parameter as predictive_configuration read from parameter server
+  YAML::Node config;
+  try
+  {
+    config = YAML::LoadFile(argv[2]);
+  }
+  catch (YAML::Exception& ex)
+  {
+    std::cerr << "predictive_kinematics_generator: Failed to load '" << argv[2] << "': " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!config["joints_name"] || !config["chain_base_link"] || !config["chain_tip_link"])
+  {
+    std::cerr << "predictive_kinematics_generator: 'joints_name', 'chain_base_link' or 'chain_tip_link' not set in "
+              << argv[2] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string chain_base_link = config["chain_base_link"].as<std::string>();
+  const std::string chain_tip_link = config["chain_tip_link"].as<std::string>();
+  const std::vector<std::string> joints_name = config["joints_name"].as<std::vector<std::string> >();
+
+  // kinematic chain, constructed same as Kinematic_calculations
+  urdf::Model model;
+  KDL::Tree tree;
+  KDL::Chain chain;
+  if (!model.initFile(argv[1]) || !kdl_parser::treeFromUrdfModel(model, tree) ||
+      !tree.getChain(chain_base_link, chain_tip_link, chain))
+  {
+    std::cerr << "predictive_kinematics_generator: Failed to construct chain '" << chain_base_link << "' to '"
+              << chain_tip_link << "' from " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<ChainSegment> segments(chain.getNrOfSegments());
+  int joint = 0;
+  for (int i = 0u; i < chain.getNrOfSegments(); ++i)
+  {
+    const KDL::Segment& kdl_segment = chain.getSegment(i);
+    const KDL::Frame& frame = kdl_segment.getFrameToTip();
+    for (int r = 0u; r < 3; ++r)
+    {
+      for (int c = 0u; c < 3; ++c)
+      {
+        segments[i].frame[r][c] = frame.M(r, c);
+      }
+      segments[i].frame[r][3] = frame.p[r];
+    }
+
+    segments[i].revolute = (kdl_segment.getJoint().getType() != KDL::Joint::None);
+    if (!segments[i].revolute)
+    {
+      continue;
+    }
+
+    // joint values ordered as joints_name, axis of urdf joint
+    if (kdl_segment.getJoint().getType() > KDL::Joint::RotZ || joint >= joints_name.size() ||
+        kdl_segment.getJoint().getName() != joints_name[joint])
+    {
+      std::cerr << "predictive_kinematics_generator: Joint '" << kdl_segment.getJoint().getName()
+                << "' is not revolute or does not match joints_name" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    const urdf::Vector3& axis = model.getJoint(joints_name[joint])->axis;
+    const double norm = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    segments[i].axis[0] = axis.x / norm;
+    segments[i].axis[1] = axis.y / norm;
+    segments[i].axis[2] = axis.z / norm;
+    ++joint;
+  }
+
+  if (joint != joints_name.size())
+  {
+    std::cerr << "predictive_kinematics_generator: Chain has " << joint << " joints, joints_name "
+              << joints_name.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "\033[32m"
+            << "Export kinematics: '" << chain_base_link << "' to '" << chain_tip_link << "', segments "
+            << segments.size() << ", dof " << joint << "\033[36;0m" << std::endl;
+
+  CodeWriter writer;
+  std::vector<SymbolicFrame> poses;
+
+  writeForwardKinematics(writer, segments, poses);
+  const std::string forward_kinematics_code = writer.code();
+
+  writer.reset();
+  writeForwardKinematics(writer, segments, poses);
+  writeJacobian(writer, segments, poses);
+  const std::string jacobian_code = writer.code();
+
+  const std::string file_name = std::string(argv[3]) + "/generated_kinematics.cpp";
+  std::ofstream file(file_name.c_str());
+  if (!file)
+  {
+    std::cerr << "predictive_kinematics_generator: Failed to write " << file_name << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  file << "// Generated by predictive_kinematics_generator from " << argv[1] << ", do not edit\n\n"
+       << "#include <predictive_control/generated_kinematics.h>\n\n"
+       << "#include <cmath>\n\n"
+       << "int GeneratedKinematics::getDegreeOfFreedom()\n{\n  return " << joint << ";\n}\n\n"
+       << "int GeneratedKinematics::getNumberOfSegments()\n{\n  return " << segments.size() << ";\n}\n\n"
+       << "const char* GeneratedKinematics::getChainBaseLink()\n{\n  return \"" << chain_base_link << "\";\n}\n\n"
+       << "const char* GeneratedKinematics::getChainTipLink()\n{\n  return \"" << chain_tip_link << "\";\n}\n\n"
+       << "void GeneratedKinematics::calculateForwardKinematics(const double* joints_angle, double* segment_poses)\n"
+       << "{\n"
+       << forward_kinematics_code << "}\n\n"
+       << "void GeneratedKinematics::calculateJacobian(const double* joints_angle, double* segment_poses, "
+       << "double* jacobian)\n"
+       << "{\n"
+       << jacobian_code << "}\n";
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,250 @@
+
+// This file containts wrapper of generated real time iteration solver, exported by predictive_solver_generator
+
+#include <predictive_control/predictive_rti_solver.h>
+
+// generated solver
+extern "C" {
+#include "acado_common.h"
+#include "acado_auxiliary_functions.h"
+}
+
+// generated solver work on global memory, defined only once
+ACADOvariables acadoVariables;
+ACADOworkspace acadoWorkspace;
+
+pd_rti_solver::pd_rti_solver()
+{
+  initialized_ = false;
+}
+
+pd_rti_solver::~pd_rti_solver()
+{
+  ;
+}
+
+// initialize generated solver
+bool pd_rti_solver::initialize(const unsigned int& degree_of_freedom, const Eigen::VectorXd& lsq_state_weight_factors,
+                               const Eigen::VectorXd& lsq_control_weight_factors,
+                               const double& collision_weight_factor)
+{
+  // generated code has fixed dimension, make sure it is generated for same configuration
+  if (degree_of_freedom != ACADO_NU || lsq_state_weight_factors.size() != ACADO_NX ||
+      lsq_control_weight_factors.size() != ACADO_NU)
+  {
+    ROS_ERROR("pd_rti_solver: Generated solver dimension (nx: %d, nu: %d) does not match configuration (dof: %d), "
+              "re-generate solver",
+              ACADO_NX, ACADO_NU, degree_of_freedom);
+    return false;
+  }
+
+  acado_initializeSolver();
+
+  // states, controls, references and online data
+  for (int i = 0u; i < ACADO_NX * (ACADO_N + 1); ++i)
+  {
+    acadoVariables.x[i] = 0.0;
+  }
+
+  for (int i = 0u; i < ACADO_NU * ACADO_N; ++i)
+  {
+    acadoVariables.u[i] = 0.0;
+  }
+
+  for (int i = 0u; i < ACADO_NY * ACADO_N; ++i)
+  {
+    acadoVariables.y[i] = 0.0;
+  }
+
+  for (int i = 0u; i < ACADO_NYN; ++i)
+  {
+    acadoVariables.yN[i] = 0.0;
+  }
+
+  for (int i = 0u; i < ACADO_NOD * (ACADO_N + 1); ++i)
+  {
+    acadoVariables.od[i] = 0.0;
+  }
+
+  // weighting matrix, layout [ states | controls | collision cost | controls with collision activation ]
+  for (int i = 0u; i < ACADO_NY * ACADO_NY; ++i)
+  {
+    acadoVariables.W[i] = 0.0;
+  }
+
+  for (int i = 0u; i < ACADO_NX; ++i)
+  {
+    acadoVariables.W[i * ACADO_NY + i] = lsq_state_weight_factors(i);
+  }
+
+  for (int i = 0u, j = ACADO_NX; i < ACADO_NU; ++i, ++j)
+  {
+    acadoVariables.W[j * ACADO_NY + j] = lsq_control_weight_factors(i);
+  }
+
+  const int collision_index = ACADO_NX + ACADO_NU;
+  acadoVariables.W[collision_index * ACADO_NY + collision_index] = collision_weight_factor;
+
+  // controls reweighted while collision cost active, same control weight as generateCollisionCostFunction
+  for (int i = 0u, j = collision_index + 1; i < ACADO_NU; ++i, ++j)
+  {
+    acadoVariables.W[j * ACADO_NY + j] = lsq_control_weight_factors(i);
+  }
+
+  // terminal weighting matrix, zero because symbolic problem has no terminal cost
+  for (int i = 0u; i < ACADO_NYN * ACADO_NYN; ++i)
+  {
+    acadoVariables.WN[i] = 0.0;
+  }
+
+  initialized_ = true;
+  return true;
+}
+
+// run one real time iteration
+bool pd_rti_solver::solve(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& current_pose,
+                          const Eigen::VectorXd& goal_pose, const double& collision_activation,
+                          const double& collision_distance, const Eigen::VectorXd& terminal_control,
+                          Eigen::VectorXd& control)
+{
+  if (!initialized_)
+  {
+    ROS_ERROR("pd_rti_solver::solve: Solver not initialized");
+    return false;
+  }
+
+  // online data same for all shooting nodes
+  for (int node = 0u; node < ACADO_N + 1; ++node)
+  {
+    setOnlineData(node, Jacobian_Matrix, collision_activation, collision_distance, terminal_control);
+  }
+
+  return runIteration(current_pose, goal_pose, control);
+}
+
+// run one real time iteration of linear time varying model
+bool pd_rti_solver::solve(const std::vector<Eigen::MatrixXd>& stage_jacobians, const Eigen::VectorXd& current_pose,
+                          const Eigen::VectorXd& goal_pose, const double& collision_activation,
+                          const double& collision_distance, const Eigen::VectorXd& terminal_control,
+                          Eigen::VectorXd& control)
+{
+  if (!initialized_ || stage_jacobians.empty())
+  {
+    ROS_ERROR("pd_rti_solver::solve: Solver not initialized or no stage Jacobian");
+    return false;
+  }
+
+  // one Jacobian per shooting node, missing nodes keep Jacobian of last given node
+  for (int node = 0u; node < ACADO_N + 1; ++node)
+  {
+    const int stage = std::min<int>(node, stage_jacobians.size() - 1);
+    setOnlineData(node, stage_jacobians[stage], collision_activation, collision_distance, terminal_control);
+  }
+
+  return runIteration(current_pose, goal_pose, control);
+}
+
+// online data layout [ Jacobian row major | collision activation | collision distance | terminal control ]
+void pd_rti_solver::setOnlineData(const int& node, const Eigen::MatrixXd& Jacobian_Matrix,
+                                  const double& collision_activation, const double& collision_distance,
+                                  const Eigen::VectorXd& terminal_control)
+{
+  int index = node * ACADO_NOD;
+  for (int i = 0u; i < ACADO_NX; ++i)
+  {
+    for (int j = 0u; j < ACADO_NU; ++j, ++index)
+    {
+      acadoVariables.od[index] = Jacobian_Matrix(i, j);
+    }
+  }
+  acadoVariables.od[index++] = collision_activation;
+  acadoVariables.od[index++] = collision_distance;
+
+  // missing terminal control (first tick) means stop at end of horizon
+  for (int i = 0u; i < ACADO_NU; ++i, ++index)
+  {
+    acadoVariables.od[index] = (i < terminal_control.size()) ? terminal_control(i) : 0.0;
+  }
+}
+
+// set initial state and references, linearize and solve QP
+bool pd_rti_solver::runIteration(const Eigen::VectorXd& current_pose, const Eigen::VectorXd& goal_pose,
+                                 Eigen::VectorXd& control)
+{
+  // initial state
+  for (int i = 0u; i < ACADO_NX; ++i)
+  {
+    acadoVariables.x0[i] = current_pose(i);
+  }
+
+  // references, goal pose for states, zero for controls and collision cost (terminal reference unused, zero weight)
+  for (int node = 0u; node < ACADO_N; ++node)
+  {
+    for (int i = 0u; i < ACADO_NX; ++i)
+    {
+      acadoVariables.y[node * ACADO_NY + i] = goal_pose(i);
+    }
+  }
+
+  // linearize at current online data and solve QP
+  acado_preparationStep();
+  int status = acado_feedbackStep();
+
+  // control at first step
+  control.resize(ACADO_NU);
+  for (int i = 0u; i < ACADO_NU; ++i)
+  {
+    control(i) = acadoVariables.u[i];
+  }
+
+  if (status != 0)
+  {
+    ROS_WARN("pd_rti_solver::solve: QP solver returned status %d", status);
+    return false;
+  }
+
+  return true;
+}
+
+// cold start, all shooting nodes at current state
+void pd_rti_solver::initializeHorizon(const Eigen::VectorXd& current_pose)
+{
+  for (int node = 0u; node < ACADO_N + 1; ++node)
+  {
+    for (int i = 0u; i < ACADO_NX; ++i)
+    {
+      acadoVariables.x[node * ACADO_NX + i] = current_pose(i);
+    }
+  }
+
+  for (int i = 0u; i < ACADO_NU * ACADO_N; ++i)
+  {
+    acadoVariables.u[i] = 0.0;
+  }
+}
+
+// warm start, shift backwards by one interval (strategy 2: last node integrated with last control)
+void pd_rti_solver::shiftHorizon()
+{
+  acado_shiftStates(2, 0, 0);
+  acado_shiftControls(0);
+}
+
+void pd_rti_solver::getPredictedControls(Eigen::VectorXd& controls) const
+{
+  controls.resize(ACADO_NU * ACADO_N);
+  for (int i = 0u; i < ACADO_NU * ACADO_N; ++i)
+  {
+    controls(i) = acadoVariables.u[i];
+  }
+}
+
+double pd_rti_solver::getKKTValue() const
+{
+  return acado_getKKT();
+}
+
+double pd_rti_solver::getObjectiveValue() const
+{
+  return acado_getObjective();
+}
@@ -0,0 +1,166 @@
+
+// This file containts offline code generator, export optimal control problem of pd_frame_tracker as self-contained
+// real time iteration solver (static memory, fixed dimension, qpOASES with condensing)
+
+// c++ includes
+#include <iostream>
+#include <string>
+#include <vector>
+
+// yaml parsing
+#include <yaml-cpp/yaml.h>
+
+// acado includes
+#include <acado_code_generation.hpp>
+
+USING_NAMESPACE_ACADO
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " <predictive_config_parameter.yaml> <export_directory>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // read kinematic and acado configuration, same parameter as predictive_configuration read from parameter server
+  YAML::Node config;
+  try
+  {
+    config = YAML::LoadFile(argv[1]);
+  }
+  catch (YAML::Exception& ex)
+  {
+    std::cerr << "predictive_solver_generator: Failed to load '" << argv[1] << "': " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const YAML::Node acado_config = config["acado_config"];
+  if (!config["joints_name"] || !acado_config)
+  {
+    std::cerr << "predictive_solver_generator: 'joints_name' or 'acado_config' not set in " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const int jacobian_matrix_rows = 6;
+  const int jacobian_matrix_columns = config["joints_name"].size();
+  const double start_time = acado_config["start_time_horizon"].as<double>(0.0);
+  const double end_time = acado_config["end_time_horizon"].as<double>(1.0);
+  const int discretization_intervals = acado_config["discretization_intervals"].as<int>(4);
+
+  // slef collision cost constant term, same as pd_frame_tracker
+  const double self_collision_cost_constant_term = discretization_intervals / (end_time - start_time);
+
+  // velocity constraints, same default as predictive_configuration when not set, compiled into generated code
+  std::vector<double> joints_vel_min_limit(jacobian_matrix_columns, -1.0);
+  std::vector<double> joints_vel_max_limit(jacobian_matrix_columns, 1.0);
+  const YAML::Node velocity_constraints = config["constraints"]["velocity_constraints"];
+  if (velocity_constraints && velocity_constraints["min"] && velocity_constraints["max"])
+  {
+    joints_vel_min_limit = velocity_constraints["min"].as<std::vector<double> >();
+    joints_vel_max_limit = velocity_constraints["max"].as<std::vector<double> >();
+  }
+
+  if (static_cast<int>(joints_vel_min_limit.size()) != jacobian_matrix_columns ||
+      static_cast<int>(joints_vel_max_limit.size()) != jacobian_matrix_columns)
+  {
+    std::cerr << "predictive_solver_generator: 'velocity_constraints' size does not match 'joints_name'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "\033[32m"
+            << "Export RTI solver: dof " << jacobian_matrix_columns << ", horizon [" << start_time << ", " << end_time
+            << "], intervals " << discretization_intervals << "\033[36;0m" << std::endl;
+
+  // OCP variables
+  DifferentialState x("", jacobian_matrix_rows, 1);  // position
+  Control v("", jacobian_matrix_columns, 1);         // velocity
+
+  // online data, layout [ Jacobian (row major) | collision activation | collision distance | terminal control ]
+  OnlineData Jacobian_Matrix("", jacobian_matrix_rows, jacobian_matrix_columns);
+  OnlineData activation;
+  OnlineData total_distance;
+  OnlineData terminal_control("", jacobian_matrix_columns, 1);
+
+  // Differential Kinematic
+  DifferentialEquation f;
+  f << dot(x) == (Jacobian_Matrix * v);
+
+  // collision cost, -(normal_vector^T * Jacobian_Matrix) * v + d / t , t = 1.0 / (L/n)
+  Expression expression = total_distance * self_collision_cost_constant_term;
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    for (int j = 0u; j < jacobian_matrix_rows; ++j)
+    {
+      expression = expression - Jacobian_Matrix(j, i) * v(i);
+    }
+  }
+
+  // LSQ function, same terms as generateCostFunction and generateCollisionCostFunction of pd_frame_tracker,
+  // layout [ states | controls | collision cost | controls with collision activation ],
+  // references of state filled with goal pose
+  Function h, hN;
+  for (int i = 0u; i < jacobian_matrix_rows; ++i)
+  {
+    h << x(i);
+    hN << x(i);
+  }
+
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    h << v(i);
+  }
+
+  h << activation * expression;
+
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    h << activation * v(i);
+  }
+
+  // weighting matrices are set at runtime from lsq weight factors, exporter needs terminal term but symbolic problem
+  // has none, so terminal weighting matrix stays zero (see pd_rti_solver::initialize)
+  BMatrix W = eye<bool>(h.getDim());
+  BMatrix WN = eye<bool>(hN.getDim());
+
+  // Optimal control problem
+  OCP OCP_problem(start_time, end_time, discretization_intervals);
+  OCP_problem.minimizeLSQ(W, h);
+  OCP_problem.minimizeLSQEndTerm(WN, hN);
+  OCP_problem.subjectTo(f);
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    OCP_problem.subjectTo(joints_vel_min_limit[i] <= v(i) <= joints_vel_max_limit[i]);
+  }
+
+  // terminal control, last control of horizon equal to given control (AT_END of symbolic problem, exported code has
+  // no control at end node so constraint placed on last interval)
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    OCP_problem.subjectTo(discretization_intervals - 1, v(i) - terminal_control(i) == 0.0);
+  }
+
+  // export real time iteration solver
+  OCPexport OCP_export(OCP_problem);
+  OCP_export.set(HESSIAN_APPROXIMATION, GAUSS_NEWTON);
+  OCP_export.set(DISCRETIZATION_TYPE, MULTIPLE_SHOOTING);
+  OCP_export.set(SPARSE_QP_SOLUTION, FULL_CONDENSING_N2);
+  OCP_export.set(INTEGRATOR_TYPE, INT_RK4);
+  OCP_export.set(NUM_INTEGRATOR_STEPS, discretization_intervals);
+  OCP_export.set(QP_SOLVER, QP_QPOASES);
+  OCP_export.set(HOTSTART_QP, YES);
+  OCP_export.set(GENERATE_TEST_FILE, NO);
+  OCP_export.set(GENERATE_MAKE_FILE, NO);
+  OCP_export.set(GENERATE_MATLAB_INTERFACE, NO);
+  OCP_export.set(GENERATE_SIMULINK_INTERFACE, NO);
+
+  if (OCP_export.exportCode(argv[2]) != SUCCESSFUL_RETURN)
+  {
+    std::cerr << "predictive_solver_generator: Failed to export code to " << argv[2] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  OCP_export.printDimensionsQP();
+
+  return EXIT_SUCCESS;
+}
@@ -5,6 +5,10 @@
 
 pd_frame_tracker::pd_frame_tracker()
 {
+  OCP_solver_initialized_ = false;
+  use_ltv_model_ = false;
+  use_jacobian_derivative_ = false;
+  use_effort_constraints_ = false;
   // clearDataMember();
 }
 
@@ -18,8 +22,9 @@ void pd_frame_tracker::clearDataMember()
 {
   // resize matrix and vectors
   const int jacobian_matrix_rows = 6, jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
-  Jacobian_Matrix_.resize(jacobian_matrix_rows, jacobian_matrix_columns);
-  Jacobian_Matrix_.setAll(0.0);
+  online_parameter_.resize(jacobian_matrix_rows * jacobian_matrix_columns + jacobian_matrix_rows + 2 +
+                           jacobian_matrix_columns);
+  online_parameter_.setAll(0.0);
   state_initialize_.resize(jacobian_matrix_rows);
   state_initialize_.setAll(0.0);
   control_initialize_.resize(jacobian_matrix_columns);
@@ -50,8 +55,9 @@ bool pd_frame_tracker::initialize()
 
   // intialize data members
   const int jacobian_matrix_rows = 6, jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
-  Jacobian_Matrix_.resize(jacobian_matrix_rows, jacobian_matrix_columns);
-  Jacobian_Matrix_.setAll(1E-5);
+  online_parameter_.resize(jacobian_matrix_rows * jacobian_matrix_columns + jacobian_matrix_rows + 2 +
+                           jacobian_matrix_columns);
+  online_parameter_.setAll(1E-5);
   state_initialize_.resize(jacobian_matrix_rows);
   state_initialize_.setAll(1E-5);
   control_initialize_.resize(jacobian_matrix_columns);
@@ -93,10 +99,202 @@ bool pd_frame_tracker::initialize()
   // slef collision cost constant term
   self_collision_cost_constant_term_ = discretization_intervals_ / (end_time_ - start_time_);
 
+  // select optimal control solver
+  solver_mode_ = predictive_configuration::solver_mode_;
+  warm_start_ = predictive_configuration::warm_start_;
+
+  // fallback trajectory empty until first usable solve, means zero velocity
+  fallback_controls_.setZero(jacobian_matrix_columns * discretization_intervals_);
+  control_trajectory_.setZero(jacobian_matrix_columns * discretization_intervals_);
+  fallback_index_ = discretization_intervals_;
+  commanded_interval_ = discretization_intervals_;
+  solver_statistics_.deadline = predictive_configuration::solver_deadline_;
+
+  if (solver_mode_ == "generated")
+  {
+#ifdef PREDICTIVE_CONTROL_GENERATED_SOLVER
+    rti_solver_.reset(new pd_rti_solver());
+    // collision cost weight same as symbolic formulation, see generateCollisionCostFunction
+    if (!rti_solver_->initialize(predictive_configuration::degree_of_freedom_, lsq_state_weight_factors_,
+                                 lsq_control_weight_factors_, 0.5))
+    {
+      ROS_ERROR("pd_frame_tracker: Failed to initialize generated solver");
+      return false;
+    }
+#else
+    ROS_WARN("pd_frame_tracker: Build without generated solver (USE_GENERATED_RTI_SOLVER), use 'acado' solver mode");
+    solver_mode_ = "acado";
+#endif
+  }
+
+  else if (solver_mode_ == "condensed_qp")
+  {
+    condensed_qp_solver_.reset(new pd_condensed_qp_tracker());
+    if (!condensed_qp_solver_->initialize())
+    {
+      ROS_ERROR("pd_frame_tracker: Failed to initialize condensed QP solver");
+      return false;
+    }
+  }
+
+  else if (solver_mode_ != "acado")
+  {
+    ROS_WARN("pd_frame_tracker: Unknown solver mode '%s', use 'acado' solver mode", solver_mode_.c_str());
+    solver_mode_ = "acado";
+  }
+
+  // linear time varying model, supported by solvers with stage wise online data
+  use_ltv_model_ = predictive_configuration::use_ltv_model_;
+  if (use_ltv_model_ && solver_mode_ == "acado")
+  {
+    ROS_WARN("pd_frame_tracker: LTV model needs 'generated' or 'condensed_qp' solver mode, use constant Jacobian");
+    use_ltv_model_ = false;
+  }
+
+  if (use_ltv_model_)
+  {
+    ltv_kinematic_solver_.reset(new Kinematic_calculations());
+    if (!ltv_kinematic_solver_->initialize())
+    {
+      ROS_ERROR("pd_frame_tracker: Failed to initialize kinematic solver of LTV model");
+      return false;
+    }
+
+    stage_jacobians_.resize(discretization_intervals_, Eigen::MatrixXd::Zero(6, jacobian_matrix_columns));
+    predicted_joint_position_.setZero(jacobian_matrix_columns);
+    predicted_FK_Matrix_ = Eigen::MatrixXd::Identity(4, 4);
+
+    use_jacobian_derivative_ = predictive_configuration::use_jacobian_derivative_;
+    stage_joint_velocity_.setZero(jacobian_matrix_columns);
+    stage_jacobian_derivative_.setZero(6, jacobian_matrix_columns);
+  }
+
+  // effort constraints, supported by solver with limits per interval
+  use_effort_constraints_ = predictive_configuration::use_effort_constraints_;
+  if (use_effort_constraints_ && solver_mode_ != "condensed_qp")
+  {
+    ROS_WARN("pd_frame_tracker: Effort constraints need 'condensed_qp' solver mode, use velocity limits only");
+    use_effort_constraints_ = false;
+  }
+
+  if (use_effort_constraints_)
+  {
+    dynamics_solver_ = ltv_kinematic_solver_;
+    if (!dynamics_solver_)
+    {
+      dynamics_solver_.reset(new Kinematic_calculations());
+      if (!dynamics_solver_->initialize())
+      {
+        ROS_ERROR("pd_frame_tracker: Failed to initialize kinematic solver of effort constraints");
+        return false;
+      }
+    }
+
+    mass_matrix_.setZero(jacobian_matrix_columns, jacobian_matrix_columns);
+    bias_effort_.setZero(jacobian_matrix_columns);
+    stage_control_min_.setZero(jacobian_matrix_columns * discretization_intervals_);
+    stage_control_max_.setZero(jacobian_matrix_columns * discretization_intervals_);
+  }
+
+  // build symbolic problem and solver once, control loop only update online parameters
+  if (solver_mode_ == "acado" && !setupOptimalControlProblem())
+  {
+    ROS_ERROR("pd_frame_tracker: Failed to setup optimal control problem");
+    return false;
+  }
+
   ROS_WARN("PD_FRAME_TRACKER INITIALIZED!!");
   return true;
 }
 
+// create optimal control problem and real time solver, called only once from initialize
+bool pd_frame_tracker::setupOptimalControlProblem()
+{
+  const unsigned int jacobian_matrix_rows = 6;
+  const unsigned int jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
+
+  // Clear state, control and parameter counters, declaration order gives index of each variable
+  DifferentialState().clearStaticCounters();
+  Control().clearStaticCounters();
+  Parameter().clearStaticCounters();
+
+  // OCP variables
+  x_.reset(new DifferentialState("", jacobian_matrix_rows, 1));  // position
+  v_.reset(new Control("", jacobian_matrix_columns, 1));         // velocity
+
+  // online parameters, same order as updateOnlineParameters fill online_parameter_
+  // symbolic ACADO has no OnlineData (code generation only), Parameter is time constant decision variable but
+  // init/feedbackStep fix it to given vector, solveOptimalControlProblem check that solution keep given values
+  jacobian_parameter_.reset(new Parameter("", jacobian_matrix_rows, jacobian_matrix_columns));
+  goal_parameter_.reset(new Parameter("", jacobian_matrix_rows, 1));
+  collision_activation_parameter_.reset(new Parameter("", 1, 1));
+  collision_distance_parameter_.reset(new Parameter("", 1, 1));
+  terminal_control_parameter_.reset(new Parameter("", jacobian_matrix_columns, 1));
+
+  // Differential Kinematic
+  f_.reset(new DifferentialEquation());
+  *f_ << dot(*x_) == ((*jacobian_parameter_) * (*v_));
+
+  // Optimal control problem
+  // here end time interpriate as control and/or prdiction horizon, choose maximum 4.0 till that gives better results
+  OCP_problem_.reset(new OCP(start_time_, end_time_, discretization_intervals_));
+
+  // generate cost function
+  generateCostFunction(*OCP_problem_, *x_, *v_, *goal_parameter_);
+
+  // generate collision cost function, switched on/off using activation parameter
+  generateCollisionCostFunction(*OCP_problem_, *v_, *jacobian_parameter_, *collision_activation_parameter_,
+                                *collision_distance_parameter_, 0.0);
+
+  OCP_problem_->subjectTo(*f_);
+  OCP_problem_->subjectTo(-1.00 <= *v_ <= 1.00);
+  // OCP_problem.subjectTo(AT_START, v == );
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    OCP_problem_->subjectTo(AT_END, (*v_)(i) - (*terminal_control_parameter_)(i) == 0.0);
+  }
+
+  // Optimal Control Algorithm
+  OCP_solver_.reset(new RealTimeAlgorithm(*OCP_problem_, sampling_time_));
+  setAlgorithmOptions(*OCP_solver_);
+  OCP_solver_initialized_ = false;
+
+  return true;
+}
+
+// fill online parameters, order should be same as declaration in setupOptimalControlProblem
+void pd_frame_tracker::updateOnlineParameters(const Eigen::MatrixXd& Jacobian_Matrix, const Eigen::VectorXd& goal_pose,
+                                              const double& self_collision_vector,
+                                              const std_msgs::Float64MultiArray& controlled_velocity)
+{
+  int index = 0u;
+
+  // Jacobian matrix, row major
+  for (int i = 0u; i < Jacobian_Matrix.rows(); ++i)
+  {
+    for (int j = 0u; j < Jacobian_Matrix.cols(); ++j, ++index)
+    {
+      online_parameter_(index) = Jacobian_Matrix(i, j);
+    }
+  }
+
+  // goal pose
+  for (int i = 0u; i < goal_pose.size(); ++i, ++index)
+  {
+    online_parameter_(index) = goal_pose(i);
+  }
+
+  // collision cost only active when distance cost above threshold
+  online_parameter_(index++) = (self_collision_vector > (0.15 + 0.10)) ? 1.0 : 0.0;
+  online_parameter_(index++) = self_collision_vector;
+
+  // terminal control
+  for (int i = 0u; i < controlled_velocity.data.size(); ++i, ++index)
+  {
+    online_parameter_(index) = controlled_velocity.data[i];
+  }
+}
+
 // calculate quternion product
 void pd_frame_tracker::calculateQuaternionProduct(const geometry_msgs::Quaternion& quat_1,
                                                   const geometry_msgs::Quaternion& quat_2,
@@ -128,63 +326,34 @@ void pd_frame_tracker::calculateQuaternionInverse(const geometry_msgs::Quaternio
   quat_inv.z = -quat.z;
 }
 
-// get transformation matrix between source and target frame
-bool pd_frame_tracker::getTransform(const std::string& from, const std::string& to, Eigen::VectorXd& stamped_pose,
-                                    geometry_msgs::Quaternion& quat_msg)
+// orientation of pose vector (rpy) as quaternion
+void pd_frame_tracker::getQuaternionFromPose(const Eigen::VectorXd& pose, geometry_msgs::Quaternion& quat_msg)
 {
-  bool transform = false;
-  stamped_pose = Eigen::VectorXd(6);
-  tf::StampedTransform stamped_tf;
-
-  // make sure source and target frame exist
-  if (tf_listener_.frameExists(to) & tf_listener_.frameExists(from))
-  {
-    try
-    {
-      // find transforamtion between souce and target frame
-      tf_listener_.waitForTransform(from, to, ros::Time(0), ros::Duration(0.2));
-      tf_listener_.lookupTransform(from, to, ros::Time(0), stamped_tf);
+  tf::Quaternion quat;
+  quat.setRPY(pose(3), pose(4), pose(5));
 
-      // translation
-      stamped_pose(0) = stamped_tf.getOrigin().x();
-      stamped_pose(1) = stamped_tf.getOrigin().y();
-      stamped_pose(2) = stamped_tf.getOrigin().z();
-
-      // convert quternion to rpy
-      tf::Quaternion quat(stamped_tf.getRotation().getX(), stamped_tf.getRotation().getY(),
-                          stamped_tf.getRotation().getZ(), stamped_tf.getRotation().getW());
-
-      // filled quaternion stamped pose
-      quat_msg.w = quat.w();
-      quat_msg.x = quat.x();
-      quat_msg.y = quat.y();
-      quat_msg.z = quat.z();
-
-      tf::Matrix3x3 quat_matrix(quat);
-      quat_matrix.getRPY(stamped_pose(3), stamped_pose(4), stamped_pose(5));
-
-      transform = true;
-    }
-    catch (tf::TransformException& ex)
-    {
-      ROS_ERROR("pd_frame_tracker::getTransform: %s", ex.what());
-    }
-  }
-
-  else
-  {
-    ROS_WARN("pd_frame_tracker::getTransform: '%s' or '%s' frame doesn't exist, pass existing frame", from.c_str(),
-             to.c_str());
-  }
-
-  return transform;
+  quat_msg.w = quat.w();
+  quat_msg.x = quat.x();
+  quat_msg.y = quat.y();
+  quat_msg.z = quat.z();
 }
 
 // Generate collision cost used to avoid self collision
 void pd_frame_tracker::generateCollisionCostFunction(OCP& OCP_problem, const Control& v,
-                                                     const Eigen::MatrixXd& Jacobian_Matrix,
-                                                     const double& total_distance, const double& delta_t)
+                                                     const Expression& Jacobian_Matrix, const Expression& activation,
+                                                     const Expression& total_distance, const double& delta_t)
 {
+  // http://doc.aldebaran.com/2-1/naoqi/motion/reflexes-collision-avoidance.html
+  // -(normal_vector^T * Jacobian_Matrix) * v + d / t , t = 1.0 / (L/n)
+  Expression expression = total_distance * self_collision_cost_constant_term_;
+  for (int i = 0u; i < control_vector_size_; ++i)
+  {
+    for (int j = 0u; j < Jacobian_Matrix.getNumRows(); ++j)
+    {
+      expression = expression - Jacobian_Matrix(j, i) * v(i);
+    }
+  }
+
   if (use_mayer_term_)
   {
     ;
@@ -192,53 +361,22 @@ void pd_frame_tracker::generateCollisionCostFunction(OCP& OCP_problem, const Con
 
   if (use_lagrange_term_)
   {
-    DVector normal_vector(Jacobian_Matrix.rows());
-    normal_vector.setAll(1.0);
-
-    DVector create_expression_vec = -(normal_vector.transpose() * Jacobian_Matrix_);
-
-    Expression expression(create_expression_vec);
-    // http://doc.aldebaran.com/2-1/naoqi/motion/reflexes-collision-avoidance.html
-    expression = expression.transpose() * v + total_distance * (self_collision_cost_constant_term_);
-    //  d / t , t = 1.0 / (L/n)
-
-    OCP_problem.minimizeLagrangeTerm(expression);
+    OCP_problem.minimizeLagrangeTerm(activation * expression);
   }
 
   if (use_LSQ_term_)
   {
-    ROS_ERROR_STREAM("************ CALLING COLLISION COST FUNCTION *****************");
-
-    DVector normal_vector(Jacobian_Matrix.rows());
-    normal_vector.setAll(1.0);
-
-    DVector create_expression_vec = -(normal_vector.transpose() * Jacobian_Matrix_);
-
-    Expression expression(create_expression_vec);
-    // http://doc.aldebaran.com/2-1/naoqi/motion/reflexes-collision-avoidance.html
-    expression = expression.transpose() * v + total_distance * (self_collision_cost_constant_term_);
-    //  d / t , t = 1.0 / (L/n)
-
-    // Expression expression(1);
-    // expression = total_distance + v.transpose()*v;
-
-    ROS_ERROR("====================================================================");
-    //     ROS_WARN_STREAM( expression.print(std::cout) );
-    ROS_ERROR("====================================================================");
-
-    // Expression expression(1.0);
-    // expression = total_distance + 0.5*(v.transpose()*v);
-
     Function h;
-    h << expression;
+    h << activation * expression;
 
     // initialize function with controls
     for (int i = 0u; i < control_vector_size_; ++i)
     {
-      h << v(i);
+      h << activation * v(i);
     }
 
     DMatrix Q(h.getDim(), h.getDim());
+    Q.setAll(0.0);
     Q(0, 0) = 0.5;
 
     // weighting of control weight, should filled after state wieghting factor
@@ -261,7 +399,7 @@ void pd_frame_tracker::generateCollisionCostFunction(OCP& OCP_problem, const Con
 
 // Generate cost function of optimal control problem
 void pd_frame_tracker::generateCostFunction(OCP& OCP_problem, const DifferentialState& x, const Control& v,
-                                            const Eigen::VectorXd& goal_pose)
+                                            const Expression& goal_pose)
 {
   if (use_mayer_term_)
   {
@@ -344,6 +482,7 @@ void pd_frame_tracker::generateCostFunction(OCP& OCP_problem, const Differential
 
     // initialization of weighting matrix
     DMatrix Q(h.getDim(), h.getDim());
+    Q.setAll(0.0);
 
     // weighting of state weight
     for (int i = 0u; i < (state_vector_size_); ++i)  //&& lsq_state_vector_size
@@ -370,179 +509,409 @@ void pd_frame_tracker::generateCostFunction(OCP& OCP_problem, const Differential
 }
 
 void pd_frame_tracker::solveOptimalControlProblem(const Eigen::MatrixXd& Jacobian_Matrix,
+                                                  const Eigen::VectorXd& joint_position,
                                                   const Eigen::VectorXd& last_position,
                                                   const Eigen::VectorXd& goal_pose, const double& self_collision_vector,
                                                   const Eigen::VectorXd& static_collision_vector,
                                                   std_msgs::Float64MultiArray& controlled_velocity)
 {
-  state_initialize_.setAll(1E-5);
-  control_initialize_.setAll(1E-5);
-  Jacobian_Matrix_.setAll(1E-5);
+  const unsigned int jacobian_matrix_rows = 6;  // Jacobian_Matrix.rows();
+  const unsigned int jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
 
-  Jacobian_Matrix_ = Jacobian_Matrix;
-  // control initialize
-  control_initialize_(0) = controlled_velocity.data[0];
-  control_initialize_(1) = controlled_velocity.data[1];
-  control_initialize_(2) = controlled_velocity.data[2];
-  control_initialize_(3) = controlled_velocity.data[3];
-  control_initialize_(4) = controlled_velocity.data[4];
-  control_initialize_(5) = controlled_velocity.data[5];
-  control_initialize_(6) = controlled_velocity.data[6];
+  // compute budget counted from start of tick
+  const ros::WallTime tick_start = ros::WallTime::now();
 
   // state initialize
-  state_initialize_(0) = last_position(0);
-  state_initialize_(1) = last_position(1);
-  state_initialize_(2) = last_position(2);
-  state_initialize_(3) = last_position(3);
-  state_initialize_(4) = last_position(4);
-  state_initialize_(5) = last_position(5);
-
-  std::cout << "\033[32m"
-            << "____OLD GOAL POSE _______" << goal_pose.transpose() << "______"
-            << "\033[36;0m" << std::endl;
-
-  // calculate quaternion error
-  Eigen::VectorXd pose = goal_pose;
-  Eigen::VectorXd temp = last_position;
-  geometry_msgs::Quaternion quat_tracking, quat_target, quat_inv, quat_error;
-  // current gripper pose
-  getTransform(predictive_configuration::chain_root_link_, predictive_configuration::tracking_frame_, temp,
-               quat_tracking);
-  // current frame tracker pose
-  getTransform(predictive_configuration::chain_root_link_, predictive_configuration::target_frame_, temp, quat_target);
-
-  calculateQuaternionInverse(quat_tracking, quat_inv);
-  calculateQuaternionProduct(quat_inv, quat_target, quat_error);
-
-  tf::Quaternion quat(quat_error.x, quat_error.y, quat_error.z, quat_error.w);
-  tf::Matrix3x3 matrix(quat);
-
-  double r, p, y;
-  matrix.getRPY(r, p, y);
-  pose(3) = r;
-  pose(4) = p;
-  pose(5) = y;
-  std::cout << "\033[32m"
-            << "____NEW GOAL POSE _______" << pose.transpose() << "______"
-            << "\033[36;0m" << std::endl;
-
-  std::cout << "\033[95m"
-            << "________________________" << self_collision_vector << "___________________"
-            << "\033[36;0m" << std::endl;
-
-  const unsigned int jacobian_matrix_rows = 6;     // Jacobian_Matrix.rows();
-  const unsigned int jacobian_matrix_columns = 7;  // Jacobian_Matrix.cols();
+  for (int i = 0u; i < jacobian_matrix_rows; ++i)
+  {
+    state_initialize_(i) = last_position(i);
+  }
 
-  // OCP variables
-  DifferentialState x("", jacobian_matrix_rows, 1);  // position
-  Control v("", jacobian_matrix_columns, 1);         // velocity
+  // control initialize
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    control_initialize_(i) = controlled_velocity.data[i];
+  }
 
-  // Clear state, control variable
-  x.clearStaticCounters();
-  v.clearStaticCounters();
+  // DEBUG, orientation error between current and goal pose only needed by log message
+  if (PD_LOG_ENABLED(PD_LOG_LEVEL_DEBUG))
+  {
+    PD_LOG_DEBUG_VALUES("pd_frame_tracker: goal pose:", goal_pose.data(), goal_pose.size());
+
+    // calculate quaternion error
+    Eigen::VectorXd pose = goal_pose;
+    geometry_msgs::Quaternion quat_tracking, quat_target, quat_inv, quat_error;
+    // current gripper pose, computed by forward kinematic
+    getQuaternionFromPose(last_position, quat_tracking);
+    // current frame tracker pose, taken from transform cache of controller
+    getQuaternionFromPose(goal_pose, quat_target);
+
+    calculateQuaternionInverse(quat_tracking, quat_inv);
+    calculateQuaternionProduct(quat_inv, quat_target, quat_error);
+
+    tf::Quaternion quat(quat_error.x, quat_error.y, quat_error.z, quat_error.w);
+    tf::Matrix3x3 matrix(quat);
+
+    double r, p, y;
+    matrix.getRPY(r, p, y);
+    pose(3) = r;
+    pose(4) = p;
+    pose(5) = y;
+    PD_LOG_DEBUG_VALUES("pd_frame_tracker: goal pose with orientation error:", pose.data(), pose.size());
+    PD_LOG_DEBUG("pd_frame_tracker: self collision cost: %f", self_collision_vector);
+  }
 
-  // Differential Equation
-  DifferentialEquation f;
+  // native condensed QP solver, terminal control pinned to last controlled velocity
+  if (solver_mode_ == "condensed_qp")
+  {
+    terminal_control_.resize(jacobian_matrix_columns);
+    controlled_velocity.data.resize(jacobian_matrix_columns, 0.0);
+    for (int i = 0u; i < jacobian_matrix_columns; ++i)
+    {
+      terminal_control_(i) = controlled_velocity.data[i];
+    }
 
-  // Differential Kinematic
-  f << dot(x) == (Jacobian_Matrix_ * v);
+    if (use_effort_constraints_)
+    {
+      updateEffortLimits(joint_position, terminal_control_);
+    }
 
-  // Optimal control problem
-  // here end time interpriate as control and/or prdiction horizon, choose maximum 4.0 till that gives better results
-  OCP OCP_problem(start_time_, end_time_, discretization_intervals_);
+    // work before solve used up budget, no time left to iterate (zero budget would disable deadline of core)
+    const double time_budget = predictive_configuration::solver_deadline_ - (ros::WallTime::now() - tick_start).toSec();
+    if (time_budget <= 0.0)
+    {
+      updateSolverStatistics(tick_start, MPC_CORE_FAILED, 0);
+      applyFallbackControl(controlled_velocity);
+      return;
+    }
 
-  // generate cost function
-  generateCostFunction(OCP_problem, x, v, goal_pose);
+    const double collision_activation = (self_collision_vector > (0.15 + 0.10)) ? 1.0 : 0.0;
+    condensed_qp_solver_->setDeadline(time_budget);
+    if (use_ltv_model_)
+    {
+      updateStageJacobians(Jacobian_Matrix, joint_position);
+      condensed_qp_solver_->solve(stage_jacobians_, last_position, goal_pose, collision_activation,
+                                  self_collision_vector, terminal_control_, control_);
+    }
+    else
+    {
+      condensed_qp_solver_->solve(Jacobian_Matrix, last_position, goal_pose, collision_activation,
+                                  self_collision_vector, terminal_control_, control_);
+    }
 
-  // generate collision cost function
-  if (self_collision_vector > (0.15 + 0.10))
-  {
-    generateCollisionCostFunction(OCP_problem, v, Jacobian_Matrix_, self_collision_vector, 0.0);
-  }
-  //--------------------------------------------------- static collision cost ------------------
-  DVector normal_vector(Jacobian_Matrix.rows());
-  normal_vector.setAll(1.0);
+    const int status = condensed_qp_solver_->getStatus();
+    updateSolverStatistics(tick_start, status, condensed_qp_solver_->getNumIterations());
+    if (status == MPC_CORE_FAILED)
+    {
+      applyFallbackControl(controlled_velocity);
+      return;
+    }
 
-  DVector create_expression_vec = -(normal_vector.transpose() * Jacobian_Matrix_);
+    condensed_qp_solver_->getPredictedControls(control_trajectory_);
+    storeFallbackTrajectory(control_trajectory_, 1);
 
-  Expression expression(create_expression_vec);
-  // http://doc.aldebaran.com/2-1/naoqi/motion/reflexes-collision-avoidance.html
-  expression = expression.transpose() * v + static_collision_vector.sum() * (self_collision_cost_constant_term_);
-  //  d / t , t = 1.0 / (L/n)
+    for (int i = 0u; i < jacobian_matrix_columns; ++i)
+    {
+      controlled_velocity.data[i] = control_(i);
+    }
+    return;
+  }
 
-  Function h;
-  h << expression;
+#ifdef PREDICTIVE_CONTROL_GENERATED_SOLVER
+  // generated solver, one real time iteration with static memory
+  if (solver_mode_ == "generated")
+  {
+    Eigen::VectorXd u;
+    const double collision_activation = (self_collision_vector > (0.15 + 0.10)) ? 1.0 : 0.0;
 
-  DMatrix Q(1, 1);
-  Q(0, 0) = 0.0001;
+    if (!OCP_solver_initialized_ || !warm_start_)
+    {
+      rti_solver_->initializeHorizon(last_position);
+      OCP_solver_initialized_ = true;
+    }
 
-  DVector ref(1);
-  ref.setAll(0.0);
+    bool success = false;
+    if (use_ltv_model_)
+    {
+      updateStageJacobians(Jacobian_Matrix, joint_position);
+      success = rti_solver_->solve(stage_jacobians_, last_position, goal_pose, collision_activation,
+                                   self_collision_vector, control_initialize_, u);
+    }
+    else
+    {
+      success = rti_solver_->solve(Jacobian_Matrix, last_position, goal_pose, collision_activation,
+                                   self_collision_vector, control_initialize_, u);
+    }
 
-  /*if (self_collision_vector.sum() >= 1000)
-  {
-    Q(0,0) = 0.001;
-  }*/
+    // single real time iteration, can not stop early, only check deadline afterwards
+    updateSolverStatistics(tick_start, success ? MPC_CORE_CONVERGED : MPC_CORE_FAILED, 1);
+    if (!success)
+    {
+      // restart from current state at next tick
+      OCP_solver_initialized_ = false;
+      applyFallbackControl(controlled_velocity);
+      return;
+    }
 
-  // create objective function
-  // OCP_problem.minimizeLSQ(Q, h, ref);
+    rti_solver_->getPredictedControls(control_trajectory_);
+    storeFallbackTrajectory(control_trajectory_, 1);
 
-  // set constraints related to collision cost
-  // OCP_problem.subjectTo(0.0 <= expression <= 5.0);
-  // OCP_problem.subjectTo(expression <= 5.0);
+    if (warm_start_)
+    {
+      rti_solver_->shiftHorizon();
+    }
 
-  //-----------------------------------------------------------------------------------------------------
-  OCP_problem.subjectTo(f);
-  OCP_problem.subjectTo(-1.00 <= v <= 1.00);
-  // OCP_problem.subjectTo(AT_START, v == );
-  OCP_problem.subjectTo(AT_END, v == control_initialize_);  // 0.0
+    controlled_velocity.data.resize(jacobian_matrix_columns, 0.0);
+    for (int i = 0u; i < jacobian_matrix_columns; ++i)
+    {
+      controlled_velocity.data[i] = u(i);
+    }
+    return;
+  }
+#endif
 
-  // Optimal Control Algorithm
-  RealTimeAlgorithm OCP_solver(OCP_problem, 0.025);  // 0.025 sampling time
+  // update Jacobian, goal pose, collision terms and terminal control, no symbolic setup at this point
+  updateOnlineParameters(Jacobian_Matrix, goal_pose, self_collision_vector, controlled_velocity);
 
-  OCP_solver.initializeControls(control_initialize_);
-  OCP_solver.initializeDifferentialStates(state_initialize_);
+  // first call (or cold start) initialize solver, with warm start solver keep shifted solution of previous step
+  if (!OCP_solver_initialized_ || !warm_start_)
+  {
+    OCP_solver_->initializeControls(control_initialize_);
+    OCP_solver_->initializeDifferentialStates(state_initialize_);
+    OCP_solver_->init(0.0, state_initialize_, online_parameter_);
+    OCP_solver_->preparationStep();
+    OCP_solver_initialized_ = true;
+  }
 
-  setAlgorithmOptions(OCP_solver);
+  returnValue feedback_status = OCP_solver_->feedbackStep(state_initialize_, online_parameter_);
 
-  // setup controller
-  Controller controller(OCP_solver);
-  controller.init(0.0, state_initialize_);
-  controller.step(0.0, state_initialize_);
+  // single real time iteration, can not stop early, only check deadline afterwards
+  updateSolverStatistics(tick_start, (feedback_status == SUCCESSFUL_RETURN) ? MPC_CORE_CONVERGED : MPC_CORE_FAILED, 1);
+  if (feedback_status != SUCCESSFUL_RETURN)
+  {
+    // re-initialize from current state at next tick
+    OCP_solver_initialized_ = false;
+    applyFallbackControl(controlled_velocity);
+    return;
+  }
+
+  // parameters must stay fixed at online values, optimizer moving Jacobian or goal pose means solution of other problem
+  DVector solved_parameter;
+  OCP_solver_->getParameters(solved_parameter);
+  if (solved_parameter.size() != online_parameter_.size() ||
+      (solved_parameter - online_parameter_).cwiseAbs().maxCoeff() > 1e-8)
+  {
+    ROS_WARN_THROTTLE(1.0, "pd_frame_tracker: Online parameters changed by solver, use fallback control");
+    OCP_solver_initialized_ = false;
+    applyFallbackControl(controlled_velocity);
+    return;
+  }
 
   // get control at first step and update controlled velocity vector
   DVector u;
-  controller.getU(u);
-  ROS_WARN("================");
-  u.print();
-  ROS_WARN("================");
+  OCP_solver_->getU(u);
+
+  // keep control trajectory as fallback command of next ticks
+  OCP_solver_->getControls(predicted_controls_);
+  for (int node = 0u; node < discretization_intervals_ && node < predicted_controls_.getNumPoints(); ++node)
+  {
+    for (int i = 0u; i < jacobian_matrix_columns; ++i)
+    {
+      control_trajectory_(node * jacobian_matrix_columns + i) = predicted_controls_(node, i);
+    }
+  }
+  storeFallbackTrajectory(control_trajectory_, 1);
+
+  // shift states, controls and multipliers one interval backwards (last interval doubled), hot started QP of next
+  // feedback step start from this shifted solution
+  if (warm_start_)
+  {
+    OCP_solver_->shift();
+  }
+
+  // prepare next feedback step while control is applied
+  OCP_solver_->preparationStep();
+  PD_LOG_DEBUG_VALUES("pd_frame_tracker: control:", u.data(), u.size());
   controlled_velocity.data.resize(jacobian_matrix_columns, 0.0);
 
   for (int i = 0u; i < jacobian_matrix_columns; ++i)
   {
     controlled_velocity.data[i] = u(i);
   }
-  /*if (static_collision_vector.sum() >= 0.15)
+}
+
+// Jacobian along joint trajectory predicted by shifted solution of previous solve
+void pd_frame_tracker::updateStageJacobians(const Eigen::MatrixXd& Jacobian_Matrix,
+                                            const Eigen::VectorXd& joint_position)
+{
+  const int jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
+  const double delta_t = (end_time_ - start_time_) / discretization_intervals_;
+
+  // first interval at measured configuration
+  stage_jacobians_[0] = Jacobian_Matrix;
+  predicted_joint_position_ = joint_position.head(jacobian_matrix_columns);
+
+  // fallback_index_ point to interval of stored trajectory applied at current tick
+  for (int k = 0u; k < discretization_intervals_; ++k)
+  {
+    if (k > 0)
+    {
+      ltv_kinematic_solver_->calculateJacobianMatrix(predicted_joint_position_, predicted_FK_Matrix_,
+                                                     stage_jacobians_[k]);
+    }
+
+    const int interval = fallback_index_ + k;
+    if (interval < discretization_intervals_)
+    {
+      stage_joint_velocity_ = fallback_controls_.segment(interval * jacobian_matrix_columns, jacobian_matrix_columns);
+    }
+    else
+    {
+      stage_joint_velocity_.setZero();
+    }
+
+    // pose change over interval: integral of J(q(t)) * v dt ~ (J + 0.5 * dt * dJ/dt) * v * dt
+    if (use_jacobian_derivative_)
+    {
+      ltv_kinematic_solver_->calculateJacobianDerivative(predicted_joint_position_, stage_joint_velocity_,
+                                                         stage_jacobian_derivative_);
+      stage_jacobians_[k] += (0.5 * delta_t) * stage_jacobian_derivative_;
+    }
+
+    predicted_joint_position_ += delta_t * stage_joint_velocity_;
+  }
+}
+
+// acceleration box around zero, row i of M * a + h stays inside effort limits when sum_j |M_ij| * s / M_jj <= slack_i
+void pd_frame_tracker::updateEffortLimits(const Eigen::VectorXd& joint_position, const Eigen::VectorXd& joint_velocity)
+{
+  const int jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
+  const double delta_t = (end_time_ - start_time_) / discretization_intervals_;
+
+  dynamics_solver_->calculateMassMatrix(joint_position, mass_matrix_);
+  dynamics_solver_->calculateBiasEffort(joint_position, joint_velocity, bias_effort_);
+
+  // effort limits of dynamics solver, urdf limits when not configured
+  double scale = std::numeric_limits<double>::infinity();
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
   {
-    for (int i=0u; i < jacobian_matrix_columns; ++i)
+    const double min_effort = dynamics_solver_->joints_effort_min_limit_.at(i);
+    const double max_effort = dynamics_solver_->joints_effort_max_limit_.at(i);
+    if (max_effort <= min_effort)
     {
-      controlled_velocity.data[i] = u(i)*0.01;
+      continue;
     }
+
+    // bias effort beyond limit, hold velocity of this tick
+    const double slack = std::max(std::min(max_effort - bias_effort_(i), bias_effort_(i) - min_effort), 0.0);
+    double row = 0.0;
+    for (int j = 0u; j < jacobian_matrix_columns; ++j)
+    {
+      row += std::fabs(mass_matrix_(i, j)) / std::max(mass_matrix_(j, j), 1e-6);
+    }
+    scale = std::min(scale, slack / row);
+  }
+
+  // all joints unlimited
+  if (!std::isfinite(scale))
+  {
+    condensed_qp_solver_->setStageControlLimits(Eigen::VectorXd(), Eigen::VectorXd());
+    return;
   }
-  else
+
+  // velocity of interval k reachable from last controlled velocity within k + 1 intervals
+  for (int k = 0u; k < discretization_intervals_; ++k)
   {
-    for (int i=0u; i < jacobian_matrix_columns; ++i)
+    for (int j = 0u; j < jacobian_matrix_columns; ++j)
     {
-      controlled_velocity.data[i] = u(i);
+      const double velocity_change = (k + 1) * delta_t * scale / std::max(mass_matrix_(j, j), 1e-6);
+      stage_control_min_(k * jacobian_matrix_columns + j) = joint_velocity(j) - velocity_change;
+      stage_control_max_(k * jacobian_matrix_columns + j) = joint_velocity(j) + velocity_change;
     }
-  }*/
-  /* controlled_velocity.data[0] = u(0);
-   controlled_velocity.data[1] = u(1);
-   controlled_velocity.data[2] = u(2);
-   controlled_velocity.data[3] = u(3);
-   controlled_velocity.data[4] = u(4);
-   controlled_velocity.data[5] = u(5);
-   controlled_velocity.data[6] = u(6);*/
+  }
+
+  condensed_qp_solver_->setStageControlLimits(stage_control_min_, stage_control_max_);
+}
+
+// keep control trajectory of usable solve
+void pd_frame_tracker::storeFallbackTrajectory(const Eigen::VectorXd& controls, const int& next_index)
+{
+  const int size = std::min<int>(controls.size(), fallback_controls_.size());
+  fallback_controls_.head(size) = controls.head(size);
+  fallback_index_ = next_index;
+  commanded_interval_ = std::max(next_index - 1, 0);
+}
+
+// apply next control of stored trajectory, one interval per tick same as shift of warm start
+void pd_frame_tracker::applyFallbackControl(std_msgs::Float64MultiArray& controlled_velocity)
+{
+  const int jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
+  controlled_velocity.data.resize(jacobian_matrix_columns, 0.0);
+
+  // trajectory exhausted, stop manipulator
+  if (fallback_index_ >= discretization_intervals_)
+  {
+    ROS_ERROR("pd_frame_tracker: No usable solution and fallback trajectory exhausted, command zero velocity");
+    for (int i = 0u; i < jacobian_matrix_columns; ++i)
+    {
+      controlled_velocity.data[i] = 0.0;
+    }
+    commanded_interval_ = discretization_intervals_;
+    return;
+  }
+
+  ROS_WARN("pd_frame_tracker: No usable solution, apply interval %d of previous trajectory", fallback_index_);
+  for (int i = 0u; i < jacobian_matrix_columns; ++i)
+  {
+    controlled_velocity.data[i] = fallback_controls_(fallback_index_ * jacobian_matrix_columns + i);
+  }
+  commanded_interval_ = fallback_index_;
+  ++fallback_index_;
+  ++solver_statistics_.fallbacks;
+}
+
+// remaining trajectory from commanded interval on, used by high rate interpolation
+void pd_frame_tracker::getCommandedTrajectory(Eigen::VectorXd& controls) const
+{
+  const int jacobian_matrix_columns = predictive_configuration::degree_of_freedom_;
+  const int remaining = std::max(discretization_intervals_ - commanded_interval_, 0) * jacobian_matrix_columns;
+
+  controls.setZero(fallback_controls_.size());
+  controls.head(remaining) = fallback_controls_.tail(remaining);
+}
+
+// counters of control loop, kept with solver counters so both published as one message
+void pd_frame_tracker::updateControllerStatistics(const uint64_t& timer_overruns, const double& latency)
+{
+  solver_statistics_.timer_overruns = timer_overruns;
+  solver_statistics_.latency = latency;
+}
+
+// compute time and deadline counters of current tick
+void pd_frame_tracker::updateSolverStatistics(const ros::WallTime& tick_start, const int& status,
+                                              const int& iterations)
+{
+  const double solve_time = (ros::WallTime::now() - tick_start).toSec();
+
+  solver_statistics_.header.stamp = ros::Time::now();
+  solver_statistics_.solve_time = solve_time;
+  solver_statistics_.max_solve_time = std::max(solver_statistics_.max_solve_time, solve_time);
+  solver_statistics_.iterations = iterations;
+  ++solver_statistics_.ticks;
+
+  if (status == MPC_CORE_DEADLINE_REACHED)
+  {
+    ++solver_statistics_.deadline_hits;
+  }
+  else if (status == MPC_CORE_CONVERGED && solve_time <= solver_statistics_.deadline)
+  {
+    ++solver_statistics_.converged;
+  }
+
+  if (solve_time > solver_statistics_.deadline)
+  {
+    ++solver_statistics_.deadline_misses;
+  }
 }
 
 // setup acado algorithm options, need to set solver when calling this function
@@ -0,0 +1,221 @@
+// This file containts allocation free rigid body dynamics (mass matrix and inverse dynamics) of serial chain
+
+#include <predictive_control/rigid_body_dynamics.h>
+
+RigidBodyDynamics::RigidBodyDynamics() : degree_of_freedom_(0), gravity_(0.0, 0.0, -9.81)
+{
+}
+
+bool RigidBodyDynamics::initialize(const KinematicEngine& engine, const std::vector<double>& masses,
+                                   const std::vector<Eigen::Vector3d>& centers_of_mass,
+                                   const std::vector<Eigen::Matrix3d>& inertias)
+{
+  const std::size_t segments = engine.getNumberOfSegments();
+  if (engine.getDegreeOfFreedom() == 0 || masses.size() != segments || centers_of_mass.size() != segments ||
+      inertias.size() != segments)
+  {
+    degree_of_freedom_ = 0;
+    return false;
+  }
+
+  degree_of_freedom_ = engine.getDegreeOfFreedom();
+  engine_ = engine;
+  engine_.setIncremental(false, 0.0);
+
+  masses_ = masses;
+  centers_of_mass_ = centers_of_mass;
+  inertias_ = inertias;
+
+  axes_.setZero(3, segments);
+  angular_velocities_.setZero(3, segments);
+  angular_accelerations_.setZero(3, segments);
+  linear_accelerations_.setZero(3, segments);
+  forces_.setZero(3, segments);
+  moments_.setZero(3, segments);
+
+  composite_masses_.assign(segments, 0.0);
+  composite_centers_.setZero(3, segments);
+  composite_inertias_.assign(segments, Eigen::Matrix3d::Zero());
+
+  zero_acceleration_.setZero(degree_of_freedom_);
+  joints_effort_.setZero(degree_of_freedom_);
+  mass_matrix_.setZero(degree_of_freedom_, degree_of_freedom_);
+
+  return true;
+}
+
+void RigidBodyDynamics::setGravity(const Eigen::Vector3d& gravity)
+{
+  gravity_ = gravity;
+}
+
+// forward pass propagate motion from root to tip, backward pass accumulate forces from tip to root
+// joint of segment i rotate about axis z_i through origin p_i of segment tip frame
+const Eigen::VectorXd& RigidBodyDynamics::calculateInverseDynamics(const Eigen::VectorXd& joints_angle,
+                                                                   const Eigen::VectorXd& joints_velocity,
+                                                                   const Eigen::VectorXd& joints_acceleration)
+{
+  engine_.calculateForwardKinematics(joints_angle);
+  const int segments = masses_.size();
+
+  // base does not move, gravity applied as upward acceleration of base
+  Eigen::Vector3d parent_origin = Eigen::Vector3d::Zero();
+  Eigen::Vector3d parent_angular_velocity = Eigen::Vector3d::Zero();
+  Eigen::Vector3d parent_angular_acceleration = Eigen::Vector3d::Zero();
+  Eigen::Vector3d parent_linear_acceleration = -gravity_;
+
+  for (int i = 0u, joint = 0u; i < segments; ++i)
+  {
+    const Eigen::Isometry3d& pose = engine_.getSegmentPose(i);
+    const Eigen::Vector3d origin = pose.translation();
+    const Eigen::Vector3d link = origin - parent_origin;
+
+    linear_accelerations_.col(i) = parent_linear_acceleration + parent_angular_acceleration.cross(link) +
+                                   parent_angular_velocity.cross(parent_angular_velocity.cross(link));
+
+    if (engine_.getJointType(i) != KINEMATIC_JOINT_FIXED)
+    {
+      const Eigen::Vector3d axis = pose.linear() * engine_.getJointAxis(i);
+      axes_.col(i) = axis;
+      angular_velocities_.col(i) = parent_angular_velocity + joints_velocity(joint) * axis;
+      angular_accelerations_.col(i) = parent_angular_acceleration + joints_acceleration(joint) * axis +
+                                      joints_velocity(joint) * parent_angular_velocity.cross(axis);
+      ++joint;
+    }
+    else
+    {
+      angular_velocities_.col(i) = parent_angular_velocity;
+      angular_accelerations_.col(i) = parent_angular_acceleration;
+    }
+
+    // Newton and Euler equation of segment body about its center of mass
+    const Eigen::Vector3d w = angular_velocities_.col(i);
+    const Eigen::Vector3d w_dot = angular_accelerations_.col(i);
+    const Eigen::Vector3d center = pose.linear() * centers_of_mass_[i];
+    const Eigen::Matrix3d inertia = pose.linear() * inertias_[i] * pose.linear().transpose();
+
+    forces_.col(i) =
+        masses_[i] * (linear_accelerations_.col(i) + w_dot.cross(center) + w.cross(w.cross(center)));
+    moments_.col(i) = inertia * w_dot + w.cross(inertia * w);
+
+    parent_origin = origin;
+    parent_angular_velocity = w;
+    parent_angular_acceleration = w_dot;
+    parent_linear_acceleration = linear_accelerations_.col(i);
+  }
+
+  // force and moment (about origin of segment) transmitted by joint of segment i
+  Eigen::Vector3d child_origin = Eigen::Vector3d::Zero();
+  Eigen::Vector3d child_force = Eigen::Vector3d::Zero();
+  Eigen::Vector3d child_moment = Eigen::Vector3d::Zero();
+
+  for (int i = segments - 1, joint = degree_of_freedom_ - 1; i >= 0; --i)
+  {
+    const Eigen::Isometry3d& pose = engine_.getSegmentPose(i);
+    const Eigen::Vector3d origin = pose.translation();
+    const Eigen::Vector3d center = pose.linear() * centers_of_mass_[i];
+
+    const Eigen::Vector3d force = forces_.col(i) + child_force;
+    const Eigen::Vector3d moment = moments_.col(i) + center.cross(forces_.col(i)) + child_moment +
+                                   (child_origin - origin).cross(child_force);
+
+    if (engine_.getJointType(i) != KINEMATIC_JOINT_FIXED)
+    {
+      joints_effort_(joint) = axes_.col(i).dot(moment);
+      --joint;
+    }
+
+    child_origin = origin;
+    child_force = force;
+    child_moment = moment;
+  }
+
+  return joints_effort_;
+}
+
+const Eigen::VectorXd& RigidBodyDynamics::calculateBiasEffort(const Eigen::VectorXd& joints_angle,
+                                                              const Eigen::VectorXd& joints_velocity)
+{
+  return calculateInverseDynamics(joints_angle, joints_velocity, zero_acceleration_);
+}
+
+// composite body of subtree i moves rigidly with unit acceleration of joint i, its momentum rate projected on axis of
+// every joint j <= i gives M(j, i)
+const Eigen::MatrixXd& RigidBodyDynamics::calculateMassMatrix(const Eigen::VectorXd& joints_angle)
+{
+  engine_.calculateForwardKinematics(joints_angle);
+  const int segments = masses_.size();
+
+  // composite bodies from tip to root, parallel axis theorem about combined center of mass
+  for (int i = segments - 1; i >= 0; --i)
+  {
+    const Eigen::Isometry3d& pose = engine_.getSegmentPose(i);
+    const Eigen::Vector3d center = pose * centers_of_mass_[i];
+    const Eigen::Matrix3d inertia = pose.linear() * inertias_[i] * pose.linear().transpose();
+
+    if (engine_.getJointType(i) != KINEMATIC_JOINT_FIXED)
+    {
+      axes_.col(i) = pose.linear() * engine_.getJointAxis(i);
+    }
+
+    if (i == segments - 1)
+    {
+      composite_masses_[i] = masses_[i];
+      composite_centers_.col(i) = center;
+      composite_inertias_[i] = inertia;
+      continue;
+    }
+
+    const double child_mass = composite_masses_[i + 1];
+    const double mass = masses_[i] + child_mass;
+    if (mass <= 0.0)
+    {
+      composite_masses_[i] = 0.0;
+      composite_centers_.col(i) = center;
+      composite_inertias_[i].setZero();
+      continue;
+    }
+
+    const Eigen::Vector3d composite_center = (masses_[i] * center + child_mass * composite_centers_.col(i + 1)) / mass;
+    const Eigen::Vector3d d = center - composite_center;
+    const Eigen::Vector3d d_child = composite_centers_.col(i + 1) - composite_center;
+
+    composite_masses_[i] = mass;
+    composite_centers_.col(i) = composite_center;
+    composite_inertias_[i] = inertia + composite_inertias_[i + 1];
+    composite_inertias_[i] += masses_[i] * (d.squaredNorm() * Eigen::Matrix3d::Identity() - d * d.transpose());
+    composite_inertias_[i] +=
+        child_mass * (d_child.squaredNorm() * Eigen::Matrix3d::Identity() - d_child * d_child.transpose());
+  }
+
+  for (int i = 0u, column = 0u; i < segments; ++i)
+  {
+    if (engine_.getJointType(i) == KINEMATIC_JOINT_FIXED)
+    {
+      continue;
+    }
+
+    // momentum rate of composite body i, force and moment about its center of mass
+    const Eigen::Vector3d axis = axes_.col(i);
+    const Eigen::Vector3d center = composite_centers_.col(i);
+    const Eigen::Vector3d force =
+        composite_masses_[i] * axis.cross(center - engine_.getSegmentPose(i).translation());
+    const Eigen::Vector3d moment = composite_inertias_[i] * axis;
+
+    for (int j = 0u, row = 0u; j <= i; ++j)
+    {
+      if (engine_.getJointType(j) == KINEMATIC_JOINT_FIXED)
+      {
+        continue;
+      }
+
+      const Eigen::Vector3d lever = center - engine_.getSegmentPose(j).translation();
+      mass_matrix_(row, column) = axes_.col(j).dot(moment + lever.cross(force));
+      mass_matrix_(column, row) = mass_matrix_(row, column);
+      ++row;
+    }
+    ++column;
+  }
+
+  return mass_matrix_;
+}
@@ -0,0 +1,326 @@
+// This file containts vectorized pairwise self collision cost and gradient of collision model spheres
+
+#include <predictive_control/self_collision_kernel.h>
+
+#include <cmath>
+#include <cstdlib>
+
+#if defined(PREDICTIVE_CONTROL_AVX2) && defined(__AVX2__)
+#include <immintrin.h>
+#define PREDICTIVE_CONTROL_COLLISION_AVX2
+#endif
+
+// one pair per lane, fallback and remaining pairs of row
+struct CollisionScalarLane
+{
+  typedef double Type;
+  static const int WIDTH = 1;
+
+  static Type load(const double* data)
+  {
+    return *data;
+  }
+  static void store(double* data, const Type& value)
+  {
+    *data = value;
+  }
+  static Type broadcast(const double& value)
+  {
+    return value;
+  }
+  static Type add(const Type& a, const Type& b)
+  {
+    return a + b;
+  }
+  static Type sub(const Type& a, const Type& b)
+  {
+    return a - b;
+  }
+  static Type mul(const Type& a, const Type& b)
+  {
+    return a * b;
+  }
+  // a * b + c
+  static Type fmadd(const Type& a, const Type& b, const Type& c)
+  {
+    return a * b + c;
+  }
+  static Type exp(const Type& x)
+  {
+    return std::exp(x);
+  }
+  // zero lanes of excluded pairs, bit k of bits belongs to lane k
+  static Type maskOut(const Type& value, const uint64_t& bits)
+  {
+    return (bits & 1u) ? 0.0 : value;
+  }
+  static double sum(const Type& value)
+  {
+    return value;
+  }
+};
+
+#ifdef PREDICTIVE_CONTROL_COLLISION_AVX2
+// four pairs per lane
+struct CollisionAvx2Lane
+{
+  typedef __m256d Type;
+  static const int WIDTH = 4;
+
+  static Type load(const double* data)
+  {
+    return _mm256_loadu_pd(data);
+  }
+  static void store(double* data, const Type& value)
+  {
+    _mm256_storeu_pd(data, value);
+  }
+  static Type broadcast(const double& value)
+  {
+    return _mm256_set1_pd(value);
+  }
+  static Type add(const Type& a, const Type& b)
+  {
+    return _mm256_add_pd(a, b);
+  }
+  static Type sub(const Type& a, const Type& b)
+  {
+    return _mm256_sub_pd(a, b);
+  }
+  static Type mul(const Type& a, const Type& b)
+  {
+    return _mm256_mul_pd(a, b);
+  }
+  static Type fmadd(const Type& a, const Type& b, const Type& c)
+  {
+#ifdef __FMA__
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+  }
+
+  // cephes exp: x = n * ln2 + r, Pade approximation of exp(r) on |r| <= ln2 / 2, result scaled by 2^n through exponent
+  static Type exp(const Type& value)
+  {
+    const __m256d x = _mm256_min_pd(_mm256_max_pd(value, _mm256_set1_pd(-708.0)), _mm256_set1_pd(708.0));
+    const __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634073599)),
+                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = fmadd(n, _mm256_set1_pd(-6.93145751953125E-1), x);
+    r = fmadd(n, _mm256_set1_pd(-1.42860682030941723212E-6), r);
+    const __m256d rr = _mm256_mul_pd(r, r);
+
+    __m256d p = _mm256_set1_pd(1.26177193074810590878E-4);
+    p = fmadd(p, rr, _mm256_set1_pd(3.02994407707441961300E-2));
+    p = fmadd(p, rr, _mm256_set1_pd(9.99999999999999999910E-1));
+    p = _mm256_mul_pd(p, r);
+
+    __m256d q = _mm256_set1_pd(3.00198505138664455042E-6);
+    q = fmadd(q, rr, _mm256_set1_pd(2.52448340349684104192E-3));
+    q = fmadd(q, rr, _mm256_set1_pd(2.27265548208155028766E-1));
+    q = fmadd(q, rr, _mm256_set1_pd(2.00000000000000000009E0));
+
+    // exp(r) = 1 + 2 p / (q - p)
+    const __m256d e = fmadd(_mm256_set1_pd(2.0), _mm256_div_pd(p, _mm256_sub_pd(q, p)), _mm256_set1_pd(1.0));
+
+    // 2^n from biased exponent bits
+    const __m256i exponent = _mm256_slli_epi64(
+        _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)), _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(e, _mm256_castsi256_pd(exponent));
+  }
+
+  static Type maskOut(const Type& value, const uint64_t& bits)
+  {
+    const __m256i lanes = _mm256_set_epi64x(8, 4, 2, 1);
+    const __m256i excluded = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(bits), lanes), lanes);
+    return _mm256_andnot_pd(_mm256_castsi256_pd(excluded), value);
+  }
+
+  static double sum(const Type& value)
+  {
+    const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+  }
+};
+#endif
+
+SelfCollisionKernel::SelfCollisionKernel() : spheres_(0), words_per_row_(0)
+{
+}
+
+bool SelfCollisionKernel::isVectorized()
+{
+#ifdef PREDICTIVE_CONTROL_COLLISION_AVX2
+  return true;
+#else
+  return false;
+#endif
+}
+
+// one padding word per row, bits of four pairs can be read across word boundary
+void SelfCollisionKernel::initialize(const CollisionModel& model, const bool& ignore_adjacent_links)
+{
+  spheres_ = model.getNumberOfSpheres();
+  words_per_row_ = spheres_ / 64 + 2;
+  mask_.assign(spheres_ * words_per_row_, 0u);
+
+  sphere_cost_.setZero(spheres_);
+  sphere_gradient_.setZero(spheres_, 3);
+  pair_cost_.setZero(spheres_, spheres_);
+  pair_gradient_x_.setZero(spheres_, spheres_);
+  pair_gradient_y_.setZero(spheres_, spheres_);
+  pair_gradient_z_.setZero(spheres_, spheres_);
+
+  const Eigen::VectorXi& link_id = model.getLinkId();
+  for (int i = 0u; i < spheres_; ++i)
+  {
+    ignorePair(i, i);
+    for (int j = i + 1; j < spheres_; ++j)
+    {
+      if (ignore_adjacent_links && std::abs(link_id(i) - link_id(j)) <= 1)
+      {
+        ignorePair(i, j);
+      }
+    }
+  }
+}
+
+void SelfCollisionKernel::ignorePair(const int& first, const int& second, const bool& ignore)
+{
+  const uint64_t first_bit = uint64_t(1) << (second & 63);
+  const uint64_t second_bit = uint64_t(1) << (first & 63);
+  uint64_t& first_word = mask_[first * words_per_row_ + (second >> 6)];
+  uint64_t& second_word = mask_[second * words_per_row_ + (first >> 6)];
+
+  if (ignore)
+  {
+    first_word |= first_bit;
+    second_word |= second_bit;
+  }
+  else
+  {
+    first_word &= ~first_bit;
+    second_word &= ~second_bit;
+  }
+}
+
+bool SelfCollisionKernel::ignorePair(const std::string& first, const std::string& second,
+                                     const CollisionModel& model)
+{
+  const int first_index = model.findSphere(first);
+  const int second_index = model.findSphere(second);
+  if (first_index < 0 || second_index < 0 || first_index >= spheres_ || second_index >= spheres_)
+  {
+    return false;
+  }
+
+  ignorePair(first_index, second_index);
+  return true;
+}
+
+bool SelfCollisionKernel::isPairIgnored(const int& first, const int& second) const
+{
+  return (mask_[first * words_per_row_ + (second >> 6)] >> (second & 63)) & 1u;
+}
+
+uint64_t SelfCollisionKernel::getMaskBits(const int& row, const int& j) const
+{
+  const uint64_t* words = &mask_[row * words_per_row_ + (j >> 6)];
+  const int shift = j & 63;
+  uint64_t bits = words[0] >> shift;
+  if (shift > 60)
+  {
+    bits |= words[1] << (64 - shift);
+  }
+  return bits;
+}
+
+double SelfCollisionKernel::evaluate(const CollisionModel& model, const double& collision_min_distance,
+                                     const double& weight_factor)
+{
+  sphere_cost_.setZero();
+  sphere_gradient_.setZero();
+
+  const double min_distance_squared = collision_min_distance * collision_min_distance;
+  const double inverse_weight = 1.0 / weight_factor;
+  for (int row = 0u; row < spheres_; ++row)
+  {
+    int j = row + 1;
+#ifdef PREDICTIVE_CONTROL_COLLISION_AVX2
+    j = evaluatePairs<CollisionAvx2Lane>(model, row, j, min_distance_squared, inverse_weight);
+#endif
+    evaluatePairs<CollisionScalarLane>(model, row, j, min_distance_squared, inverse_weight);
+  }
+
+  // every pair added to cost of both spheres
+  return 0.5 * sphere_cost_.sum();
+}
+
+// dx = x_row - x_j, c = exp((d_min^2 - |dx|^2) / w), dc/dp_row = g * dx with g = -2 / w * c, dc/dp_j = -g * dx
+template <typename Lane>
+int SelfCollisionKernel::evaluatePairs(const CollisionModel& model, const int& row, const int& begin,
+                                       const double& min_distance_squared, const double& inverse_weight)
+{
+  typedef typename Lane::Type T;
+
+  const double* x = model.getCenterX().data();
+  const double* y = model.getCenterY().data();
+  const double* z = model.getCenterZ().data();
+  double* sphere_cost = sphere_cost_.data();
+  double* gradient_x = sphere_gradient_.col(0).data();
+  double* gradient_y = sphere_gradient_.col(1).data();
+  double* gradient_z = sphere_gradient_.col(2).data();
+  double* pair_cost = pair_cost_.row(row).data();
+  double* pair_gradient_x = pair_gradient_x_.row(row).data();
+  double* pair_gradient_y = pair_gradient_y_.row(row).data();
+  double* pair_gradient_z = pair_gradient_z_.row(row).data();
+
+  const T x_row = Lane::broadcast(x[row]);
+  const T y_row = Lane::broadcast(y[row]);
+  const T z_row = Lane::broadcast(z[row]);
+  const T offset = Lane::broadcast(min_distance_squared);
+  const T scale = Lane::broadcast(inverse_weight);
+  const T gradient_scale = Lane::broadcast(-2.0 * inverse_weight);
+
+  T row_cost = Lane::broadcast(0.0);
+  T row_gradient_x = Lane::broadcast(0.0);
+  T row_gradient_y = Lane::broadcast(0.0);
+  T row_gradient_z = Lane::broadcast(0.0);
+
+  int j = begin;
+  for (; j + Lane::WIDTH <= spheres_; j += Lane::WIDTH)
+  {
+    const T dx = Lane::sub(x_row, Lane::load(x + j));
+    const T dy = Lane::sub(y_row, Lane::load(y + j));
+    const T dz = Lane::sub(z_row, Lane::load(z + j));
+    const T distance_squared = Lane::fmadd(dx, dx, Lane::fmadd(dy, dy, Lane::mul(dz, dz)));
+
+    const T cost = Lane::maskOut(Lane::exp(Lane::mul(Lane::sub(offset, distance_squared), scale)), getMaskBits(row, j));
+    const T g = Lane::mul(gradient_scale, cost);
+    const T gx = Lane::mul(g, dx);
+    const T gy = Lane::mul(g, dy);
+    const T gz = Lane::mul(g, dz);
+
+    Lane::store(pair_cost + j, cost);
+    Lane::store(pair_gradient_x + j, gx);
+    Lane::store(pair_gradient_y + j, gy);
+    Lane::store(pair_gradient_z + j, gz);
+
+    row_cost = Lane::add(row_cost, cost);
+    row_gradient_x = Lane::add(row_gradient_x, gx);
+    row_gradient_y = Lane::add(row_gradient_y, gy);
+    row_gradient_z = Lane::add(row_gradient_z, gz);
+
+    Lane::store(sphere_cost + j, Lane::add(Lane::load(sphere_cost + j), cost));
+    Lane::store(gradient_x + j, Lane::sub(Lane::load(gradient_x + j), gx));
+    Lane::store(gradient_y + j, Lane::sub(Lane::load(gradient_y + j), gy));
+    Lane::store(gradient_z + j, Lane::sub(Lane::load(gradient_z + j), gz));
+  }
+
+  sphere_cost[row] += Lane::sum(row_cost);
+  gradient_x[row] += Lane::sum(row_gradient_x);
+  gradient_y[row] += Lane::sum(row_gradient_y);
+  gradient_z[row] += Lane::sum(row_gradient_z);
+
+  return j;
+}
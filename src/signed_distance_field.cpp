@@ -0,0 +1,214 @@
+// This file containts signed distance field of static obstacles baked into voxel grid, rebaked in background thread
+
+#include <predictive_control/signed_distance_field.h>
+#include <predictive_control/collision_bvh.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+SignedDistanceGrid::SignedDistanceGrid() : version(-1), resolution_(0.0), inverse_resolution_(0.0)
+{
+  lower_.setZero();
+  points_.setZero();
+}
+
+bool SignedDistanceGrid::bake(const std::vector<CollisionPrimitive>& objects, const Eigen::Vector3d& lower,
+                              const Eigen::Vector3d& size, const double& resolution, const double& truncation,
+                              const std::atomic<bool>* cancel)
+{
+  lower_ = lower;
+  resolution_ = resolution;
+  inverse_resolution_ = 1.0 / resolution;
+  for (int i = 0u; i < 3; ++i)
+  {
+    points_(i) = std::max(static_cast<int>(std::ceil(size(i) * inverse_resolution_)) + 1, 2);
+  }
+  values_.assign(points_.prod(), static_cast<float>(truncation));
+
+  // only obstacles within truncation distance of grid point evaluated
+  CollisionBoundingVolumeHierarchy tree;
+  tree.build(objects);
+  std::vector<int> nearby_objects;
+
+  Eigen::Vector3d gradient;
+  int index = 0u;
+  for (int z = 0u; z < points_(2); ++z)
+  {
+    if (cancel && cancel->load(std::memory_order_relaxed))
+    {
+      return false;
+    }
+
+    for (int y = 0u; y < points_(1); ++y)
+    {
+      for (int x = 0u; x < points_(0); ++x, ++index)
+      {
+        const Eigen::Vector3d point = lower_ + resolution_ * Eigen::Vector3d(x, y, z);
+        tree.querySphere(point, truncation, nearby_objects);
+
+        double distance = truncation;
+        const int nearby = nearby_objects.size();
+        for (int k = 0u; k < nearby; ++k)
+        {
+          distance = std::min(distance, computeSignedDistance(objects[nearby_objects[k]], point, gradient));
+        }
+        values_[index] = static_cast<float>(distance);
+      }
+    }
+  }
+
+  return true;
+}
+
+bool SignedDistanceGrid::getDistance(const Eigen::Vector3d& point, double& distance, Eigen::Vector3d& gradient) const
+{
+  if (values_.empty())
+  {
+    return false;
+  }
+
+  // cell of point and position inside cell
+  const Eigen::Vector3d grid_point = (point - lower_) * inverse_resolution_;
+  int cell[3];
+  double f[3];
+  for (int i = 0u; i < 3; ++i)
+  {
+    if (!(grid_point(i) >= 0.0 && grid_point(i) <= points_(i) - 1))
+    {
+      return false;
+    }
+    cell[i] = std::min(static_cast<int>(grid_point(i)), points_(i) - 2);
+    f[i] = grid_point(i) - cell[i];
+  }
+
+  const double c000 = getValue(cell[0], cell[1], cell[2]);
+  const double c100 = getValue(cell[0] + 1, cell[1], cell[2]);
+  const double c010 = getValue(cell[0], cell[1] + 1, cell[2]);
+  const double c110 = getValue(cell[0] + 1, cell[1] + 1, cell[2]);
+  const double c001 = getValue(cell[0], cell[1], cell[2] + 1);
+  const double c101 = getValue(cell[0] + 1, cell[1], cell[2] + 1);
+  const double c011 = getValue(cell[0], cell[1] + 1, cell[2] + 1);
+  const double c111 = getValue(cell[0] + 1, cell[1] + 1, cell[2] + 1);
+
+  // interpolate along x, then y, then z
+  const double c00 = c000 + f[0] * (c100 - c000);
+  const double c10 = c010 + f[0] * (c110 - c010);
+  const double c01 = c001 + f[0] * (c101 - c001);
+  const double c11 = c011 + f[0] * (c111 - c011);
+  const double c0 = c00 + f[1] * (c10 - c00);
+  const double c1 = c01 + f[1] * (c11 - c01);
+  distance = c0 + f[2] * (c1 - c0);
+
+  // derivative of interpolation with respect to cell position, scaled to metric
+  const double dx0 = (c100 - c000) + f[1] * ((c110 - c010) - (c100 - c000));
+  const double dx1 = (c101 - c001) + f[1] * ((c111 - c011) - (c101 - c001));
+  gradient(0) = (dx0 + f[2] * (dx1 - dx0)) * inverse_resolution_;
+  gradient(1) = ((c10 - c00) + f[2] * ((c11 - c01) - (c10 - c00))) * inverse_resolution_;
+  gradient(2) = (c1 - c0) * inverse_resolution_;
+
+  return true;
+}
+
+SignedDistanceField::SignedDistanceField()
+  : resolution_(0.0), truncation_(0.0), pending_version_(-1), pending_(false), cancel_(false), running_(false)
+{
+  lower_.setZero();
+  size_.setZero();
+}
+
+SignedDistanceField::~SignedDistanceField()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    running_ = false;
+    cancel_.store(true, std::memory_order_relaxed);
+  }
+  condition_.notify_one();
+
+  if (bake_thread_.joinable())
+  {
+    bake_thread_.join();
+  }
+}
+
+void SignedDistanceField::initialize(const Eigen::Vector3d& lower, const Eigen::Vector3d& size,
+                                     const double& resolution, const double& truncation)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  lower_ = lower;
+  size_ = size;
+  resolution_ = resolution;
+  truncation_ = truncation;
+
+  if (!running_)
+  {
+    running_ = true;
+    bake_thread_ = boost::thread(boost::bind(&SignedDistanceField::run, this));
+  }
+}
+
+void SignedDistanceField::requestBake(const std::vector<CollisionPrimitive>& objects, const int& version)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    pending_objects_ = objects;
+    pending_version_ = version;
+    pending_ = true;
+
+    // grid of older scene useless, stop its bake
+    cancel_.store(true, std::memory_order_relaxed);
+  }
+  condition_.notify_one();
+}
+
+boost::shared_ptr<const SignedDistanceGrid> SignedDistanceField::getGrid() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return grid_;
+}
+
+void SignedDistanceField::run()
+{
+  std::vector<CollisionPrimitive> objects;
+  for (;;)
+  {
+    Eigen::Vector3d lower, size;
+    double resolution, truncation;
+    int version;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (running_ && !pending_)
+      {
+        condition_.wait(lock);
+      }
+
+      if (!running_)
+      {
+        return;
+      }
+
+      objects.swap(pending_objects_);
+      version = pending_version_;
+      pending_ = false;
+      cancel_.store(false, std::memory_order_relaxed);
+
+      lower = lower_;
+      size = size_;
+      resolution = resolution_;
+      truncation = truncation_;
+    }
+
+    // bake without lock, queries keep using previous grid meanwhile
+    boost::shared_ptr<SignedDistanceGrid> grid(new SignedDistanceGrid());
+    if (!grid->bake(objects, lower, size, resolution, truncation, &cancel_))
+    {
+      continue;
+    }
+    grid->version = version;
+
+    boost::mutex::scoped_lock lock(mutex_);
+    grid_ = grid;
+  }
+}
@@ -0,0 +1,105 @@
+
+// This file containts non blocking latest value cache of single transform
+
+#include <predictive_control/transform_cache.h>
+
+TransformCache::TransformCache()
+{
+  tf_listener_ = NULL;
+}
+
+TransformCache::~TransformCache()
+{
+  timer_.stop();
+}
+
+// start refresh timer of cache
+bool TransformCache::initialize(ros::NodeHandle& nh, tf::TransformListener* tf_listener, const std::string& from,
+                                const std::string& to, const double& update_frequency)
+{
+  if (tf_listener == NULL || update_frequency <= 0.0)
+  {
+    ROS_ERROR("TransformCache: Invalid tf listener or update frequency %f", update_frequency);
+    return false;
+  }
+
+  tf_listener_ = tf_listener;
+  from_ = from;
+  to_ = to;
+  buffer_.initialize(CachedTransform());
+
+  timer_ = nh.createTimer(ros::Duration(1.0 / update_frequency), &TransformCache::updateCallBack, this);
+  timer_.start();
+
+  return true;
+}
+
+// change target frame, old transform is not valid anymore
+void TransformCache::setTargetFrame(const std::string& to)
+{
+  if (to == to_)
+  {
+    return;
+  }
+
+  to_ = to;
+  CachedTransform& cached = buffer_.getWriteBuffer();
+  cached.valid = false;
+  buffer_.publish();
+}
+
+// lookup latest transform without waiting
+void TransformCache::updateCallBack(const ros::TimerEvent& event)
+{
+  std::string error;
+  if (!tf_listener_->canTransform(from_, to_, ros::Time(0), &error))
+  {
+    ROS_WARN_THROTTLE(1.0, "TransformCache: '%s' to '%s' not available, %s", from_.c_str(), to_.c_str(),
+                      error.c_str());
+    return;
+  }
+
+  try
+  {
+    CachedTransform& cached = buffer_.getWriteBuffer();
+    tf_listener_->lookupTransform(from_, to_, ros::Time(0), cached.transform);
+    cached.valid = true;
+    buffer_.publish();
+  }
+  catch (tf::TransformException& ex)
+  {
+    ROS_WARN_THROTTLE(1.0, "TransformCache::updateCallBack: %s", ex.what());
+  }
+}
+
+// latest available transform
+bool TransformCache::getLatest(tf::StampedTransform& transform)
+{
+  buffer_.update();
+  const CachedTransform& cached = buffer_.getReadBuffer();
+  if (!cached.valid)
+  {
+    return false;
+  }
+
+  transform = cached.transform;
+  return true;
+}
+
+// latest available transform as pose vector, orientation in the form of rpy
+bool TransformCache::getLatestPose(Eigen::VectorXd& pose)
+{
+  tf::StampedTransform transform;
+  if (!getLatest(transform))
+  {
+    return false;
+  }
+
+  pose.resize(6);
+  pose(0) = transform.getOrigin().x();
+  pose(1) = transform.getOrigin().y();
+  pose(2) = transform.getOrigin().z();
+  tf::Matrix3x3(transform.getRotation()).getRPY(pose(3), pose(4), pose(5));
+
+  return true;
+}
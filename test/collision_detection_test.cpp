@@ -2,8 +2,283 @@
 #include <ros/ros.h>
 #include <Eigen/Core>
 #include <Eigen/LU>  //inverse of matrix
+#include <Eigen/Geometry>
 #include <predictive_control/kinematic_calculations.h>
 #include <predictive_control/collision_detection.h>
+#include <predictive_control/collision_bvh.h>
+#include <predictive_control/self_collision_kernel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// random static obstacles, boxes with random orientation and spheres
+static void createRandomObjects(const int& size, std::mt19937& generator, std::vector<CollisionPrimitive>& objects)
+{
+  std::uniform_real_distribution<double> position(-1.0, 1.0);
+  std::uniform_real_distribution<double> dimension(0.02, 0.3);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+
+  for (int i = 0u; i < size; ++i)
+  {
+    CollisionPrimitive object;
+    object.id = "object_" + std::to_string(objects.size());
+    object.type = (i % 2 == 0) ? COLLISION_PRIMITIVE_BOX : COLLISION_PRIMITIVE_SPHERE;
+    object.position << position(generator), position(generator), position(generator);
+    object.rotation = (Eigen::AngleAxisd(angle(generator), Eigen::Vector3d::UnitZ()) *
+                       Eigen::AngleAxisd(angle(generator), Eigen::Vector3d::UnitY()) *
+                       Eigen::AngleAxisd(angle(generator), Eigen::Vector3d::UnitX()))
+                          .toRotationMatrix();
+    if (object.type == COLLISION_PRIMITIVE_BOX)
+    {
+      object.dimensions << dimension(generator), dimension(generator), dimension(generator);
+    }
+    else
+    {
+      object.dimensions.setConstant(dimension(generator));
+    }
+    objects.push_back(object);
+  }
+}
+
+// compare overlap and nearest distance queries of tree against linear scan over all objects
+static bool checkQueries(const CollisionBoundingVolumeHierarchy& tree, const std::vector<CollisionPrimitive>& objects,
+                         std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> position(-1.2, 1.2);
+  std::uniform_real_distribution<double> radius(0.0, 0.4);
+
+  if (tree.getNumberOfObjects() != objects.size())
+  {
+    ROS_ERROR("checkQueries: tree holds %d objects, expected %d", tree.getNumberOfObjects(), int(objects.size()));
+    return false;
+  }
+
+  std::vector<int> nearby_objects;
+  Eigen::Vector3d gradient, min, max;
+  for (int k = 0u; k < 200; ++k)
+  {
+    const Eigen::Vector3d center(position(generator), position(generator), position(generator));
+    const double ball_radius = radius(generator);
+    const double influence_distance = radius(generator);
+
+    // overlap: every object whose bounding box is within radius, no more no less
+    tree.querySphere(center, ball_radius + influence_distance, nearby_objects);
+    std::vector<int> expected;
+    for (int i = 0u; i < objects.size(); ++i)
+    {
+      computeBoundingBox(objects[i], min, max);
+      const Eigen::Vector3d excess = (min - center).cwiseMax(center - max).cwiseMax(0.0);
+      if (excess.norm() <= ball_radius + influence_distance)
+      {
+        expected.push_back(i);
+      }
+    }
+
+    std::sort(nearby_objects.begin(), nearby_objects.end());
+    if (nearby_objects != expected)
+    {
+      ROS_ERROR("checkQueries: overlap query found %d objects, linear scan %d", int(nearby_objects.size()),
+                int(expected.size()));
+      return false;
+    }
+
+    // nearest distance: object nearer than influence distance always among query result
+    double nearest = std::numeric_limits<double>::infinity();
+    for (int i = 0u; i < objects.size(); ++i)
+    {
+      nearest = std::min(nearest, computeSphereSignedDistance(objects[i], center, ball_radius, gradient));
+    }
+
+    double nearest_nearby = std::numeric_limits<double>::infinity();
+    for (int i = 0u; i < nearby_objects.size(); ++i)
+    {
+      nearest_nearby = std::min(nearest_nearby,
+                                computeSphereSignedDistance(objects[nearby_objects[i]], center, ball_radius, gradient));
+    }
+
+    if ((nearest <= influence_distance && nearest_nearby != nearest) ||
+        (nearest > influence_distance && nearest_nearby <= influence_distance))
+    {
+      ROS_ERROR("checkQueries: nearest distance %f from query, %f from linear scan", nearest_nearby, nearest);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// bounding volume hierarchy against brute force, built tree and tree after incremental removals
+static bool checkBoundingVolumeHierarchy()
+{
+  std::mt19937 generator(42);
+  std::vector<CollisionPrimitive> objects;
+  createRandomObjects(300, generator, objects);
+
+  CollisionBoundingVolumeHierarchy tree;
+  tree.build(objects);
+  if (!checkQueries(tree, objects, generator))
+  {
+    return false;
+  }
+
+  // owner removes like StaticCollision: tree first, than swap with last and pop
+  for (int step = 0u; step < 60; ++step)
+  {
+    if (step % 10 == 9)
+    {
+      // added objects rebuild tree
+      createRandomObjects(20, generator, objects);
+      tree.build(objects);
+    }
+    else
+    {
+      const int height = tree.getHeight();
+      for (int k = 0u; k < 5 && !objects.empty(); ++k)
+      {
+        const int index = std::uniform_int_distribution<int>(0, objects.size() - 1)(generator);
+        tree.removeObject(index);
+        objects[index] = objects.back();
+        objects.pop_back();
+      }
+
+      if (tree.getHeight() > height)
+      {
+        ROS_ERROR("checkBoundingVolumeHierarchy: height grew by removal");
+        return false;
+      }
+    }
+
+    if (!checkQueries(tree, objects, generator))
+    {
+      ROS_ERROR("checkBoundingVolumeHierarchy: failed after step %d", step);
+      return false;
+    }
+  }
+
+  // remove all, tree empty
+  while (!objects.empty())
+  {
+    tree.removeObject(0);
+    objects[0] = objects.back();
+    objects.pop_back();
+  }
+
+  if (tree.getNumberOfObjects() != 0 || tree.getHeight() != 0)
+  {
+    ROS_ERROR("checkBoundingVolumeHierarchy: tree not empty after removing all objects");
+    return false;
+  }
+
+  ROS_INFO("checkBoundingVolumeHierarchy: passed");
+  return true;
+}
+
+// self collision kernel (AVX2 when built with USE_AVX2_COLLISION) against scalar reference of every pair,
+// sphere count spans three mask words so four pair windows read exclusion bits across word boundaries
+static bool checkSelfCollisionKernel()
+{
+  const int spheres = 150;
+  const double min_distance = 0.15;
+  const double weight = 0.01;
+
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> position(-0.4, 0.4);
+
+  // one segment per sphere, sphere at segment origin
+  CollisionModel model;
+  std::vector<Eigen::MatrixXd> FK_Homogenous_Matrix(spheres, Eigen::MatrixXd::Identity(4, 4));
+  for (int i = 0u; i < spheres; ++i)
+  {
+    model.addSphere("point_" + std::to_string(i), i, 1.0, 0.12);
+    FK_Homogenous_Matrix[i](0, 3) = position(generator);
+    FK_Homogenous_Matrix[i](1, 3) = position(generator);
+    FK_Homogenous_Matrix[i](2, 3) = position(generator);
+  }
+  model.updateCenters(FK_Homogenous_Matrix);
+
+  SelfCollisionKernel kernel;
+  kernel.initialize(model, true);
+
+  // pairs next to word boundaries of row, random pairs and pairs by name
+  std::uniform_int_distribution<int> index(0, spheres - 1);
+  const int boundary[] = { 60, 61, 62, 63, 64, 65, 66, 124, 126, 127, 128, 129, 131 };
+  for (int k = 0u; k < 40; ++k)
+  {
+    kernel.ignorePair(index(generator), boundary[k % 13]);
+    kernel.ignorePair(index(generator), index(generator));
+  }
+  if (!kernel.ignorePair("point_3", "point_64", model) || kernel.ignorePair("point_3", "point_unknown", model))
+  {
+    ROS_ERROR("checkSelfCollisionKernel: ignorePair by name failed");
+    return false;
+  }
+
+  // included again, bit cleared in both rows
+  kernel.ignorePair(5, 127, false);
+  if (kernel.isPairIgnored(5, 127) || kernel.isPairIgnored(127, 5) || !kernel.isPairIgnored(64, 3))
+  {
+    ROS_ERROR("checkSelfCollisionKernel: exclusion mask not symmetric");
+    return false;
+  }
+
+  const double total_cost = kernel.evaluate(model, min_distance, weight);
+
+  // scalar reference, std::exp and bit lookup per pair
+  const Eigen::VectorXd& x = model.getCenterX();
+  const Eigen::VectorXd& y = model.getCenterY();
+  const Eigen::VectorXd& z = model.getCenterZ();
+  Eigen::VectorXd sphere_cost = Eigen::VectorXd::Zero(spheres);
+  Eigen::MatrixX3d sphere_gradient = Eigen::MatrixX3d::Zero(spheres, 3);
+  double expected_total_cost = 0.0;
+  double error = 0.0;
+  for (int i = 0u; i < spheres; ++i)
+  {
+    for (int j = i + 1; j < spheres; ++j)
+    {
+      const Eigen::Vector3d d(x(i) - x(j), y(i) - y(j), z(i) - z(j));
+      const double cost =
+          kernel.isPairIgnored(i, j) ? 0.0 : std::exp((min_distance * min_distance - d.squaredNorm()) / weight);
+      const Eigen::Vector3d gradient = -2.0 / weight * cost * d;
+
+      error = std::max(error, std::abs(kernel.getPairCost()(i, j) - cost) / std::max(cost, 1e-300));
+      error = std::max(error, (Eigen::Vector3d(kernel.getPairGradientX()(i, j), kernel.getPairGradientY()(i, j),
+                                               kernel.getPairGradientZ()(i, j)) -
+                               gradient)
+                                      .norm() /
+                                  std::max(gradient.norm(), 1e-300));
+
+      if (kernel.isPairIgnored(i, j) && kernel.getPairCost()(i, j) != 0.0)
+      {
+        ROS_ERROR("checkSelfCollisionKernel: excluded pair (%d, %d) has cost %e", i, j, kernel.getPairCost()(i, j));
+        return false;
+      }
+
+      sphere_cost(i) += cost;
+      sphere_cost(j) += cost;
+      sphere_gradient.row(i) += gradient.transpose();
+      sphere_gradient.row(j) -= gradient.transpose();
+      expected_total_cost += cost;
+    }
+  }
+
+  const double tolerance = 1e-12;
+  if (error > tolerance ||
+      (kernel.getSphereCost() - sphere_cost).norm() > tolerance * std::max(sphere_cost.norm(), 1.0) ||
+      (kernel.getSphereGradient() - sphere_gradient).norm() > tolerance * std::max(sphere_gradient.norm(), 1.0) ||
+      std::abs(total_cost - expected_total_cost) > tolerance * std::max(expected_total_cost, 1.0))
+  {
+    ROS_ERROR("checkSelfCollisionKernel: %s kernel differs from scalar reference, pair error %e",
+              SelfCollisionKernel::isVectorized() ? "AVX2" : "scalar", error);
+    return false;
+  }
+
+  ROS_INFO("checkSelfCollisionKernel: %s kernel passed", SelfCollisionKernel::isVectorized() ? "AVX2" : "scalar");
+  return true;
+}
 
 int main(int argc, char** argv)
 {
@@ -12,6 +287,12 @@ int main(int argc, char** argv)
     ros::init(argc, argv, "kinematic_test");
     ros::NodeHandle node_handler;
 
+    // static obstacle queries and self collision kernel need no robot description
+    if (!checkBoundingVolumeHierarchy() || !checkSelfCollisionKernel())
+    {
+      exit(1);
+    }
+
     if (node_handler.hasParam("/robot_description"))
     {
       Kinematic_calculations kin_solver;
@@ -0,0 +1,243 @@
+
+#include <ros/ros.h>
+
+#include <predictive_control/condensed_qp_tracker.h>
+
+// acado includes, qpOASES solution of same QP as reference
+#include <acado_optimal_control.hpp>
+
+// condensed QP of one solve, build stage by stage from model x(k+1) = x(k) + dt * J * v(k) independent of closed
+// form of MpcCore, objective 0.5 * z^T H z + g^T z
+struct ReferenceQP
+{
+  Eigen::MatrixXd H;
+  Eigen::VectorXd g;
+  Eigen::VectorXd lb;
+  Eigen::VectorXd ub;
+};
+
+// collision weight of pd_condensed_qp_tracker::initialize
+static const double COLLISION_WEIGHT = 0.5;
+
+static void buildReferenceQP(const pd_condensed_qp_tracker& qp_tracker, const Eigen::MatrixXd& Jacobian_Matrix,
+                             const Eigen::VectorXd& current_pose, const Eigen::VectorXd& goal_pose,
+                             const double& collision_activation, const double& collision_distance,
+                             const Eigen::VectorXd& terminal_control, ReferenceQP& qp)
+{
+  const int degree_of_freedom = qp_tracker.degree_of_freedom_;
+  const int horizon = qp_tracker.discretization_intervals_;
+  const int variables = degree_of_freedom * horizon;
+  const double delta_t = (qp_tracker.end_time_horizon_ - qp_tracker.start_time_horizon_) / horizon;
+
+  Eigen::VectorXd state_weights(6), control_weights(degree_of_freedom);
+  for (int i = 0u; i < 6; ++i)
+  {
+    state_weights(i) = qp_tracker.lsq_state_weight_factors_.at(i);
+  }
+  for (int i = 0u; i < degree_of_freedom; ++i)
+  {
+    control_weights(i) = qp_tracker.lsq_control_weight_factors_.at(i);
+  }
+
+  qp.H.setZero(variables, variables);
+  qp.g.setZero(variables);
+  qp.lb.setZero(variables);
+  qp.ub.setZero(variables);
+
+  // pose error of stage k = 1..N, e(k) = e(0) + S(k) * z
+  const Eigen::VectorXd error = current_pose - goal_pose;
+  Eigen::MatrixXd S = Eigen::MatrixXd::Zero(6, variables);
+  for (int k = 0u; k < horizon; ++k)
+  {
+    S.block(0, k * degree_of_freedom, 6, degree_of_freedom) = delta_t * Jacobian_Matrix;
+    qp.H += S.transpose() * state_weights.asDiagonal() * S;
+    qp.g += S.transpose() * state_weights.asDiagonal() * error;
+  }
+
+  // control and collision cost w * (a * (d / dt - 1^T J v(k)))^2 of each stage
+  const Eigen::VectorXd collision_direction = Jacobian_Matrix.colwise().sum().transpose();
+  const double collision_weight = COLLISION_WEIGHT * collision_activation * collision_activation;
+  for (int k = 0u; k < horizon; ++k)
+  {
+    const int index = k * degree_of_freedom;
+    qp.H.block(index, index, degree_of_freedom, degree_of_freedom).diagonal() += control_weights;
+    qp.H.block(index, index, degree_of_freedom, degree_of_freedom) +=
+        collision_weight * collision_direction * collision_direction.transpose();
+    qp.g.segment(index, degree_of_freedom) -= (collision_weight * collision_distance / delta_t) * collision_direction;
+
+    for (int i = 0u; i < degree_of_freedom; ++i)
+    {
+      qp.lb(index + i) = qp_tracker.joints_vel_min_limit_.at(i);
+      qp.ub(index + i) = qp_tracker.joints_vel_max_limit_.at(i);
+    }
+  }
+
+  // last control pinned to terminal control, clipped into velocity limits
+  for (int i = 0u, k = variables - degree_of_freedom; i < degree_of_freedom; ++i, ++k)
+  {
+    qp.lb(k) = std::min(std::max(terminal_control(i), qp.lb(k)), qp.ub(k));
+    qp.ub(k) = qp.lb(k);
+  }
+}
+
+// every control inside velocity limits, last control equal to terminal control
+static bool checkBounds(const ReferenceQP& qp, const Eigen::VectorXd& controls, const double& tolerance)
+{
+  for (int i = 0u; i < controls.size(); ++i)
+  {
+    if (controls(i) < qp.lb(i) - tolerance || controls(i) > qp.ub(i) + tolerance)
+    {
+      ROS_ERROR("checkBounds: control %d = %f outside of [%f, %f]", i, controls(i), qp.lb(i), qp.ub(i));
+      return false;
+    }
+  }
+  return true;
+}
+
+// KKT conditions of box QP, gradient zero at free controls and pointing into box at active bounds
+static bool checkKKTResidual(const ReferenceQP& qp, const Eigen::VectorXd& controls, const double& tolerance)
+{
+  const Eigen::VectorXd gradient = qp.H * controls + qp.g;
+
+  double residual = 0.0;
+  for (int i = 0u; i < controls.size(); ++i)
+  {
+    if (qp.lb(i) >= qp.ub(i))
+    {
+      continue;
+    }
+
+    if (controls(i) <= qp.lb(i) + tolerance)
+    {
+      residual = std::max(residual, -gradient(i));
+    }
+    else if (controls(i) >= qp.ub(i) - tolerance)
+    {
+      residual = std::max(residual, gradient(i));
+    }
+    else
+    {
+      residual = std::max(residual, std::abs(gradient(i)));
+    }
+  }
+
+  if (residual > tolerance)
+  {
+    ROS_ERROR("checkKKTResidual: residual %e above tolerance %e", residual, tolerance);
+    return false;
+  }
+  return true;
+}
+
+// same QP solved by qpOASES of ACADO Toolkit
+static bool checkReferenceSolution(const ReferenceQP& qp, const Eigen::VectorXd& controls, const double& tolerance)
+{
+  USING_NAMESPACE_ACADO
+
+  DenseCP problem;
+  problem.init(qp.g.size(), 0);
+  problem.H = DMatrix(qp.H);
+  problem.g = DVector(qp.g);
+  problem.lb = DVector(qp.lb);
+  problem.ub = DVector(qp.ub);
+
+  QPsolver_qpOASES qp_solver;
+  DVector solution;
+  if (qp_solver.init(&problem) != SUCCESSFUL_RETURN || qp_solver.solve(&problem) != SUCCESSFUL_RETURN ||
+      qp_solver.getPrimalSolution(solution) != SUCCESSFUL_RETURN)
+  {
+    ROS_ERROR("checkReferenceSolution: qpOASES failed to solve reference QP");
+    return false;
+  }
+
+  const double difference = (controls - solution).cwiseAbs().maxCoeff();
+  if (difference > tolerance)
+  {
+    ROS_ERROR("checkReferenceSolution: controls differ from qpOASES solution by %e", difference);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    ros::init(argc, argv, "condensed_qp_tracker_test");
+    ros::NodeHandle node_handler;
+
+    pd_condensed_qp_tracker qp_tracker;
+    if (!qp_tracker.initialize())
+    {
+      ROS_ERROR(" -------- CONDENSED QP TRACKER INITIALIZATION FAILED!!! ------------- ");
+      exit(1);
+    }
+
+    const int degree_of_freedom = qp_tracker.degree_of_freedom_;
+    Eigen::VectorXd current_pose = Eigen::VectorXd::Zero(6);
+    Eigen::VectorXd goal_pose(6);
+    goal_pose << 1.2, -0.8, 0.4, 0.0, 0.4, -0.4;
+    Eigen::VectorXd terminal_control = Eigen::VectorXd::Zero(degree_of_freedom);
+    Eigen::VectorXd control, controls;
+    ReferenceQP qp;
+
+    // solution checked against reference QP, tolerance relative to kkt tolerance of active set method
+    const double bound_tolerance = 1e-9;
+    const double kkt_tolerance = 10.0 * qp_tracker.kkt_tolerance_;
+    const double solution_tolerance = 1e-5;
+
+    // closed loop with constant Jacobian, pose should converge towards goal pose, goal far enough that velocity
+    // limits become active, collision cost active in between
+    srand(1);
+    Eigen::MatrixXd Jacobian_Matrix = Eigen::MatrixXd::Random(6, degree_of_freedom);
+    const double delta_t = 1.0 / qp_tracker.clock_frequency_;
+
+    double solve_time = 0.0;
+    const int steps = 500;
+    for (int i = 0u; i < steps; ++i)
+    {
+      const double collision_activation = (i >= 100 && i < 150) ? 1.0 : 0.0;
+      const double collision_distance = 0.3;
+
+      ros::WallTime start = ros::WallTime::now();
+      const bool converged = qp_tracker.solve(Jacobian_Matrix, current_pose, goal_pose, collision_activation,
+                                              collision_distance, terminal_control, control);
+      solve_time += (ros::WallTime::now() - start).toSec();
+
+      if (!converged)
+      {
+        ROS_ERROR("condensed_qp_tracker_test: step %d not converged", i);
+        exit(1);
+      }
+
+      qp_tracker.getPredictedControls(controls);
+      buildReferenceQP(qp_tracker, Jacobian_Matrix, current_pose, goal_pose, collision_activation,
+                       collision_distance, terminal_control, qp);
+      if (!checkBounds(qp, controls, bound_tolerance) || !checkKKTResidual(qp, controls, kkt_tolerance) ||
+          !checkReferenceSolution(qp, controls, solution_tolerance))
+      {
+        ROS_ERROR("condensed_qp_tracker_test: step %d failed", i);
+        exit(1);
+      }
+
+      current_pose += delta_t * Jacobian_Matrix * control;
+      terminal_control = control;
+    }
+
+    std::cout << "Final pose error: \n"
+              << "\033[0;32m" << (goal_pose - current_pose).transpose() << "\033[36;0m" << std::endl;
+    std::cout << "Average solve time: "
+              << "\033[0;33m" << solve_time * 1e6 / steps << " us"
+              << "\033[36;0m" << std::endl;
+    std::cout << "Last number of iterations: " << qp_tracker.getNumIterations() << std::endl;
+    std::cout << "Compile time specialized core: " << (qp_tracker.isSpecialized() ? "yes" : "no") << std::endl;
+    ROS_INFO("condensed_qp_tracker_test: bounds, KKT residual and qpOASES solution checked for %d steps", steps);
+  }
+  catch (ros::Exception& e)
+  {
+    ROS_ERROR("%s", e.what());
+    exit(1);
+  }
+
+  return 0;
+}
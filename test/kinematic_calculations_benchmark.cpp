@@ -0,0 +1,138 @@
+#include <ros/ros.h>
+
+#include <predictive_control/kinematic_calculations.h>
+
+// average wall time of single Jacobian computation, joint values change every call
+template <typename Function>
+double benchmark(const int& iterations, Eigen::VectorXd joint_angles, Function function)
+{
+  const ros::WallTime start = ros::WallTime::now();
+  for (int i = 0u; i < iterations; ++i)
+  {
+    joint_angles(i % joint_angles.size()) += 1e-6;
+    function(joint_angles);
+  }
+  return (ros::WallTime::now() - start).toSec() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    ros::init(argc, argv, "kinematic_benchmark");
+    ros::NodeHandle node_handler;
+
+    if (node_handler.hasParam("/robot_description"))
+    {
+      Kinematic_calculations kin_solver;
+      kin_solver.initialize();
+
+      int iterations = 10000;
+      ros::NodeHandle("~").param("iterations", iterations, iterations);
+
+      Eigen::VectorXd joint_angles(kin_solver.degree_of_freedom_);
+      joint_angles.setConstant(0.3);
+      joint_angles(0) = 1.57;
+      joint_angles(1) = 0.60;
+
+      // same joint values with all three paths, results should agree
+      Eigen::MatrixXd FK_homogeneous, FK_isometry, FK_kdl;
+      Eigen::MatrixXd Jacobian_homogeneous, Jacobian_isometry, Jacobian_kdl;
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+      const bool generated_available = kin_solver.kinematic_backend_ == "generated";
+#endif
+      kin_solver.kinematic_backend_ = "homogeneous";
+      kin_solver.calculateJacobianMatrix(joint_angles, FK_homogeneous, Jacobian_homogeneous);
+      kin_solver.calculateJacobianMatrixUsingIsometryEngine(joint_angles, FK_isometry, Jacobian_isometry);
+      kin_solver.calculateJacobianMatrixUsingKDLSolver(joint_angles, FK_kdl, Jacobian_kdl);
+
+      std::cout << "\033[0;32m"
+                << "FK difference isometry - homogeneous: " << (FK_isometry - FK_homogeneous).norm() << "\n"
+                << "FK difference isometry - kdl: " << (FK_isometry - FK_kdl).norm() << "\n"
+                << "Jacobian difference isometry - homogeneous: "
+                << (Jacobian_isometry - Jacobian_homogeneous).norm() << "\n"
+                << "Jacobian difference isometry - kdl: " << (Jacobian_isometry - Jacobian_kdl).norm() << "\033[36;0m"
+                << std::endl;
+
+      const double homogeneous_time = benchmark(iterations, joint_angles, [&](const Eigen::VectorXd& q) {
+        kin_solver.calculateJacobianMatrix(q, FK_homogeneous, Jacobian_homogeneous);
+      });
+
+      const double isometry_time = benchmark(iterations, joint_angles, [&](const Eigen::VectorXd& q) {
+        kin_solver.calculateJacobianMatrixUsingIsometryEngine(q, FK_isometry, Jacobian_isometry);
+      });
+
+      const double kdl_time = benchmark(iterations, joint_angles, [&](const Eigen::VectorXd& q) {
+        kin_solver.calculateJacobianMatrixUsingKDLSolver(q, FK_kdl, Jacobian_kdl);
+      });
+
+      // one batch of all configurations, per configuration time comparable with single calls
+      Eigen::MatrixXd batch_joint_angles = joint_angles.transpose().replicate(iterations, 1);
+      for (int i = 0u; i < iterations; ++i)
+      {
+        batch_joint_angles(i, i % joint_angles.size()) += 1e-6 * i;
+      }
+
+      const ros::WallTime batch_start = ros::WallTime::now();
+      const BatchKinematicEngine& batch = kin_solver.calculateJacobianMatrixBatch(batch_joint_angles);
+      const double batch_time = (ros::WallTime::now() - batch_start).toSec() / iterations;
+
+      Eigen::MatrixXd Jacobian_batch;
+      batch.getJacobian(iterations - 1, Jacobian_batch);
+      kin_solver.calculateJacobianMatrixUsingIsometryEngine(batch_joint_angles.row(iterations - 1).transpose(),
+                                                            FK_isometry, Jacobian_isometry);
+      std::cout << "\033[0;32m"
+                << "FK difference batch - isometry: "
+                << (batch.getEndEffectorPose(iterations - 1).matrix() - FK_isometry).norm() << "\n"
+                << "Jacobian difference batch - isometry: " << (Jacobian_batch - Jacobian_isometry).norm() << "\n"
+                << " batch (micro second per configuration, "
+                << (BatchKinematicEngine::isVectorized() ? "AVX2" : "scalar") << "): " << batch_time * 1e6 << "\n"
+                << " speed up batch / isometry: " << isometry_time / batch_time << "\033[36;0m" << std::endl;
+
+#ifdef PREDICTIVE_CONTROL_GENERATED_KINEMATICS
+      // generated code only valid for chain it was exported from, see initializeGeneratedKinematics
+      if (generated_available)
+      {
+        Eigen::MatrixXd FK_generated, Jacobian_generated;
+
+        const double generated_time = benchmark(iterations, joint_angles, [&](const Eigen::VectorXd& q) {
+          kin_solver.calculateJacobianMatrixUsingGeneratedCode(q, FK_generated, Jacobian_generated);
+        });
+
+        kin_solver.calculateJacobianMatrixUsingGeneratedCode(joint_angles, FK_generated, Jacobian_generated);
+        kin_solver.calculateJacobianMatrixUsingIsometryEngine(joint_angles, FK_isometry, Jacobian_isometry);
+        std::cout << "\033[0;32m"
+                  << "FK difference generated - isometry: " << (FK_generated - FK_isometry).norm() << "\n"
+                  << "Jacobian difference generated - isometry: " << (Jacobian_generated - Jacobian_isometry).norm()
+                  << "\n"
+                  << " generated (micro second): " << generated_time * 1e6 << "\n"
+                  << " speed up generated / isometry: " << isometry_time / generated_time << "\033[36;0m"
+                  << std::endl;
+      }
+#endif
+
+      std::cout << "\033[0;33m"
+                << "Forward kinematic and Jacobian, average of " << iterations << " calls (micro second): \n"
+                << " homogeneous: " << homogeneous_time * 1e6 << "\n"
+                << " isometry: " << isometry_time * 1e6 << "\n"
+                << " kdl: " << kdl_time * 1e6 << "\n"
+                << " speed up isometry / homogeneous: " << homogeneous_time / isometry_time << "\n"
+                << " speed up isometry / kdl: " << kdl_time / isometry_time << "\033[36;0m" << std::endl;
+    }
+
+    else
+    {
+      ROS_ERROR("Robot_description not available");
+      exit(1);
+    }
+  }
+  catch (ros::Exception& e)
+
+  {
+    ROS_ERROR("%s", e.what());
+    exit(1);
+  }
+
+  return 0;
+}
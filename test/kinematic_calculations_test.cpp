@@ -69,6 +69,14 @@ int main(int argc, char** argv)
 
       std::cout << "KDL Jacobian Matrix: \n"
                 << "\033[0;33m" << Jacobian_Matrix << "\033[36;0m" << std::endl;
+
+      // inverse kinematics of same pose, warm started from zero joint angles
+      Eigen::VectorXd ik_joint_angles;
+      bool reachable =
+          kin_solver.calculateInverseKinematics(FK_Matrix, Eigen::VectorXd::Zero(joint_angles.size()), ik_joint_angles);
+
+      std::cout << "IK joint angles (reachable: " << std::boolalpha << reachable << "): \n"
+                << "\033[95m" << ik_joint_angles.transpose() << "\033[36;0m" << std::endl;
     }
 
     else